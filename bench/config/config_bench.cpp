@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include "config/Config.hpp"
+#include "config/Parser.hpp"
+
+using namespace webserv::config;
+
+/// A location whose directives are all set on the http directive
+static std::unique_ptr<Config> make_config()
+{
+    auto   config = std::make_unique<Config>("", Config::MAIN);
+    Parser parser("http { root /srv/www; index index.html; client_max_body_size 4096; "
+                  "server { server_name example.com; location /api/ { autoindex on; } } }");
+    parser.parse(*config);
+    config->compile();
+    return config;
+}
+
+static const Config& location_of(const Config& config)
+{
+    const Config& http = config[Config::HTTP];
+    return http.begin(Config::SERVER)->location("/api/users");
+}
+
+/// Each lookup walks up from the location to the http directive
+static void BM_ConfigValue(benchmark::State& state)
+{
+    auto          config   = make_config();
+    const Config& location = location_of(*config);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&location.value<std::string>(Config::ROOT, 0));
+        benchmark::DoNotOptimize(&location.value<std::string>(Config::INDEX, 0));
+        benchmark::DoNotOptimize(location.value<int>(Config::CLIENT_MAX_BODY_SIZE, 0));
+    }
+}
+BENCHMARK(BM_ConfigValue);
+
+/// The same settings, resolved once when the config is loaded
+static void BM_ConfigResolved(benchmark::State& state)
+{
+    auto                    config   = make_config();
+    const ResolvedLocation& location = location_of(*config).resolved();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&location.root);
+        benchmark::DoNotOptimize(&location.index);
+        benchmark::DoNotOptimize(location.client_max_body_size);
+    }
+}
+BENCHMARK(BM_ConfigResolved);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include "config/Config.hpp"
+#include "config/Parser.hpp"
+
+using namespace webserv::config;
+
+/// Builds a main config with one server that has `count` locations
+static std::unique_ptr<Config> make_config(int count)
+{
+    std::string input = "http { server { ";
+    for (int i = 0; i < count; ++i) {
+        input += "location /service" + std::to_string(i) + "/api/v" + std::to_string(i % 4) +
+                 "/ { root /srv; } ";
+    }
+    input += "location / { root /www; } } }";
+
+    auto   config = std::make_unique<Config>("", Config::MAIN);
+    Parser parser(input);
+    parser.parse(*config);
+    config->compile();
+    return config;
+}
+
+static const Config& server_of(const Config& config)
+{
+    return *config.get_children()[0]->get_children()[0];
+}
+
+/// The previous lookup: the first location that equals or prefixes the URI
+static const Config& linear_location(const Config& server, const std::string& uri)
+{
+    for (auto it = server.begin(Config::LOCATION); it != server.end();
+         it      = it.next(Config::LOCATION)) {
+        for (const auto& param : it->get_parameters()) {
+            std::string param_name = std::get<std::string>(param);
+            if (param_name == uri || (param_name.ends_with('/') && uri.starts_with(param_name))) {
+                return *it;
+            }
+        }
+    }
+    return server;
+}
+
+static void BM_Location(benchmark::State& state)
+{
+    auto          config = make_config(state.range(0));
+    const Config& server = server_of(*config);
+    std::string   uri    = "/service" + std::to_string(state.range(0) - 1) + "/api/v" +
+                      std::to_string((state.range(0) - 1) % 4) + "/users/42";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&server.location(uri));
+    }
+}
+BENCHMARK(BM_Location)->Arg(10)->Arg(100)->Arg(1000)->Arg(5000);
+
+static void BM_LocationLinear(benchmark::State& state)
+{
+    auto          config = make_config(state.range(0));
+    const Config& server = server_of(*config);
+    std::string   uri    = "/service" + std::to_string(state.range(0) - 1) + "/api/v" +
+                      std::to_string((state.range(0) - 1) % 4) + "/users/42";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&linear_location(server, uri));
+    }
+}
+BENCHMARK(BM_LocationLinear)->Arg(10)->Arg(100)->Arg(1000)->Arg(5000);
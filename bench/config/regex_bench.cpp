@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <regex>
+
+#include "utils/RegexSet.hpp"
+
+using webserv::utils::RegexSet;
+
+/// Extension patterns like the ones used by regex locations, none of which match the URI
+static std::vector<std::string> make_patterns(int count)
+{
+    std::vector<std::string> patterns;
+    for (int i = 0; i < count; ++i) {
+        patterns.push_back("\\.ext" + std::to_string(i) + "$");
+    }
+    return patterns;
+}
+
+static const std::string uri = "/static/assets/images/2024/05/some-long-file-name.webp";
+
+static void BM_RegexSet(benchmark::State& state)
+{
+    RegexSet set;
+    for (const auto& pattern : make_patterns(state.range(0))) {
+        set.add(pattern);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(set.match(uri));
+    }
+    state.SetBytesProcessed(state.iterations() * uri.size());
+}
+BENCHMARK(BM_RegexSet)->Arg(1)->Arg(10)->Arg(50);
+
+static void BM_StdRegex(benchmark::State& state)
+{
+    std::vector<std::regex> regexes;
+    for (const auto& pattern : make_patterns(state.range(0))) {
+        regexes.emplace_back(pattern, std::regex::extended);
+    }
+
+    for (auto _ : state) {
+        int match = -1;
+        for (size_t i = 0; i < regexes.size(); ++i) {
+            if (std::regex_search(uri, regexes[i])) {
+                match = i;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(match);
+    }
+    state.SetBytesProcessed(state.iterations() * uri.size());
+}
+BENCHMARK(BM_StdRegex)->Arg(1)->Arg(10)->Arg(50);
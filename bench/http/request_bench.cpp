@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include "http/Request.hpp"
+#include "utils/Arena.hpp"
+#include "utils/allocations.hpp"
+
+using webserv::bench::CountAllocations;
+using webserv::http::Request;
+using webserv::utils::Arena;
+
+/// A request like the ones browsers send, with `count` extra headers
+static std::string make_request(int count)
+{
+    std::string input = "GET /static/css/main.css?v=42 HTTP/1.1\r\n"
+                        "Host: localhost:8080\r\n"
+                        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:126.0) Firefox/126.0\r\n"
+                        "Accept: text/css,*/*;q=0.1\r\n"
+                        "Accept-Language: en-US,en;q=0.5\r\n"
+                        "Accept-Encoding: gzip, deflate, br\r\n"
+                        "Connection: keep-alive\r\n"
+                        "Referer: http://localhost:8080/index.html\r\n";
+    for (int i = 0; i < count; ++i) {
+        input += "X-Header-" + std::to_string(i) + ": value-" + std::to_string(i) + "\r\n";
+    }
+    return input + "\r\n";
+}
+
+static void BM_RequestParse(benchmark::State& state)
+{
+    std::string      input = make_request(state.range(0));
+    CountAllocations count(state);
+
+    for (auto _ : state) {
+        Request request(input);
+        benchmark::DoNotOptimize(request);
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_RequestParse)->Arg(0)->Arg(16)->Arg(64);
+
+/// Like a client does: the request is allocated from an arena rewound after each one
+static void BM_RequestParseArena(benchmark::State& state)
+{
+    std::string      input = make_request(state.range(0));
+    Arena            arena;
+    CountAllocations count(state);
+
+    for (auto _ : state) {
+        {
+            Request request(input, &arena);
+            benchmark::DoNotOptimize(request);
+        }
+        arena.reset();
+    }
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_RequestParseArena)->Arg(0)->Arg(16)->Arg(64);
+
+static void BM_UnchunkBody(benchmark::State& state)
+{
+    std::string input = "POST /upload/ HTTP/1.1\r\n"
+                        "Host: localhost\r\n"
+                        "Transfer-Encoding: chunked\r\n\r\n";
+    for (int64_t size = 0; size < state.range(0); size += 4096) {
+        input += "1000\r\n" + std::string(4096, 'x') + "\r\n";
+    }
+    input += "0\r\n\r\n";
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Request request(input);
+        state.ResumeTiming();
+
+        request.unchunk_body();
+        benchmark::DoNotOptimize(request.body().data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UnchunkBody)->Arg(4 << 10)->Arg(64 << 10)->Arg(1 << 20);
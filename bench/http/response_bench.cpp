@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "config/Config.hpp"
+#include "config/Parser.hpp"
+#include "http/Request.hpp"
+#include "http/Response.hpp"
+#include "utils/allocations.hpp"
+
+using namespace webserv::config;
+using webserv::bench::CountAllocations;
+using webserv::http::Request;
+using webserv::http::Response;
+using webserv::utils::ErrorLogger;
+
+/// A redirect builds the status line, headers and body without touching files
+static void BM_ResponseRedirect(benchmark::State& state)
+{
+    Config config("", Config::MAIN);
+    Parser parser("http { server { location /old/ { return 301 /new/; } } }");
+    parser.parse(config);
+    config.compile();
+
+    const Config& server = *config.get_children()[0]->get_children()[0];
+    ErrorLogger   elog(ErrorLogger::CRITICAL);
+    Request       request("GET /old/page.html HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    CountAllocations count(state);
+    for (auto _ : state) {
+        Response response(request, server, elog);
+        benchmark::DoNotOptimize(response.str());
+    }
+}
+BENCHMARK(BM_ResponseRedirect);
+
+static void BM_ContentType(benchmark::State& state)
+{
+    static const std::string extensions[] = {"html", "css", "js", "png", "jpg", "unknown"};
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Response::get_content_type(extensions[i++ % 6]));
+    }
+}
+BENCHMARK(BM_ContentType);
+
+static void BM_StatusLine(benchmark::State& state)
+{
+    static const Response::StatusCode codes[] = {
+        Response::StatusCode::OK,
+        Response::StatusCode::NOT_FOUND,
+        Response::StatusCode::INTERNAL_SERVER_ERROR,
+        Response::StatusCode::MOVED_PERMANENTLY,
+    };
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Response::status_line(codes[i++ % 4]));
+    }
+}
+BENCHMARK(BM_StatusLine);
@@ -0,0 +1,34 @@
+#!/bin/bash
+# Compares the load benchmark of the server with each event engine.
+#
+# usage: bench/load/engines.sh [webserv_load options...]
+#
+# The binary already built runs with `event_engine epoll` then `io_uring`,
+# which falls back to epoll, with a warning in bench/load/webserv.log,
+# when the kernel doesn't support it.
+
+set -e
+cd "$(dirname "$0")/../.."
+
+RESULTS=$(mktemp -d)
+trap 'rm -rf $RESULTS' EXIT
+
+ENGINES=(epoll io_uring)
+for engine in "${ENGINES[@]}"; do
+    echo "=== $engine"
+    EVENT_ENGINE=$engine BASELINE=$RESULTS/previous.txt ./bench/load/run.sh --save "$@"
+    cp $RESULTS/previous.txt "$RESULTS/$engine.txt"
+    grep -h "isn't supported" bench/load/webserv.log || true
+done
+
+echo
+printf "%-10s %12s %10s %10s %8s %16s\n" engine requests/s p50_ms p99_ms cpu_% syscalls/request
+for engine in "${ENGINES[@]}"; do
+    awk -v name="$engine" '
+        { value[$1] = $2 }
+        END {
+            printf "%-10s %12.0f %10.3f %10.3f %8.1f %16.2f\n", name, value["requests_per_sec"],
+                value["latency_p50_ms"], value["latency_p99_ms"], value["server_cpu_percent"],
+                value["loop_syscalls_per_request"]
+        }' "$RESULTS/$engine.txt"
+done
@@ -0,0 +1,798 @@
+/// A load generator for webserv.
+///
+/// Each thread keeps its share of keep-alive connections busy with a
+/// weighted mix of requests, one request in flight per connection, and
+/// records the latency of every response. Reports the throughput, the
+/// latency percentiles and, given the server pid, its CPU and memory use.
+/// The results can be saved and compared against a stored baseline.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+/// A kind of request in the mix
+struct Kind
+{
+    std::string name;
+    std::string path;
+    int         weight;
+    std::string request;
+};
+
+struct Options
+{
+    std::string host        = "127.0.0.1";
+    int         port        = 8080;
+    int         connections = 64;
+    int         threads     = 1;
+    int         duration    = 10;
+    int         warmup      = 1;
+    int         timeout     = 5;
+    int         pid         = 0;
+    std::string mix         = "small=70,large=5,404=10,upload=10,cgi=5";
+    std::string metrics;
+    std::string baseline;
+    std::string save;
+
+    std::map<std::string, std::string> paths = {
+        {"small", "/small.html"},
+        {"large", "/large.bin"},
+        {"404", "/does-not-exist"},
+        {"upload", "/upload/"},
+        {"cgi", "/cgi/hello.py"},
+    };
+};
+
+/// The results of one thread, merged at the end
+struct Stats
+{
+    std::vector<uint32_t> latencies_us;
+    std::vector<uint64_t> requests_by_kind;
+    uint64_t              status_classes[6] = {};
+    uint64_t              bytes             = 0;
+    uint64_t              errors            = 0;
+    uint64_t              timeouts          = 0;
+
+    void merge(const Stats& other)
+    {
+        latencies_us.insert(
+            latencies_us.end(), other.latencies_us.begin(), other.latencies_us.end());
+        requests_by_kind.resize(std::max(requests_by_kind.size(), other.requests_by_kind.size()));
+        for (size_t i = 0; i < other.requests_by_kind.size(); ++i) {
+            requests_by_kind[i] += other.requests_by_kind[i];
+        }
+        for (size_t i = 0; i < 6; ++i) {
+            status_classes[i] += other.status_classes[i];
+        }
+        bytes += other.bytes;
+        errors += other.errors;
+        timeouts += other.timeouts;
+    }
+};
+
+/// The CPU time and memory of the server
+struct Usage
+{
+    double cpu_seconds = 0;
+    long   rss_kib     = 0;
+    long   peak_kib    = 0;
+};
+
+/// @brief Builds the raw request of a kind
+///
+/// Uploads are a multipart file sent with chunked encoding.
+std::string build_request(const std::string& name, const std::string& path)
+{
+    if (name != "upload") {
+        return "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: webserv-load\r\n\r\n";
+    }
+
+    std::string body = "--BOUNDARY\r\n"
+                       "Content-Disposition: form-data; name=\"file\"; filename=\"load.txt\"\r\n"
+                       "Content-Type: text/plain\r\n\r\n" +
+                       std::string(4096, 'x') + "\r\n--BOUNDARY--\r\n";
+
+    std::string request = "POST " + path +
+                          " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: webserv-load\r\n"
+                          "Content-Type: multipart/form-data; boundary=BOUNDARY\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n";
+    for (size_t pos = 0; pos < body.size(); pos += 1024) {
+        size_t size = std::min<size_t>(1024, body.size() - pos);
+        char   line[32];
+        snprintf(line, sizeof(line), "%zx\r\n", size);
+        request += line + body.substr(pos, size) + "\r\n";
+    }
+    return request + "0\r\n\r\n";
+}
+
+/// @brief Parses `name=weight,...` into the kinds of the mix
+std::vector<Kind> parse_mix(const Options& options)
+{
+    std::vector<Kind>  kinds;
+    std::istringstream stream(options.mix);
+    std::string        item;
+
+    while (std::getline(stream, item, ',')) {
+        size_t      equal = item.find('=');
+        std::string name  = item.substr(0, equal);
+        auto        path  = options.paths.find(name);
+        if (equal == std::string::npos || path == options.paths.end()) {
+            throw std::runtime_error("Invalid mix entry: " + item);
+        }
+        int weight = std::atoi(item.c_str() + equal + 1);
+        if (weight > 0) {
+            kinds.push_back({name, path->second, weight, build_request(name, path->second)});
+        }
+    }
+    if (kinds.empty()) {
+        throw std::runtime_error("The mix has no requests");
+    }
+    return kinds;
+}
+
+/// @brief Reads the CPU time and memory of a process from /proc
+Usage read_usage(int pid)
+{
+    Usage usage;
+    if (pid <= 0) {
+        return usage;
+    }
+
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string   content((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+    if (content.rfind(')') == std::string::npos) {
+        return usage;  // The process has exited
+    }
+    // The fields after the command name, which may contain spaces
+    std::istringstream fields(content.substr(content.rfind(')') + 2));
+    std::string        field;
+    unsigned long      utime = 0, stime = 0;
+    for (int i = 3; fields >> field; ++i) {
+        if (i == 14) {
+            utime = std::stoul(field);
+        } else if (i == 15) {
+            stime = std::stoul(field);
+            break;
+        }
+    }
+    usage.cpu_seconds = double(utime + stime) / sysconf(_SC_CLK_TCK);
+
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string   line;
+    while (std::getline(status, line)) {
+        if (line.starts_with("VmRSS:")) {
+            usage.rss_kib = std::atol(line.c_str() + 6);
+        } else if (line.starts_with("VmHWM:")) {
+            usage.peak_kib = std::atol(line.c_str() + 6);
+        }
+    }
+    return usage;
+}
+
+/// @brief Reads a counter from the metrics of the server
+///
+/// @return The value, or -1 if it couldn't be read
+double scrape(const sockaddr_in& address, const std::string& uri, const std::string& name)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    timeval timeout = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request  = "GET " + uri + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    std::string response;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+        ::send(fd, request.data(), request.size(), MSG_NOSIGNAL) == ssize_t(request.size())) {
+        // The connection is kept alive, the response ends with its length
+        char    buffer[65536];
+        ssize_t n;
+        size_t  end = std::string::npos;
+        while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            response.append(buffer, n);
+            end = response.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                continue;
+            }
+            std::string headers = response.substr(0, end);
+            std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+            size_t length = headers.find("content-length:");
+            if (length == std::string::npos ||
+                response.size() >= end + 4 + std::atol(headers.c_str() + length + 15)) {
+                break;
+            }
+        }
+    }
+    ::close(fd);
+
+    size_t pos = response.find("\n" + name + " ");
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    return std::atof(response.c_str() + pos + name.size() + 2);
+}
+
+/// A keep-alive connection with at most one request in flight
+class Connection
+{
+public:
+    enum class State
+    {
+        CLOSED,
+        CONNECTING,
+        WRITING,
+        READING,
+    };
+
+    Connection() : _fd(-1), _state(State::CLOSED), _kind(0), _sent(0) {}
+
+    ~Connection() { this->close(); }
+
+    /// @brief Opens a new connection
+    ///
+    /// @return false if the socket couldn't be created
+    bool connect(int epoll_fd, const sockaddr_in& address)
+    {
+        _fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (_fd == -1) {
+            return false;
+        }
+        int one = 1;
+        setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (::connect(_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 &&
+            errno != EINPROGRESS) {
+            this->close();
+            return false;
+        }
+
+        epoll_event event = {};
+        event.events      = EPOLLOUT;
+        event.data.ptr    = this;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, _fd, &event);
+        _state = State::CONNECTING;
+        return true;
+    }
+
+    /// @brief Starts a request
+    void send(int epoll_fd, size_t kind, const std::string& request)
+    {
+        _kind    = kind;
+        _request = &request;
+        _sent    = 0;
+        _start   = Clock::now();
+        _response.clear();
+        _state = State::WRITING;
+        this->watch(epoll_fd, EPOLLOUT);
+    }
+
+    /// @brief Writes the rest of the request
+    ///
+    /// @return false on error
+    bool write(int epoll_fd)
+    {
+        while (_sent < _request->size()) {
+            ssize_t n =
+                ::send(_fd, _request->data() + _sent, _request->size() - _sent, MSG_NOSIGNAL);
+            if (n == -1) {
+                return errno == EAGAIN;
+            }
+            _sent += n;
+        }
+        _state = State::READING;
+        this->watch(epoll_fd, EPOLLIN);
+        return true;
+    }
+
+    /// @brief Reads what is available of the response
+    ///
+    /// @param complete Set to true once the whole response arrived
+    /// @return false on error, or if the server closed the connection early
+    bool read(bool& complete)
+    {
+        char buffer[65536];
+        while (true) {
+            ssize_t n = ::recv(_fd, buffer, sizeof(buffer), 0);
+            if (n == -1) {
+                if (errno != EAGAIN) {
+                    return false;
+                }
+                break;
+            }
+            if (n == 0) {
+                // A response without a length ends with the connection
+                complete = this->is_complete() ||
+                           (this->headers_end() != std::string::npos && _length == -1 && !_chunked);
+                _keep_alive = false;
+                return complete;
+            }
+            _response.append(buffer, n);
+        }
+        complete = this->is_complete();
+        return true;
+    }
+
+    /// @brief Returns the status code of the response
+    int status() const
+    {
+        return _response.size() > 12 ? std::atoi(_response.c_str() + 9) : 0;
+    }
+
+    void close()
+    {
+        if (_fd != -1) {
+            ::close(_fd);
+            _fd = -1;
+        }
+        _state = State::CLOSED;
+    }
+
+    State             state() const { return _state; }
+    size_t            kind() const { return _kind; }
+    size_t            size() const { return _response.size(); }
+    bool              keep_alive() const { return _keep_alive; }
+    Clock::time_point start() const { return _start; }
+
+private:
+    int                _fd;
+    State              _state;
+    size_t             _kind;
+    const std::string* _request = nullptr;
+    size_t             _sent;
+    Clock::time_point  _start;
+
+    std::string _response;
+    long        _length     = -1;
+    bool        _chunked    = false;
+    bool        _keep_alive = true;
+
+    void watch(int epoll_fd, uint32_t events)
+    {
+        epoll_event event = {};
+        event.events      = events;
+        event.data.ptr    = this;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, _fd, &event);
+    }
+
+    size_t headers_end() const { return _response.find("\r\n\r\n"); }
+
+    /// @brief Checks if the response is complete, parsing its headers once they arrived
+    bool is_complete()
+    {
+        size_t end = this->headers_end();
+        if (end == std::string::npos) {
+            return false;
+        }
+        size_t body = end + 4;
+
+        std::string headers = _response.substr(0, body);
+        std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+        _length     = -1;
+        _chunked    = headers.find("transfer-encoding: chunked") != std::string::npos;
+        _keep_alive = headers.find("connection: close") == std::string::npos;
+
+        size_t length = headers.find("content-length:");
+        if (length != std::string::npos) {
+            _length = std::atol(headers.c_str() + length + 15);
+        }
+
+        if (_chunked) {
+            size_t pos = body;
+            while (true) {
+                size_t line = _response.find("\r\n", pos);
+                if (line == std::string::npos) {
+                    return false;
+                }
+                size_t size = std::strtoul(_response.c_str() + pos, nullptr, 16);
+                if (size == 0) {
+                    return _response.find("\r\n\r\n", line) != std::string::npos;
+                }
+                pos = line + 2 + size + 2;
+                if (pos > _response.size()) {
+                    return false;
+                }
+            }
+        }
+        if (_length >= 0) {
+            return _response.size() >= body + _length;
+        }
+        return false;
+    }
+};
+
+/// Runs connections against the server until the deadline
+class Worker
+{
+public:
+    Worker(const Options&           options,
+           const std::vector<Kind>& kinds,
+           const sockaddr_in&       address,
+           int                      connections,
+           unsigned                 seed)
+        : _options(options),
+          _kinds(kinds),
+          _address(address),
+          _connections(connections),
+          _random(seed)
+    {
+        _stats.requests_by_kind.resize(kinds.size());
+        for (const Kind& kind : kinds) {
+            _weights.push_back((_weights.empty() ? 0 : _weights.back()) + kind.weight);
+        }
+    }
+
+    /// @brief Sends requests until `end`, recording the ones completed after `measure`
+    void run(Clock::time_point measure, Clock::time_point end)
+    {
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        for (auto& connection : _connections) {
+            this->open(epoll_fd, connection);
+        }
+
+        epoll_event       events[256];
+        Clock::time_point next_check = Clock::now();
+        while (Clock::now() < end) {
+            int count = epoll_wait(epoll_fd, events, 256, 100);
+            for (int i = 0; i < count; ++i) {
+                auto* connection = static_cast<Connection*>(events[i].data.ptr);
+                this->handle(epoll_fd, *connection, measure);
+            }
+
+            Clock::time_point now = Clock::now();
+            if (now >= next_check) {
+                this->check_timeouts(epoll_fd, now, measure);
+                next_check = now + std::chrono::milliseconds(100);
+            }
+        }
+
+        for (auto& connection : _connections) {
+            connection.close();
+        }
+        ::close(epoll_fd);
+    }
+
+    const Stats& stats() const { return _stats; }
+
+private:
+    const Options&           _options;
+    const std::vector<Kind>& _kinds;
+    sockaddr_in              _address;
+    std::vector<Connection>  _connections;
+    std::vector<int>         _weights;
+    std::mt19937             _random;
+    Stats                    _stats;
+
+    void open(int epoll_fd, Connection& connection)
+    {
+        connection.close();
+        if (!connection.connect(epoll_fd, _address)) {
+            ++_stats.errors;
+        }
+    }
+
+    void send_next(int epoll_fd, Connection& connection)
+    {
+        int    pick = std::uniform_int_distribution<int>(0, _weights.back() - 1)(_random);
+        size_t kind = std::upper_bound(_weights.begin(), _weights.end(), pick) - _weights.begin();
+        connection.send(epoll_fd, kind, _kinds[kind].request);
+        if (!connection.write(epoll_fd)) {
+            this->fail(epoll_fd, connection);
+        }
+    }
+
+    void fail(int epoll_fd, Connection& connection)
+    {
+        ++_stats.errors;
+        this->open(epoll_fd, connection);
+    }
+
+    void handle(int epoll_fd, Connection& connection, Clock::time_point measure)
+    {
+        switch (connection.state()) {
+        case Connection::State::CONNECTING:
+            this->send_next(epoll_fd, connection);
+            break;
+        case Connection::State::WRITING:
+            if (!connection.write(epoll_fd)) {
+                this->fail(epoll_fd, connection);
+            }
+            break;
+        case Connection::State::READING: {
+            bool complete = false;
+            if (!connection.read(complete) && !complete) {
+                this->fail(epoll_fd, connection);
+                break;
+            }
+            if (!complete) {
+                break;
+            }
+
+            Clock::time_point now = Clock::now();
+            if (connection.start() >= measure) {
+                auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - connection.start());
+                _stats.latencies_us.push_back(latency.count());
+                _stats.requests_by_kind[connection.kind()]++;
+                _stats.status_classes[std::min(connection.status() / 100, 5)]++;
+                _stats.bytes += connection.size();
+            }
+
+            if (connection.keep_alive()) {
+                this->send_next(epoll_fd, connection);
+            } else {
+                this->open(epoll_fd, connection);
+            }
+            break;
+        }
+        case Connection::State::CLOSED:
+            break;
+        }
+    }
+
+    void check_timeouts(int epoll_fd, Clock::time_point now, Clock::time_point measure)
+    {
+        for (auto& connection : _connections) {
+            if (connection.state() == Connection::State::CLOSED) {
+                this->open(epoll_fd, connection);
+            } else if (connection.state() != Connection::State::CONNECTING &&
+                       now - connection.start() > std::chrono::seconds(_options.timeout)) {
+                if (connection.start() >= measure) {
+                    ++_stats.timeouts;
+                }
+                this->open(epoll_fd, connection);
+            }
+        }
+    }
+};
+
+/// @brief Returns the latency at a percentile in milliseconds
+double percentile(const std::vector<uint32_t>& sorted, double percent)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = std::min(sorted.size() - 1, size_t(sorted.size() * percent / 100));
+    return sorted[index] / 1000.0;
+}
+
+/// @brief Reads a results file of `name value` lines
+std::map<std::string, double> read_results(const std::string& path)
+{
+    std::map<std::string, double> results;
+    std::ifstream                 file(path);
+    std::string                   name;
+    double                        value;
+    while (file >> name >> value) {
+        results[name] = value;
+    }
+    return results;
+}
+
+void usage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [--host ADDR] [--port N] [--connections N] [--threads N]\n"
+            "          [--duration SEC] [--warmup SEC] [--timeout SEC] [--pid PID]\n"
+            "          [--mix small=70,large=5,404=10,upload=10,cgi=5] [--path KIND=URI]\n"
+            "          [--metrics URI] [--baseline FILE] [--save FILE]\n",
+            program);
+    exit(2);
+}
+
+Options parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        std::string value = argv[++i];
+
+        if (option == "--host") {
+            options.host = value;
+        } else if (option == "--port") {
+            options.port = std::stoi(value);
+        } else if (option == "--connections") {
+            options.connections = std::stoi(value);
+        } else if (option == "--threads") {
+            options.threads = std::stoi(value);
+        } else if (option == "--duration") {
+            options.duration = std::stoi(value);
+        } else if (option == "--warmup") {
+            options.warmup = std::stoi(value);
+        } else if (option == "--timeout") {
+            options.timeout = std::stoi(value);
+        } else if (option == "--pid") {
+            options.pid = std::stoi(value);
+        } else if (option == "--mix") {
+            options.mix = value;
+        } else if (option == "--path" && value.find('=') != std::string::npos) {
+            options.paths[value.substr(0, value.find('='))] = value.substr(value.find('=') + 1);
+        } else if (option == "--metrics") {
+            options.metrics = value;
+        } else if (option == "--baseline") {
+            options.baseline = value;
+        } else if (option == "--save") {
+            options.save = value;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (options.connections < 1 || options.threads < 1 || options.duration < 1) {
+        usage(argv[0]);
+    }
+    options.threads = std::min(options.threads, options.connections);
+    return options;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options           options = parse_options(argc, argv);
+    std::vector<Kind> kinds;
+    try {
+        kinds = parse_mix(options);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family  = AF_INET;
+    address.sin_port    = htons(options.port);
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", options.host.c_str());
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < options.threads; ++i) {
+        int connections = options.connections / options.threads +
+                          (i < options.connections % options.threads ? 1 : 0);
+        workers.push_back(std::make_unique<Worker>(options, kinds, address, connections, i + 1));
+    }
+
+    Clock::time_point measure = Clock::now() + std::chrono::seconds(options.warmup);
+    Clock::time_point end     = measure + std::chrono::seconds(options.duration);
+
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker, measure, end] { worker->run(measure, end); });
+    }
+
+    const char* syscalls        = "webserv_loop_syscalls_total";
+    auto        scrape_syscalls = [&options, &address, syscalls] {
+        return options.metrics.empty() ? -1 : scrape(address, options.metrics, syscalls);
+    };
+
+    std::this_thread::sleep_until(measure);
+    Usage  before          = read_usage(options.pid);
+    double syscalls_before = scrape_syscalls();
+    std::this_thread::sleep_until(end);
+    Usage  after          = read_usage(options.pid);
+    double syscalls_after = scrape_syscalls();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Stats stats;
+    for (const auto& worker : workers) {
+        stats.merge(worker->stats());
+    }
+    std::sort(stats.latencies_us.begin(), stats.latencies_us.end());
+
+    double requests = stats.latencies_us.size();
+    std::map<std::string, double> results = {
+        {"requests_per_sec", requests / options.duration},
+        {"transfer_mib_per_sec", stats.bytes / 1048576.0 / options.duration},
+        {"latency_p50_ms", percentile(stats.latencies_us, 50)},
+        {"latency_p90_ms", percentile(stats.latencies_us, 90)},
+        {"latency_p99_ms", percentile(stats.latencies_us, 99)},
+        {"latency_p999_ms", percentile(stats.latencies_us, 99.9)},
+        {"latency_max_ms", stats.latencies_us.empty() ? 0 : stats.latencies_us.back() / 1000.0},
+        {"errors", double(stats.errors + stats.timeouts)},
+    };
+    if (options.pid > 0) {
+        results["server_cpu_percent"] =
+            (after.cpu_seconds - before.cpu_seconds) * 100 / options.duration;
+        results["server_rss_kib"]  = after.rss_kib;
+        results["server_peak_kib"] = after.peak_kib;
+    }
+    // The scrapes are requests too, but a handful among thousands
+    bool scraped = syscalls_before >= 0 && syscalls_after >= 0 && requests > 0;
+    if (scraped) {
+        results["loop_syscalls_per_request"] = (syscalls_after - syscalls_before) / requests;
+    }
+
+    printf("%d connections, %d threads, %ds after %ds of warmup, mix %s\n\n",
+           options.connections,
+           options.threads,
+           options.duration,
+           options.warmup,
+           options.mix.c_str());
+    printf("  requests   %.0f, %.1f/s, %.2f MiB/s\n",
+           requests,
+           results["requests_per_sec"],
+           results["transfer_mib_per_sec"]);
+    printf("  latency    p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+           results["latency_p50_ms"],
+           results["latency_p90_ms"],
+           results["latency_p99_ms"],
+           results["latency_p999_ms"],
+           results["latency_max_ms"]);
+    printf("  status     1xx %lu, 2xx %lu, 3xx %lu, 4xx %lu, 5xx %lu, none %lu\n",
+           stats.status_classes[1],
+           stats.status_classes[2],
+           stats.status_classes[3],
+           stats.status_classes[4],
+           stats.status_classes[5],
+           stats.status_classes[0]);
+    printf("  errors     %lu connection, %lu timeouts\n", stats.errors, stats.timeouts);
+    printf("  by kind   ");
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        printf(" %s %lu", kinds[i].name.c_str(), stats.requests_by_kind[i]);
+    }
+    printf("\n");
+    if (options.pid > 0) {
+        printf("  server     cpu %.1f%%, rss %.1f MiB, peak %.1f MiB\n",
+               results["server_cpu_percent"],
+               results["server_rss_kib"] / 1024,
+               results["server_peak_kib"] / 1024);
+    }
+    if (scraped) {
+        printf("  loop       %.2f syscalls per request\n", results["loop_syscalls_per_request"]);
+    } else if (!options.metrics.empty()) {
+        printf("  loop       no %s in %s\n", syscalls, options.metrics.c_str());
+    }
+
+    if (!options.baseline.empty()) {
+        std::map<std::string, double> baseline = read_results(options.baseline);
+        if (!baseline.empty()) {
+            printf("\n  %-22s %12s %12s %8s\n", "compared to baseline", "baseline", "current", "");
+            for (const auto& [name, value] : results) {
+                auto it = baseline.find(name);
+                if (it == baseline.end()) {
+                    continue;
+                }
+                double change = it->second != 0 ? (value - it->second) * 100 / it->second : 0;
+                printf("  %-22s %12.3f %12.3f %+7.1f%%\n", name.c_str(), it->second, value, change);
+            }
+        }
+    }
+
+    if (!options.save.empty()) {
+        std::ofstream file(options.save);
+        for (const auto& [name, value] : results) {
+            file << name << ' ' << value << '\n';
+        }
+        printf("\nSaved the results to %s\n", options.save.c_str());
+    }
+    return stats.latencies_us.empty() ? 1 : 0;
+}
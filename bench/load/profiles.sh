@@ -0,0 +1,62 @@
+#!/bin/bash
+# Builds webserv with each release stage and compares their load benchmarks.
+#
+# usage: bench/load/profiles.sh [webserv_load options...]
+#
+# Each stage is compared with the previous one: the plain -O2 build, the
+# release profile (-O3, LTO, -march=$MARCH), the PGO build and, when ALLOCATOR is
+# set, the PGO build linked with that allocator. CXX and MARCH are passed
+# on to make.
+
+set -e
+cd "$(dirname "$0")/../.."
+
+RESULTS=$(mktemp -d)
+trap 'rm -rf $RESULTS' EXIT
+
+# Only the variables below reach make, ALLOCATOR is for the last stage
+unset MAKEFLAGS
+MAKE_ARGS=(ALLOCATOR=)
+for var in CXX MARCH; do
+    if [ -n "${!var}" ]; then
+        MAKE_ARGS+=("$var=${!var}")
+    fi
+done
+
+STAGES=()
+
+# Runs the benchmark against the binary just built and keeps its results
+stage() {
+    local name=$1
+    shift
+    echo "=== $name"
+    BASELINE=$RESULTS/previous.txt ./bench/load/run.sh --save "$@"
+    cp $RESULTS/previous.txt "$RESULTS/$name.txt"
+    STAGES+=("$name")
+}
+
+make "${MAKE_ARGS[@]}" PROFILE=release MARCH= RELEASE_FLAGS="-O2 -DNDEBUG" \
+    OBJ_DIR=./.obj/release-o2 webserv > /dev/null
+stage o2 "$@"
+
+make "${MAKE_ARGS[@]}" release > /dev/null
+stage release "$@"
+
+make "${MAKE_ARGS[@]}" pgo PGO_ARGS="$*" > /dev/null
+stage pgo "$@"
+
+if [ -n "$ALLOCATOR" ]; then
+    make "${MAKE_ARGS[@]:1}" PROFILE=release PGO=use ALLOCATOR="$ALLOCATOR" webserv > /dev/null
+    stage "pgo+$ALLOCATOR" "$@"
+fi
+
+echo
+printf "%-16s %12s %10s %10s %8s\n" stage requests/s p50_ms p99_ms cpu_%
+for name in "${STAGES[@]}"; do
+    awk -v name="$name" '
+        { value[$1] = $2 }
+        END {
+            printf "%-16s %12.0f %10.3f %10.3f %8.1f\n", name, value["requests_per_sec"],
+                value["latency_p50_ms"], value["latency_p99_ms"], value["server_cpu_percent"]
+        }' "$RESULTS/$name.txt"
+done
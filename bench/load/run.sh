@@ -0,0 +1,54 @@
+#!/bin/bash
+# Runs webserv with bench/load/bench.conf and puts it under load.
+#
+# usage: bench/load/run.sh [--save] [webserv_load options...]
+#
+# The results are compared with bench/load/baseline.txt when it exists,
+# --save replaces it with the results of this run. BASELINE sets another file.
+# EVENT_ENGINE runs the server with that `event_engine`.
+
+set -e
+cd "$(dirname "$0")/../.."
+
+DIR=bench/load
+BASELINE=${BASELINE:-$DIR/baseline.txt}
+PORT=8089
+
+SAVE=0
+if [ "$1" = "--save" ]; then
+    SAVE=1
+    shift
+fi
+
+# The large file and the uploads aren't stored in the repository
+mkdir -p $DIR/www/upload
+if [ ! -f $DIR/www/large.bin ]; then
+    head -c 1048576 /dev/urandom > $DIR/www/large.bin
+fi
+
+CONFIG=$DIR/bench.conf
+if [ -n "$EVENT_ENGINE" ]; then
+    CONFIG=$(mktemp)
+    { echo "event_engine $EVENT_ENGINE;"; cat $DIR/bench.conf; } > $CONFIG
+fi
+
+./webserv $CONFIG > $DIR/webserv.log 2>&1 &
+PID=$!
+trap 'kill $PID 2>/dev/null; wait $PID 2>/dev/null; [ -z "$EVENT_ENGINE" ] || rm -f $CONFIG' EXIT
+
+for _ in $(seq 50); do
+    if (exec 3<>/dev/tcp/127.0.0.1/$PORT) 2>/dev/null; then
+        break
+    fi
+    sleep 0.1
+done
+
+ARGS=(--port $PORT --pid $PID --metrics /metrics)
+if [ -f $BASELINE ]; then
+    ARGS+=(--baseline $BASELINE)
+fi
+if [ $SAVE = 1 ]; then
+    ARGS+=(--save $BASELINE)
+fi
+
+./webserv_load "${ARGS[@]}" "$@"
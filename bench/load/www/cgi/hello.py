@@ -0,0 +1,3 @@
+#!/usr/bin/python3
+
+print("<p>Hello from CGI</p>")
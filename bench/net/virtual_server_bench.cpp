@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include "config/Config.hpp"
+#include "config/Parser.hpp"
+#include "net/VirtualServer.hpp"
+
+using namespace webserv::config;
+using webserv::net::Address;
+using webserv::net::Socket;
+using webserv::net::VirtualServer;
+using webserv::utils::ErrorLogger;
+
+/// Builds `count` servers named `host<i>.example.com` and `*.host<i>.example.net`
+static std::unique_ptr<Config> make_config(int count)
+{
+    std::string input = "http { ";
+    for (int i = 0; i < count; ++i) {
+        std::string host = "host" + std::to_string(i);
+        input += "server { server_name " + host + ".example.com *." + host + ".example.net; } ";
+    }
+    input += "}";
+
+    auto   config = std::make_unique<Config>("", Config::MAIN);
+    Parser parser(input);
+    parser.parse(*config);
+    config->compile();
+    return config;
+}
+
+static void get_config(benchmark::State& state, const std::string& host)
+{
+    auto          config = make_config(state.range(0));
+    ErrorLogger   elog(ErrorLogger::CRITICAL);
+    Address       address("127.0.0.1", 0);
+    VirtualServer server(address, elog);
+    Socket        client(address, -1);
+
+    for (const auto& child : (*config)[Config::HTTP].get_children()) {
+        server.add_config(address, *child, false);
+    }
+
+    std::string last = std::to_string(state.range(0) - 1);
+    std::string name = host;
+    name.replace(name.find('N'), 1, last);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&server.get_config(client, name));
+    }
+}
+
+static void BM_GetConfigExact(benchmark::State& state)
+{
+    get_config(state, "hostN.example.com");
+}
+BENCHMARK(BM_GetConfigExact)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_GetConfigWildcard(benchmark::State& state)
+{
+    get_config(state, "www.hostN.example.net");
+}
+BENCHMARK(BM_GetConfigWildcard)->Arg(1)->Arg(100)->Arg(1000);
+
+static void BM_GetConfigDefault(benchmark::State& state)
+{
+    get_config(state, "unknown.example.orgN");
+}
+BENCHMARK(BM_GetConfigDefault)->Arg(1)->Arg(100)->Arg(1000);
@@ -0,0 +1,43 @@
+#include "utils/allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<size_t> count = 0;
+
+void* allocate(size_t size, size_t alignment)
+{
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    size    = size == 0 ? 1 : size;
+    void* p = alignment <= alignof(std::max_align_t)
+                  ? std::malloc(size)
+                  : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+}  // namespace
+
+// The other forms of `new` and all forms of `delete` default to these and `free`
+void* operator new(size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+namespace webserv::bench
+{
+size_t allocations()
+{
+    return count.load(std::memory_order_relaxed);
+}
+}  // namespace webserv::bench
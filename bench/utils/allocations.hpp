@@ -0,0 +1,34 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+namespace webserv::bench
+{
+/// @brief Returns the number of heap allocations made so far
+///
+/// Counted by the replacement of `operator new` in allocations.cpp.
+size_t allocations();
+
+/// Reports the heap allocations of a benchmark as the `allocs` counter,
+/// per iteration. Created before the loop, reports when destroyed.
+class CountAllocations
+{
+public:
+    explicit CountAllocations(benchmark::State& state) : _state(state), _start(allocations()) {}
+
+    ~CountAllocations()
+    {
+        _state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations() - _start),
+                                                       benchmark::Counter::kAvgIterations);
+    }
+
+    CountAllocations(const CountAllocations&)            = delete;
+    CountAllocations& operator=(const CountAllocations&) = delete;
+
+private:
+    benchmark::State& _state;
+    size_t            _start;
+};
+}  // namespace webserv::bench
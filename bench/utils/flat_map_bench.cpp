@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/FlatMap.hpp"
+
+using webserv::utils::FlatMap;
+
+/// Host names or path segments, looked up by views of a request
+static std::vector<std::string> make_keys(int count)
+{
+    std::vector<std::string> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back("service" + std::to_string(i) + ".example.com");
+    }
+    return keys;
+}
+
+/// Looks up every key in turn, then as many that aren't in the map
+template <typename Map>
+static void lookup_strings(benchmark::State& state)
+{
+    std::vector<std::string> keys = make_keys(state.range(0));
+    std::vector<std::string> miss = make_keys(state.range(0) * 2);
+    miss.erase(miss.begin(), miss.begin() + state.range(0));
+
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map.emplace(std::string_view(keys[i]), i);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(std::string_view(keys[i])) != map.end());
+        benchmark::DoNotOptimize(map.find(std::string_view(miss[i])) != map.end());
+        i = i + 1 == keys.size() ? 0 : i + 1;
+    }
+}
+
+static void BM_UnorderedMapString(benchmark::State& state)
+{
+    lookup_strings<std::unordered_map<std::string_view, size_t>>(state);
+}
+BENCHMARK(BM_UnorderedMapString)->Arg(8)->Arg(64)->Arg(4096);
+
+static void BM_FlatMapString(benchmark::State& state)
+{
+    lookup_strings<FlatMap<std::string_view, size_t>>(state);
+}
+BENCHMARK(BM_FlatMapString)->Arg(8)->Arg(64)->Arg(4096);
+
+/// The events of the poller, looked up by the fds epoll returns
+static std::vector<int> make_fds(int count)
+{
+    std::vector<int> fds;
+    for (int fd = 0; fd < count; ++fd) {
+        fds.push_back((fd * 7919) % count);
+    }
+    return fds;
+}
+
+static void BM_UnorderedMapFd(benchmark::State& state)
+{
+    std::vector<int>                              fds = make_fds(state.range(0));
+    std::unordered_map<int, std::unique_ptr<int>> events;
+    for (int fd : fds) {
+        events.emplace(fd, std::make_unique<int>(fd));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(events.find(fds[i])->second.get());
+        i = i + 1 == fds.size() ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_UnorderedMapFd)->Arg(64)->Arg(16384);
+
+static void BM_VectorFd(benchmark::State& state)
+{
+    std::vector<int>                  fds = make_fds(state.range(0));
+    std::vector<std::unique_ptr<int>> events(fds.size());
+    for (int fd : fds) {
+        events[fd] = std::make_unique<int>(fd);
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(events[fds[i]].get());
+        i = i + 1 == fds.size() ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_VectorFd)->Arg(64)->Arg(16384);
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "net/Address.hpp"
+#include "utils/Logger.hpp"
+
+using webserv::net::Address;
+using webserv::utils::ErrorLogger;
+
+static const Address address("127.0.0.1", 8080);
+
+/// A debug message built eagerly, as the call sites did before the macros
+static void BM_LogDisabledEager(benchmark::State& state)
+{
+    ErrorLogger elog(ErrorLogger::INFO);
+
+    for (auto _ : state) {
+        elog.log("Received data from " + address.to_string() + ": " + std::to_string(512) +
+                 " bytes");
+    }
+}
+BENCHMARK(BM_LogDisabledEager);
+
+static void BM_LogDisabled(benchmark::State& state)
+{
+    ErrorLogger elog(ErrorLogger::INFO);
+
+    for (auto _ : state) {
+        ELOG_DEBUG(elog, "Received data from {}: {} bytes", address, 512);
+    }
+}
+BENCHMARK(BM_LogDisabled);
+
+/// The previous implementation: stringstream, strftime per line and an unbuffered stream
+static void BM_LogEnabledStream(benchmark::State& state)
+{
+    std::ofstream out("/dev/null");
+
+    for (auto _ : state) {
+        auto        now  = std::chrono::system_clock::now();
+        std::time_t time = std::chrono::system_clock::to_time_t(now);
+        char        timestamp[20];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", std::localtime(&time));
+
+        std::stringstream buffer;
+        buffer << "[" << timestamp << "][INFO]: "
+               << "Received data from " + address.to_string() + ": " + std::to_string(512) +
+                      " bytes"
+               << std::endl;
+        out << buffer.str() << std::flush;
+    }
+}
+BENCHMARK(BM_LogEnabledStream);
+
+static void BM_LogEnabled(benchmark::State& state)
+{
+    ErrorLogger elog(ErrorLogger::DEBUG);
+    elog.set_file("/dev/null");
+
+    for (auto _ : state) {
+        ELOG_INFO(elog, "Received data from {}: {} bytes", address, 512);
+    }
+}
+BENCHMARK(BM_LogEnabled);
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+#include "utils/Metrics.hpp"
+
+using webserv::utils::Metrics;
+
+/// The instrumentation of one request: a status, a latency and the bytes sent
+static void BM_MetricsRecord(benchmark::State& state)
+{
+    Metrics&           metrics  = Metrics::instance();
+    Metrics::Location& location = metrics.location("bench", "/");
+    uint64_t           us       = 0;
+
+    for (auto _ : state) {
+        metrics.record(location, 200, us++ & 0xffff);
+        metrics.add_sent(512);
+    }
+}
+BENCHMARK(BM_MetricsRecord);
+
+static void BM_MetricsStr(benchmark::State& state)
+{
+    Metrics& metrics = Metrics::instance();
+    for (int i = 0; i < state.range(0); ++i) {
+        metrics.location("bench", "/" + std::to_string(i));
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.str());
+    }
+}
+BENCHMARK(BM_MetricsStr)->Arg(10)->Arg(100);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace webserv::async
+{
+/// The kernel interface the `Poller` waits on for ready file descriptors.
+///
+/// A file descriptor is watched for a mask of `Event::Type` until it is
+/// removed. Backends that report an fd only once are told to watch it
+/// again with `rearm` after it was handled and stays registered.
+///
+/// A backend may accept connections on the sockets watched for
+/// `Event::ACCEPT`, and receive on those watched for `Event::RECEIVE`,
+/// on its own. What it completed is taken with `accept` and `receive`;
+/// a backend that doesn't leaves it to the caller.
+class Backend
+{
+public:
+    /// A connection accepted, or data received, by a backend on its own
+    struct Completion
+    {
+        /// `Event::ACCEPT` or `Event::RECEIVE`
+        uint32_t         type;
+        /// The listening or connected socket
+        int              fd;
+        /// The connection, the bytes received, 0 at the end of the stream or -errno
+        int              result;
+        std::string_view data;
+    };
+
+    using Leftover = std::function<void(const Completion&)>;
+
+    virtual ~Backend() = default;
+
+    /// @brief Watches a file descriptor, replacing what it was watched for
+    ///
+    /// @param fd The file descriptor
+    /// @param type A mask of `Event::Type`
+    /// @throw std::runtime_error if it can't be watched
+    virtual void watch(int fd, uint32_t type) = 0;
+
+    /// @brief Watches a file descriptor again after it was reported
+    virtual void rearm(int fd) = 0;
+
+    /// @brief Stops watching a file descriptor, which must still be open
+    ///
+    /// Connections accepted on it and not taken yet are closed, and the
+    /// data received on it is dropped.
+    virtual void remove(int fd) = 0;
+
+    /// @brief Stops reporting a file descriptor whose promise resolved
+    ///
+    /// The accept or receive the backend runs on it keeps running for the
+    /// next promise, which is what sets it apart from `remove`.
+    virtual void suspend(int fd) { this->remove(fd); }
+
+    /// @brief Waits for file descriptors to be ready
+    ///
+    /// @param fds Set to the ready file descriptors
+    /// @param max The size of `fds`
+    /// @param timeout_ms The longest time to wait
+    /// @return The number of ready file descriptors
+    /// @throw std::runtime_error if waiting failed
+    virtual int wait(int* fds, int max, int timeout_ms) = 0;
+
+    /// @brief Takes a connection the backend accepted on a listening socket
+    ///
+    /// @return The connection, -1 with errno set to EAGAIN if none is waiting,
+    ///         or nothing if the backend doesn't accept on it
+    virtual std::optional<int> accept(int) { return std::nullopt; }
+
+    /// @brief Takes data the backend received on a connected socket
+    ///
+    /// @return As `read`, or nothing if the backend doesn't receive on it
+    virtual std::optional<ssize_t> receive(int, char*, size_t) { return std::nullopt; }
+
+    /// @brief Stops what the backend runs on its own, before another one replaces it
+    ///
+    /// @param leftover Called with each connection and data not taken yet
+    virtual void stop(const Leftover&) {}
+};
+}  // namespace webserv::async
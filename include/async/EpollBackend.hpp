@@ -0,0 +1,34 @@
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <vector>
+
+#include "async/Backend.hpp"
+
+namespace webserv::async
+{
+/// Waits with an edge-triggered epoll instance, which reports a file
+/// descriptor every time it becomes ready until it is removed.
+class EpollBackend : public Backend
+{
+public:
+    /// @throw std::runtime_error if the epoll instance can't be created
+    EpollBackend();
+    ~EpollBackend() override;
+
+    EpollBackend(const EpollBackend&)            = delete;
+    EpollBackend& operator=(const EpollBackend&) = delete;
+
+    void watch(int fd, uint32_t type) override;
+    void rearm(int) override {}
+    void remove(int fd) override;
+    int  wait(int* fds, int max, int timeout_ms) override;
+
+private:
+    int                      _epoll_fd;
+    /// The file descriptors added to the instance, indexed by fd
+    std::vector<bool>        _added;
+    std::vector<epoll_event> _ready;
+};
+}  // namespace webserv::async
@@ -23,11 +23,15 @@ public:
     {
         READABLE = 1 << 0,
         WRITABLE = 1 << 1,
+        /// Readable, on a listening socket that is accepted on with `Poller::accept`
+        ACCEPT   = 1 << 2 | READABLE,
+        /// Readable, on a connected socket that is read with `Poller::receive`
+        RECEIVE  = 1 << 3 | READABLE,
     };
 
     Event(int fd, uint32_t type, std::unique_ptr<IPromise> promise);
 
-    uint32_t to_epoll() const;
+    uint32_t get_type() const;
     int      get_fd() const;
 
     /// Polls the event to check if it is ready
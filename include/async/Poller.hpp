@@ -1,21 +1,54 @@
 #pragma once
 
-#include <sys/epoll.h>
+#include <netinet/in.h>
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
+#include "async/Backend.hpp"
 #include "async/Event.hpp"
 
 namespace webserv::async
 {
 class IPromise;
 
+/// Runs the promises whose file descriptors are ready.
+///
+/// The file descriptors are waited on with epoll, or io_uring when the
+/// `event_engine` says so and the kernel supports it. Listening sockets
+/// watched for `Event::ACCEPT` are accepted on with `accept`, and connected
+/// sockets watched for `Event::RECEIVE` read with `receive`, which take
+/// what the engine accepted and received on its own when it does.
+///
+/// Other threads hand callbacks to the loop with `post`, which wakes it
+/// through an eventfd. Each iteration and callback is timed and recorded
+/// in the metrics. Callbacks slower than a threshold are reported, as
+/// they delay every other connection.
 class Poller
 {
 public:
-    using Events   = std::unordered_map<int, std::unique_ptr<Event>>;
+    /// The event of each fd, indexed by fd
+    using Events   = std::vector<std::unique_ptr<Event>>;
     using Promises = std::vector<std::unique_ptr<IPromise>>;
+    using Clock    = std::chrono::steady_clock;
+
+    enum class Engine
+    {
+        EPOLL,
+        IO_URING,
+    };
+
+    /// Called with the fd of a slow callback, -1 for a blocking promise, the peer
+    /// address of the fd, `nullptr` if it isn't a connected socket, and its duration
+    using SlowCallback = std::function<void(
+        int fd, const sockaddr_in* peer, std::chrono::microseconds duration)>;
 
     Poller();
     ~Poller();
@@ -36,11 +69,113 @@ public:
     /// @param promise The promise to add
     void add_promise(std::unique_ptr<IPromise> promise);
 
+    /// Stops polling the file descriptor and drops its pending promise
+    ///
+    /// Must be called before a file descriptor that is still
+    /// open is closed, handed to another owner or kept idle.
+    ///
+    /// @param fd The file descriptor to remove
+    void remove(int fd);
+
+    /// Accepts a connection on a listening socket watched for `Event::ACCEPT`
+    ///
+    /// @param fd The listening socket
+    /// @param address Set to the peer address of the connection
+    /// @return As `accept4` with `SOCK_NONBLOCK | SOCK_CLOEXEC`
+    int accept(int fd, sockaddr_in& address);
+
+    /// Reads from a connected socket watched for `Event::RECEIVE`
+    ///
+    /// @return As `read`
+    ssize_t receive(int fd, char* buffer, size_t size);
+
+    /// Runs a callback on the event loop, from any thread
+    ///
+    /// The callbacks run in the order they were posted, during the
+    /// next iteration. It wakes `poll` if it is waiting.
+    ///
+    /// @param callback The callback to run
+    void post(std::function<void()> callback);
+
+    /// Reports the callbacks that run for at least `threshold`
+    ///
+    /// While enabled, the peer of each fd is read before its callback
+    /// runs, since the callback may close the fd.
+    ///
+    /// @param threshold The threshold, zero disables the reports
+    /// @param callback Called for each slow callback
+    void set_slow_callback(std::chrono::microseconds threshold, SlowCallback callback);
+
+    /// Waits with another engine from the next iteration, keeping the promises
+    ///
+    /// @param engine The engine to use
+    /// @return The engine used, epoll if the kernel doesn't support io_uring
+    Engine set_engine(Engine engine);
+
+    Engine get_engine() const;
+
+    /// Parses an `event_engine` parameter
+    ///
+    /// @throw std::runtime_error if the engine is unknown
+    static Engine engine_of(const std::string& name);
+
+    /// Returns the name of an engine, as in `event_engine`
+    static std::string_view name(Engine engine);
+
     static Poller& instance();
 
 private:
-    int      _epoll_fd;
-    Events   _events;
-    Promises _blocking_promises;
+    /// What the previous engine accepted or received but wasn't taken yet
+    struct Carried
+    {
+        std::vector<int>   accepted;
+        std::string        received;
+        /// The end of the stream or -errno, once `received` was read
+        std::optional<int> end;
+    };
+
+    std::unique_ptr<Backend> _backend;
+    Engine                   _engine;
+    Events                   _events;
+    Promises                 _blocking_promises;
+
+    /// Readable while callbacks are posted
+    int                                _wake_fd;
+    std::mutex                         _posted_mutex;
+    std::vector<std::function<void()>> _posted;
+
+    /// The leftovers of the previous engine by fd, and the fds to poll for them once
+    std::unordered_map<int, Carried> _carried;
+    std::vector<int>                 _carried_ready;
+
+    std::chrono::microseconds _slow_threshold;
+    SlowCallback              _slow_callback;
+    sockaddr_in               _peer;
+
+    /// Records the callback that ran since `start`
+    ///
+    /// @param fd The fd of the callback, -1 for a blocking promise
+    /// @param start When the callback started
+    /// @param peer The peer of the fd, captured before the callback ran
+    /// @return The time it ended, when the next callback starts
+    Clock::time_point record_callback(int                fd,
+                                      Clock::time_point  start,
+                                      const sockaddr_in* peer = nullptr);
+
+    /// Returns the peer address of a socket, or `nullptr`, valid until the next call
+    const sockaddr_in* peer_of(int fd);
+
+    /// Keeps a leftover of the previous engine for `accept` and `receive`
+    void carry(const Backend::Completion& completion);
+
+    /// Runs the posted callbacks
+    ///
+    /// @param start When the first one starts
+    /// @return The time the last one ended
+    Clock::time_point run_posted(Clock::time_point start);
+
+    /// Events replaced or removed while they may still be running,
+    /// destroyed at the end of `poll()`
+    std::vector<std::unique_ptr<Event>> _retired;
 };
 }  // namespace webserv::async
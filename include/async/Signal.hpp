@@ -0,0 +1,40 @@
+#pragma once
+
+#include "async/Promise.hpp"
+
+namespace webserv::async
+{
+/// Receives a signal in the event loop instead of in a signal handler.
+///
+/// The signal is blocked and read from a signalfd, so it is handled
+/// between two callbacks like any other event.
+class Signal
+{
+public:
+    /// @brief Blocks the signal and starts receiving it
+    ///
+    /// Must be created before any thread is started,
+    /// threads inherit the blocked signals.
+    ///
+    /// @param signal The signal number
+    Signal(int signal);
+    ~Signal();
+
+    Signal(const Signal&)            = delete;
+    Signal& operator=(const Signal&) = delete;
+
+    /// Waits for the signal to be delivered
+    ///
+    /// @return The signal number as a promise
+    Promise<int> wait();
+
+    /// @brief Unblocks all signals blocked by `Signal`
+    ///
+    /// Called in forked children before `execve`, which
+    /// would otherwise inherit the blocked signals.
+    static void unblock_all();
+
+private:
+    int _fd;
+};
+}  // namespace webserv::async
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace webserv::async
+{
+class ThreadPool;
+
+/// The result of work run by the `ThreadPool`, shared by the worker that
+/// sets it and the event loop that reads it.
+template <typename T>
+class Task
+{
+public:
+    /// @brief Returns true once the work has run and the event loop was told
+    bool ready() const { return _ready; }
+
+    /// @brief Returns the result, or `nullptr` if the work threw.
+    ///        Only valid once `ready()`
+    T* value() { return _value ? &*_value : nullptr; }
+
+private:
+    friend class ThreadPool;
+
+    std::optional<T> _value;
+    /// Only set and read on the event loop
+    bool _ready = false;
+};
+
+/// Runs blocking work, like filesystem calls, off the event loop.
+///
+/// A fixed number of workers take jobs from a bounded queue. When a job is
+/// done, its completion is posted to the `Poller`, which wakes up and runs
+/// it between two callbacks, so the result is only ever used on the event
+/// loop. The workers are started by the first job, after the signals of
+/// the server are blocked.
+class ThreadPool
+{
+public:
+    using Job   = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t THREADS = 4;
+    /// Jobs waiting for a worker; more run on the thread submitting them
+    static constexpr size_t MAX_QUEUED = 1024;
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    /// @brief Runs work on a worker, then a completion on the event loop
+    ///
+    /// If the queue is full or no worker could be started, the work runs
+    /// right away on the calling thread; the completion is posted all the same.
+    ///
+    /// @param work The work, which must not touch what the event loop uses
+    /// @param done Called on the event loop after the work
+    void submit(Job work, Job done);
+
+    /// @brief Runs work returning a value on a worker
+    ///
+    /// @param work The work, which must not touch what the event loop uses
+    /// @return The task, ready on the event loop once the work is done
+    template <typename T>
+    std::shared_ptr<Task<T>> run(std::function<T()> work)
+    {
+        auto task = std::make_shared<Task<T>>();
+        this->submit(
+            [task, work = std::move(work)] {
+                try {
+                    task->_value.emplace(work());
+                } catch (...) {
+                }
+            },
+            [task] { task->_ready = true; });
+        return task;
+    }
+
+    /// @brief Returns the number of jobs waiting for a worker
+    size_t queued() const;
+
+    static ThreadPool& instance();
+
+private:
+    struct Entry
+    {
+        Job               work;
+        Job               done;
+        Clock::time_point submitted;
+    };
+
+    ThreadPool();
+
+    mutable std::mutex       _mutex;
+    std::condition_variable  _available;
+    std::deque<Entry>        _queue;
+    std::vector<std::thread> _threads;
+    bool                     _stopping = false;
+
+    /// @brief Starts the workers, keeping the ones that could be
+    void start();
+
+    /// @brief Takes and runs jobs until the pool stops
+    void work();
+};
+}  // namespace webserv::async
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "async/Backend.hpp"
+
+namespace webserv::async
+{
+/// Waits with io_uring, through its system calls as liburing isn't required.
+///
+/// Each watched file descriptor has a one-shot poll in flight, armed again
+/// once it was handled. Arming, re-arming and cancelling only queue entries
+/// on the submission ring, which the next wait sends in the same
+/// `io_uring_enter`: an iteration of the loop is one system call however
+/// many file descriptors it registers.
+///
+/// Listening sockets watched for `Event::ACCEPT` have a multishot accept in
+/// flight instead, and connected sockets watched for `Event::RECEIVE` a
+/// multishot receive into a ring of buffers shared by all of them. They keep
+/// running while the fd is suspended, between promises, and what they
+/// complete is queued for `accept` and `receive`, in order. A receive stops
+/// once its fd holds `MAX_HELD` buffers not taken, so that a connection no
+/// one reads from can't take the whole ring, and runs again when they were.
+/// A kernel older than 6.0 polls these sockets too.
+///
+/// A poll holds its file open, so a watched file descriptor must be removed
+/// before it is closed, as the `Poller` requires.
+class UringBackend : public Backend
+{
+public:
+    /// Entries of the submission ring, flushed early when it is full
+    static constexpr unsigned ENTRIES = 1024;
+    /// The buffers multishot receives fill, a power of two
+    static constexpr unsigned BUFFERS     = 256;
+    static constexpr size_t   BUFFER_SIZE = 4096;
+    /// The buffers a file descriptor holds before its multishot receive is stopped
+    static constexpr unsigned MAX_HELD = BUFFERS / 16;
+
+    /// @throw std::runtime_error if the kernel lacks io_uring or a feature used
+    UringBackend();
+    ~UringBackend() override;
+
+    UringBackend(const UringBackend&)            = delete;
+    UringBackend& operator=(const UringBackend&) = delete;
+
+    void                   watch(int fd, uint32_t type) override;
+    void                   rearm(int fd) override;
+    void                   remove(int fd) override;
+    void                   suspend(int fd) override;
+    int                    wait(int* fds, int max, int timeout_ms) override;
+    std::optional<int>     accept(int fd) override;
+    std::optional<ssize_t> receive(int fd, char* buffer, size_t size) override;
+    void                   stop(const Leftover& leftover) override;
+
+private:
+    /// A connection accepted or data received by a multishot operation
+    struct Completed
+    {
+        /// The connection, the bytes received, 0 at the end of the stream or -errno
+        int      result;
+        uint16_t buffer;
+        /// The bytes of the buffer already taken
+        uint32_t offset;
+    };
+
+    /// The operations of a file descriptor
+    struct Watch
+    {
+        /// Bumped when the poll is replaced, so completions of older ones are ignored
+        uint32_t               generation = 0;
+        uint32_t               type       = 0;
+        bool                   watched    = false;
+        bool                   armed      = false;
+        /// The wait that last reported it, so that it is reported once per wait
+        uint64_t               reported   = 0;
+        /// Set while it is in `_ready`
+        bool                   ready      = false;
+        /// Bumped when the multishot operation is cancelled, like `generation`
+        uint32_t               multishot_generation = 0;
+        bool                   multishot            = false;
+        /// Set once the multishot operation is cancelled in its generation,
+        /// what it completes until it ended still counts
+        bool                   stopping             = false;
+        /// `Event::ACCEPT` or `Event::RECEIVE`, what the multishot operation does
+        uint32_t               kind = 0;
+        /// What the multishot operation completed, taken from `taken` on
+        std::vector<Completed> completed;
+        size_t                 taken = 0;
+
+        bool pending() const { return taken < completed.size(); }
+    };
+
+    int    _ring_fd    = -1;
+    void*  _rings      = nullptr;
+    size_t _rings_size = 0;
+    void*  _sqes_map   = nullptr;
+    size_t _sqes_size  = 0;
+
+    unsigned*     _sq_head;
+    unsigned*     _sq_tail;
+    unsigned      _sq_mask;
+    unsigned      _sq_entries;
+    io_uring_sqe* _sqes;
+    /// The tail of the submission ring, including the entries not yet submitted
+    unsigned _tail;
+
+    unsigned*     _cq_head;
+    unsigned*     _cq_tail;
+    unsigned      _cq_mask;
+    io_uring_cqe* _cqes;
+
+    std::vector<Watch> _watches;
+    bool               _skip_success;
+    uint64_t           _waits = 0;
+    /// File descriptors to report at the next wait without waiting
+    std::vector<int>   _ready;
+
+    /// Cleared when the kernel rejects a multishot operation
+    bool                    _multishot = false;
+    /// The ring of provided buffers, with the tail of the buffers handed back
+    io_uring_buf_ring*      _buf_ring  = nullptr;
+    uint16_t                _buf_tail  = 0;
+    std::unique_ptr<char[]> _buffers;
+    /// The multishot operations in flight, including cancelled ones
+    unsigned                _in_flight = 0;
+
+    /// @brief Unmaps the rings and closes the ring
+    void release();
+
+    /// @brief Returns a cleared submission entry, submitting the queued
+    ///        ones first if the ring is full
+    io_uring_sqe* next();
+
+    /// @brief Returns the entries queued since the last submission
+    unsigned queued() const;
+
+    /// @brief Queues the poll of a file descriptor
+    void arm(int fd, Watch& watch);
+
+    /// @brief Queues the cancellation of the poll in flight of a file descriptor
+    void cancel(int fd, Watch& watch);
+
+    /// @brief Returns `Event::ACCEPT` or `Event::RECEIVE` if a multishot operation
+    ///        stands for the readability the fd is watched for, 0 otherwise
+    uint32_t multishot_type(const Watch& watch) const;
+
+    /// @brief Returns the events the poll of a file descriptor waits for
+    uint32_t polled(const Watch& watch) const;
+
+    /// @brief Queues the multishot accept or receive of a file descriptor
+    void arm_multishot(int fd, Watch& watch, uint32_t type);
+
+    /// @brief Queues the cancellation of the multishot operation of a file descriptor
+    void cancel_multishot(int fd, Watch& watch);
+
+    /// @brief Queues the cancellation of the multishot operation of a file descriptor,
+    ///        keeping what it completes until it ended
+    void stop_multishot(int fd, Watch& watch);
+
+    /// @brief Queues a file descriptor to report at the next wait, once
+    void report(int fd, Watch& watch);
+
+    /// @brief Takes in what a multishot operation completed
+    ///
+    /// @return true if the fd should be reported
+    bool complete(int fd, const io_uring_cqe& cqe);
+
+    /// @brief Drops what was completed and not taken, closing the connections
+    ///        and handing the buffers back
+    ///
+    /// @param leftover Called with each of them first, if set
+    void drop(int fd, Watch& watch, const Leftover* leftover = nullptr);
+
+    /// @brief Hands a buffer back to the kernel
+    void recycle(uint16_t buffer);
+
+    /// @brief Submits the queued entries and waits for completions
+    ///
+    /// @param min_complete The completions to wait for, at most until the timeout
+    /// @param timeout_ms The longest time to wait
+    void enter(unsigned min_complete, int timeout_ms);
+
+    /// @brief Takes the completions of the current polls
+    ///
+    /// @param fds Set to the ready file descriptors
+    /// @param max The size of `fds`
+    /// @return The number of ready file descriptors
+    int reap(int* fds, int max);
+};
+}  // namespace webserv::async
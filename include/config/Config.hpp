@@ -6,9 +6,13 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
+#include "config/LocationMatcher.hpp"
+#include "config/ResolvedLocation.hpp"
+
 namespace webserv::config
 {
 class Config
@@ -36,6 +40,23 @@ public:
         RETURN,
         ERROR_PAGE,
         UPLOAD_DIR,
+        UPSTREAM,
+        UPSTREAM_SERVER,
+        LEAST_CONN,
+        HASH,
+        KEEPALIVE,
+        PROXY_PASS,
+        PROXY_CACHE,
+        PROXY_CACHE_VALID,
+        ACCESS_LOG,
+        ERROR_LOG,
+        METRICS,
+        SLOW_CALLBACK_THRESHOLD,
+        AUTOINDEX_FORMAT,
+        AUTOINDEX_PAGE_SIZE,
+        AIO,
+        EVENT_ENGINE,
+        PROXY_CACHE_MAX_SIZE,
     };
 
     /// Used for validation
@@ -50,6 +71,14 @@ public:
         Parameters allowed_params = {};
     };
 
+    /// A `listen` directive: `listen <port> [host] [default_server];`
+    struct Listen
+    {
+        std::string host;
+        int         port;
+        bool        default_server;
+    };
+
     class iterator
     {
     public:
@@ -132,7 +161,33 @@ public:
     iterator begin(Type type) const;
     iterator end() const;
 
-    const Config& location(const std::string& uri) const;
+    /// @brief Find the location directive for a URI
+    ///
+    /// A location equal to the URI wins, otherwise the longest
+    /// location ending in '/' that the URI starts with is used.
+    ///
+    /// @param uri The request URI
+    /// @return The location or this directive if no location matches
+    const Config& location(std::string_view uri) const;
+
+    /// @brief Get the directives that apply to this location
+    ///
+    /// Resolved when the config is compiled, or on the first call
+    /// for directives built by hand.
+    ///
+    /// @return The resolved directives
+    const ResolvedLocation& resolved() const;
+
+    /// @brief Precompiles the lookup structures of this directive and its children
+    ///
+    /// Done when a config file is loaded, directives built by hand
+    /// are compiled on their first lookup.
+    void compile();
+
+    /// @brief Get the `listen` directives of a server
+    ///
+    /// @return The listen directives, or the default one if the server has none
+    std::vector<Listen> listens() const;
 
     const std::string& server_name() const;
     const std::string& host() const;
@@ -142,12 +197,24 @@ public:
     const std::string& error_page(int code) const;
     const std::string& return_uri() const;
     const std::string& upload_dir() const;
+    const std::string& proxy_pass() const;
+    const std::string& proxy_cache() const;
+    const std::string& access_log() const;
+    const std::string& access_log_format() const;
+    const std::string& error_log() const;
+    const std::string& autoindex_format() const;
+    const std::string& aio() const;
+    const std::string& event_engine() const;
 
     int  port() const;
     bool limit_except(const std::string& method) const;
     bool autoindex() const;
     int  client_max_body_size() const;
     int  return_code() const;
+    int  proxy_cache_valid() const;
+    int  proxy_cache_max_size() const;
+    int  slow_callback_threshold() const;
+    int  autoindex_page_size() const;
 
     Type               get_type() const;
     const std::string& get_name() const;
@@ -171,5 +238,8 @@ protected:
     Parameters  _parameters;
     Directives  _children;
     Config*     _parent;
+
+    mutable std::shared_ptr<LocationMatcher>  _locations;
+    mutable std::shared_ptr<ResolvedLocation> _resolved;
 };
 }  // namespace webserv::config
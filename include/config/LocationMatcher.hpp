@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/FlatMap.hpp"
+#include "utils/RegexSet.hpp"
+
+namespace webserv::config
+{
+class Config;
+
+/// Matches request URIs against the `location` directives of a server.
+///
+/// Locations are compiled into a hash of exact paths and a trie keyed by
+/// path segments for the locations ending in '/', so a lookup takes one
+/// pass over the URI and doesn't allocate. Regex locations (`~` and the
+/// case-insensitive `~*`) are compiled together into a single automaton.
+class LocationMatcher
+{
+public:
+    /// @brief Compiles the locations of a server
+    ///
+    /// @param server The server directive
+    LocationMatcher(const Config& server);
+
+    /// @brief Finds the location for a URI
+    ///
+    /// A location that equals the URI wins, then the first regex location
+    /// that matches, otherwise the longest location ending in '/' that
+    /// the URI starts with is used.
+    ///
+    /// @param uri The request URI
+    /// @return The location or `nullptr` if no location matches
+    const Config* match(std::string_view uri) const;
+
+private:
+    struct Node
+    {
+        /// A node has a few children, which the standard map scans without hashing
+        std::unordered_map<std::string_view, size_t> children;
+        const Config*                                location = nullptr;
+    };
+
+    utils::FlatMap<std::string_view, const Config*> _exact;
+    std::vector<Node>                               _nodes;
+    utils::RegexSet                                 _regex;
+    std::vector<const Config*>                      _regex_locations;
+
+    /// Adds a location ending in '/' to the trie
+    void insert(std::string_view path, const Config* location);
+};
+}  // namespace webserv::config
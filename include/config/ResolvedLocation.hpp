@@ -0,0 +1,68 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#include "utils/AccessLog.hpp"
+#include "utils/Metrics.hpp"
+
+namespace webserv::config
+{
+class Config;
+
+/// The directives that apply to a location, with inheritance resolved.
+///
+/// Built once when the config is loaded so a request reads its settings
+/// with a few loads instead of walking up the directive tree for each
+/// one. The strings reference the parameters of the directive that sets
+/// them, so locations inheriting a value share it. The config must
+/// outlive this.
+struct ResolvedLocation
+{
+    /// Methods that `limit_except` can allow, in the order of `http::Request::Method`
+    static constexpr const char* METHODS[] = {"GET", "POST", "DELETE"};
+
+    /// @brief Resolves the directives of a location
+    ///
+    /// @param location The location, or a server when no location matches
+    ResolvedLocation(const Config& location);
+
+    /// @brief Checks if `limit_except` allows a method
+    ///
+    /// @param method The index of the method in `METHODS`
+    bool allows(int method) const;
+
+    const std::string& root;
+    const std::string& index;
+    const std::string& upload_dir;
+    const std::string& return_uri;
+    const std::string& proxy_pass;
+    const std::string& proxy_cache;
+    /// "html", "json" or "xml"
+    const std::string& autoindex_format;
+
+    std::bitset<std::size(METHODS)> methods;
+
+    /// The access log, or `nullptr` if requests aren't logged
+    utils::AccessLog* access_log;
+
+    /// The counters of the requests served by this location
+    utils::Metrics::Location& metrics;
+
+    /// The largest request body accepted, in bytes
+    size_t client_max_body_size;
+
+    int  return_code;
+    int  proxy_cache_valid;
+    int  proxy_cache_max_size;
+    int  autoindex_page_size;
+    bool autoindex;
+    /// Whether files are opened, written and removed on the thread pool
+    bool aio_threads;
+
+    /// Whether the location serves the metrics
+    bool metrics_endpoint;
+};
+}  // namespace webserv::config
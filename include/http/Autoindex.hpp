@@ -0,0 +1,138 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace webserv::http
+{
+/// Lists directories for autoindex pages.
+///
+/// Listings are cached per directory and reused until the modification
+/// time of the directory changes. A directory that isn't cached is read
+/// on the thread pool, so listing a large one doesn't block the event
+/// loop; requests for a directory that is being read share that read.
+class Autoindex
+{
+public:
+    /// Directories whose listings are kept
+    static constexpr size_t MAX_DIRECTORIES = 64;
+
+    enum class Format
+    {
+        HTML,
+        JSON,
+        XML,
+    };
+
+    struct Entry
+    {
+        std::string name;
+        bool        is_dir;
+        off_t       size;
+        time_t      mtime;
+    };
+
+    /// The entries of a directory, sorted by name
+    using Listing = std::vector<Entry>;
+
+    /// A listing of a directory, read in the background
+    class Scan
+    {
+    public:
+        /// @brief Returns true once the directory has been read, which the
+        ///        event loop learns from the thread pool
+        bool ready() const { return _ready; }
+
+        /// @brief Returns the listing, or `nullptr` if the directory couldn't
+        ///        be read. Only valid once `ready()`
+        const Listing* listing() const { return _failed ? nullptr : &_listing; }
+
+    private:
+        friend class Autoindex;
+
+        /// Identifies the directory and its version when the read started
+        struct stat _stat;
+        timespec    _started;
+
+        Listing _listing;
+        bool    _failed = false;
+        bool    _ready  = false;
+
+        /// @brief Returns true if the directory changed since the read,
+        ///        or may have within the same timestamp
+        bool outdated(const struct stat& current) const;
+    };
+
+    /// A page of a listing
+    struct Page
+    {
+        /// Starts at 1
+        size_t number;
+        /// 0 for all the entries on one page
+        size_t size;
+    };
+
+    /// @brief Returns the listing of a directory, reading it in the
+    ///        background if it isn't cached or changed since
+    ///
+    /// @param path The path of the directory
+    /// @return The scan, ready unless the directory has to be read
+    /// @throw StatusCode 403 if the path isn't a readable directory
+    static std::shared_ptr<const Scan> list(const std::string& path);
+
+    /// @brief Returns the listing of a directory already checked with `stat`
+    ///
+    /// @param path The path of the directory
+    /// @param dir_stat The status of the directory
+    /// @return The scan, ready unless the directory has to be read
+    static std::shared_ptr<const Scan> list(const std::string& path, const struct stat& dir_stat);
+
+    /// @brief Reads a directory with `getdents64` and `fstatat`, skipping
+    ///        ".", ".." and ".gitignore"
+    ///
+    /// @param path The path of the directory
+    /// @param listing Set to the entries, sorted by name
+    /// @return false if the directory couldn't be opened
+    static bool read(const std::string& path, Listing& listing);
+
+    /// @brief Renders a page of a listing
+    ///
+    /// @param listing The listing
+    /// @param format The format of the output
+    /// @param uri The decoded path of the directory, ending with '/', encoded again in links
+    /// @param page The page to render
+    /// @param html_template An HTML page with `{{URI}}` and
+    ///        `{{DIRECTORY_ENTRIES}}` placeholders, or "" for the builtin one
+    /// @return The body of the response
+    static std::string render(const Listing&     listing,
+                              Format             format,
+                              std::string_view   uri,
+                              Page               page,
+                              const std::string& html_template = "");
+
+    /// @brief Parses an `autoindex_format` parameter
+    ///
+    /// @throw std::runtime_error if the format is unknown
+    static Format format_of(const std::string& format);
+
+    /// @brief Returns the extension whose content type a format has
+    static std::string_view extension(Format format);
+
+    /// @brief Returns the page requested by the `page` parameter of a query
+    ///
+    /// @param query The query string
+    /// @param size The size of a page, 0 for no pages
+    static Page page_of(std::string_view query, size_t size);
+
+private:
+    using Registry = std::unordered_map<std::string, std::shared_ptr<Scan>>;
+
+    static Registry& registry();
+};
+}  // namespace webserv::http
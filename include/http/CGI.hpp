@@ -39,7 +39,7 @@ public:
     State state() const;
 
     Promise<ssize_t> read(std::string& buffer);
-    Promise<ssize_t> write(const std::string& buffer);
+    Promise<ssize_t> write(std::string_view buffer);
 
 private:
     State          _state;
@@ -52,8 +52,8 @@ private:
     int   _stdin_pipe[2];
     int   _stdout_pipe[2];
 
-    char** create_envp() const;
-    char** convert_map_to_envp(const std::unordered_map<std::string, std::string>& env_map) const;
-    void   try_file(const std::string& uri) const;
+    /// @brief Returns the `KEY=value` strings of the script's environment
+    std::vector<std::string> create_env() const;
+    void                     try_file(const std::string& uri) const;
 };
 }  // namespace webserv::http
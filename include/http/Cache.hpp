@@ -0,0 +1,165 @@
+#pragma once
+
+#include <ctime>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "http/Proxy.hpp"
+#include "http/Request.hpp"
+
+namespace webserv::http
+{
+/// Stores cacheable upstream responses on disk, indexed in memory.
+///
+/// The files take up to a maximum size, past which the least recently used
+/// responses are evicted.
+class Cache
+{
+public:
+    using Registry = std::map<std::string, std::unique_ptr<Cache>>;
+
+    enum class Lookup
+    {
+        /// A fresh response was found
+        HIT,
+        /// A stale response was found, the caller revalidates it in the background
+        STALE,
+        /// A stale response was found, another request is revalidating it
+        UPDATING,
+        /// No usable response, the caller has to fetch and `store()` or `unlock()` it
+        MISS,
+        /// Another request is fetching the response, look it up again later
+        WAIT,
+    };
+
+    /// @brief Creates a cache storing its files in `dir`
+    ///
+    /// @param dir The cache directory, created if it doesn't exist
+    /// @param max_size The total size of the responses, in bytes
+    Cache(const std::string& dir, size_t max_size);
+
+    /// @brief Looks up a response
+    ///
+    /// Only one caller gets `MISS` for a key until it calls
+    /// `store()` or `unlock()`, the others get `WAIT`.
+    ///
+    /// @param key The cache key
+    /// @param path Set to the file to `read()` on `HIT`, `STALE` and `UPDATING`
+    /// @return The lookup result
+    Lookup lookup(const std::string& key, std::string& path);
+
+    /// @brief Reads the response stored for `key`
+    ///
+    /// The file starts with the key, so that two keys with the same
+    /// file name never get each other's response. Only the file is
+    /// used, so it can be read off the event loop.
+    ///
+    /// @return false if the file is missing or stores another key, the
+    ///         caller then calls `forget()`
+    static bool read(const std::string& path, const std::string& key, std::string& response);
+
+    /// @brief Drops the response of a key after its file couldn't be read
+    ///
+    /// @param key The cache key
+    void forget(const std::string& key);
+
+    /// @brief Stores a response if it is cacheable and unlocks the key
+    ///
+    /// @param key The cache key
+    /// @param response The raw response of the upstream
+    /// @param valid Seconds a response without freshness information is cached
+    void store(const std::string& key, const std::string& response, time_t valid);
+
+    /// @brief Unlocks a key without storing a response
+    ///
+    /// @param key The cache key
+    void unlock(const std::string& key);
+
+    /// @brief Fetches a stale response again without a client waiting for it
+    ///
+    /// @param key The cache key
+    /// @param request The request that found the stale response
+    /// @param target The `proxy_pass` target
+    /// @param valid Seconds a response without freshness information is cached
+    void revalidate(const std::string& key,
+                    const Request&     request,
+                    const std::string& target,
+                    time_t             valid);
+
+    /// @brief Returns the cache for a directory, creating it if needed
+    ///
+    /// @param dir The cache directory
+    /// @param max_size The total size of the responses, the last one given applies
+    static Cache& get(const std::string& dir, size_t max_size);
+
+    /// @brief Returns the cache key of a request (method, host and URI)
+    static std::string key(const Request& request);
+
+    /// @brief Returns how long a response may be cached
+    ///
+    /// Reads `Cache-Control` (`no-store`, `private`, `no-cache`, `max-age`,
+    /// `s-maxage`, `stale-while-revalidate`) and `Expires`. Only 200, 301
+    /// and 404 responses without `Set-Cookie` are cacheable.
+    ///
+    /// @param response The raw response
+    /// @param now The current time
+    /// @param valid Seconds used when the response has no freshness information
+    /// @param stale Set to the seconds the response may be served stale
+    /// @return Seconds the response is fresh, 0 if it is not cacheable
+    static time_t freshness(const std::string& response, time_t now, time_t valid, time_t& stale);
+
+private:
+    using Lru = std::list<std::string>;
+
+    struct Entry
+    {
+        std::string path;
+        size_t      size        = 0;
+        time_t      expires     = 0;
+        time_t      stale_until = 0;
+        bool        locked      = false;
+
+        /// The position of the key in `_lru`, while the entry has a file
+        Lru::iterator lru = {};
+    };
+
+    using Entries = std::unordered_map<std::string, Entry>;
+
+    /// A revalidation, with a copy of the request since the headers of the
+    /// original are views into the buffer of its client
+    struct Refresh
+    {
+        Refresh(std::string key, std::string head);
+
+        std::string            key;
+        std::string            head;
+        Request                request;
+        std::unique_ptr<Proxy> proxy;
+    };
+
+    std::string        _dir;
+    size_t             _max_size;
+    size_t             _size;
+    Entries            _entries;
+    /// The keys of the stored responses, the most recently used first
+    Lru                _lru;
+    std::list<Refresh> _refreshes;
+
+    /// Writes the response for `key` to its file, with the key first
+    bool write(const std::string& key, const std::string& response) const;
+
+    /// Removes the file of an entry, dropping the entry unless it is locked
+    void evict(Entries::iterator it);
+
+    /// Evicts the least recently used responses until the cache fits its size
+    void shrink();
+
+    /// Returns the file that stores the response for `key`
+    std::string path(const std::string& key) const;
+
+    static Registry& registry();
+};
+}  // namespace webserv::http
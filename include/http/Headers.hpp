@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace webserv::http
+{
+/// The header names recognized while parsing, looked up by id instead of by name
+enum class Header : uint8_t
+{
+    HOST,
+    CONNECTION,
+    KEEP_ALIVE,
+    CONTENT_LENGTH,
+    CONTENT_TYPE,
+    TRANSFER_ENCODING,
+    ACCEPT,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    USER_AGENT,
+    REFERER,
+    COOKIE,
+    AUTHORIZATION,
+    CACHE_CONTROL,
+    PRAGMA,
+    ORIGIN,
+    UPGRADE,
+    IF_MODIFIED_SINCE,
+    IF_NONE_MATCH,
+    PROXY_CONNECTION,
+    X_FORWARDED_FOR,
+    /// Any other name, kept as it was received
+    OTHER,
+};
+
+/// The header fields of a request, as views into the block they were parsed from.
+///
+/// Well-known names are recognized to a `Header` id, so they are compared
+/// as integers and never copied; other names keep the case they were sent
+/// in. Fields are stored as offsets into the block, the first
+/// `INLINE_FIELDS` inside the object and the rest in a vector allocated
+/// from the memory resource. The block must outlive the headers.
+///
+/// Repeated fields are all kept, in order; lookups return the last one.
+class Headers
+{
+public:
+    /// Enough for the headers of nearly every request
+    static constexpr size_t INLINE_FIELDS = 16;
+
+    struct Field
+    {
+        Header id;
+        /// The lowercase name of well-known headers, the name as received otherwise
+        std::string_view name;
+        std::string_view value;
+    };
+
+    class Iterator
+    {
+    public:
+        Iterator(const Headers& headers, size_t index) : _headers(&headers), _index(index) {}
+
+        Field     operator*() const { return (*_headers)[_index]; }
+        Iterator& operator++()
+        {
+            ++_index;
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return _index == other._index; }
+
+    private:
+        const Headers* _headers;
+        size_t         _index;
+    };
+
+    explicit Headers(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // A copy would still point into the block of the original, which may not outlive it
+    Headers(const Headers&)            = delete;
+    Headers& operator=(const Headers&) = delete;
+    Headers(Headers&&)                 = default;
+    Headers& operator=(Headers&&)      = default;
+
+    /// @brief Parses header lines, replacing the fields
+    ///
+    /// @param block The lines, separated by "\r\n" or "\n", up to the empty line
+    /// @throw StatusCode 400 if a line has no colon, 413 if the block is too
+    ///        large to be indexed
+    void parse(std::string_view block);
+
+    /// @brief Returns the value of the last field with a well-known name
+    std::optional<std::string_view> find(Header id) const;
+
+    /// @brief Returns the value of the last field with a name
+    ///
+    /// @param name The name in lowercase
+    std::optional<std::string_view> find(std::string_view name) const;
+
+    bool contains(Header id) const { return (_present & (1u << static_cast<int>(id))) != 0; }
+
+    size_t size() const { return _size; }
+    bool   empty() const { return _size == 0; }
+
+    Field operator[](size_t index) const;
+
+    Iterator begin() const { return Iterator(*this, 0); }
+    Iterator end() const { return Iterator(*this, _size); }
+
+    /// @brief Recognizes a header name, ignoring case
+    ///
+    /// @return Its id, or `Header::OTHER` if it isn't well-known
+    static Header lookup(std::string_view name);
+
+    /// @brief Returns the lowercase name of a well-known header
+    static std::string_view name(Header id);
+
+private:
+    static_assert(static_cast<int>(Header::OTHER) < 32, "the ids must fit in _present");
+
+    /// A field as offsets into the block, which is at most 64 KiB
+    struct Slot
+    {
+        uint16_t name_offset;
+        uint16_t name_size;
+        uint16_t value_offset;
+        uint16_t value_size;
+        Header   id;
+    };
+
+    const char* _base = nullptr;
+    size_t      _size = 0;
+    /// A bit per well-known id, set if there is a field with it
+    uint32_t _present = 0;
+
+    std::array<Slot, INLINE_FIELDS> _inline;
+    std::pmr::vector<Slot>          _overflow;
+
+    const Slot& slot(size_t index) const;
+    void        add(std::string_view name, std::string_view value);
+};
+}  // namespace webserv::http
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <memory>
+
+#include "async/Promise.hpp"
+#include "http/Request.hpp"
+#include "net/Upstream.hpp"
+
+namespace webserv::http
+{
+using async::Promise;
+using net::Upstream;
+
+/// Forwards a request to an upstream server and relays its response.
+class Proxy
+{
+public:
+    enum class State
+    {
+        IDLE,
+        CONNECT,
+        WRITE,
+        READ,
+        DONE,
+        FAILED,
+    };
+
+    /// @brief Prepares a request to be forwarded to an upstream
+    ///
+    /// Only the upstream name of the target is used, the
+    /// request URI is forwarded unchanged.
+    ///
+    /// @param request the request object
+    /// @param target the `proxy_pass` target, e.g. "http://backend"
+    Proxy(const Request& request, const std::string& target);
+    ~Proxy();
+
+    Proxy(const Proxy&)            = delete;
+    Proxy& operator=(const Proxy&) = delete;
+
+    /// The largest upstream response, which is kept in memory until it is complete
+    static constexpr size_t MAX_RESPONSE_SIZE = 16 * 1024 * 1024;
+
+    /// @brief Connects to an upstream peer, sends the request and reads the response
+    ///
+    /// Resolves with the raw response of the upstream, or an empty string if
+    /// no peer could be reached or the response is larger than
+    /// `MAX_RESPONSE_SIZE` (state is `FAILED`).
+    Promise<std::string> get_output();
+
+    State state() const;
+
+    /// @brief Returns the upstream name of a `proxy_pass` target
+    ///
+    /// @param target The target, e.g. "http://backend/"
+    /// @return The upstream name, e.g. "backend"
+    static std::string upstream_name(const std::string& target);
+
+private:
+    enum class Framing
+    {
+        LENGTH,
+        CHUNKED,
+        CLOSE,
+    };
+
+    State                     _state;
+    const Request&            _request;
+    std::shared_ptr<Upstream> _upstream;
+    Upstream::Peer*           _peer;
+
+    int    _fd;
+    bool   _reused;
+    size_t _tries;
+
+    std::string _request_str;
+    size_t      _bytes_written;
+    std::string _output;
+
+    size_t  _header_end;
+    Framing _framing;
+    size_t  _content_length;
+    size_t  _chunk_pos;
+    bool    _keep_alive;
+
+    /// Selects a peer and starts connecting to it
+    void connect();
+    /// Counts a failure and retries with another peer if the request can be retried
+    void fail();
+    /// Gives up on the request without blaming the peer
+    void abort();
+    /// Releases the connection, keeping it alive for the next request if possible
+    void finish(bool keep_alive);
+    /// Stops polling the connection and gives it back to the upstream
+    void release(bool keep_alive);
+
+    /// Serializes the request for the upstream
+    std::string serialize() const;
+    /// Expands the `hash` key of the upstream for this request
+    std::string hash_key() const;
+    /// Parses the response headers once they are complete
+    void parse_head();
+    /// Checks if the complete response has been read
+    bool complete();
+
+    Promise<int>     connected();
+    Promise<ssize_t> read();
+    Promise<ssize_t> write();
+};
+}  // namespace webserv::http
@@ -1,15 +1,21 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+
+#include "http/Headers.hpp"
 
 namespace webserv::http
 {
+/// A request line, its headers and its body.
+///
+/// The strings and headers are allocated from the memory resource given to
+/// the constructor, the arena of the client while it is served. The headers
+/// are views into the input, which must outlive the request.
 class Request
 {
 public:
-    using Headers = std::unordered_map<std::string, std::string>;
-
     enum class Method
     {
         GET,
@@ -17,41 +23,56 @@ public:
         DELETE,
     };
 
-    Request(const std::string& input);
+    /// @brief Parses the request line and headers
+    ///
+    /// @param input The request up to and including the empty line after the
+    ///              headers, followed by the start of the body
+    /// @param resource The memory resource the request is allocated from
+    /// @throw StatusCode if the request is invalid
+    Request(std::string_view            input,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // The headers are views into `input`, a copy couldn't tell when it is gone
+    Request(const Request&)            = delete;
+    Request& operator=(const Request&) = delete;
 
-    Method             get_method() const;
-    const std::string& method_str() const;
-    const std::string& get_uri() const;
-    const std::string& get_query() const;
-    const Headers&     get_headers() const;
-    const std::string& host() const;
-    const std::string& body() const;
-    size_t             content_length() const;
-    bool               chunked() const;
+    Method           get_method() const;
+    std::string_view method_str() const;
+    std::string_view get_uri() const;
+    std::string_view get_path() const;
+    std::string_view get_query() const;
+    const Headers&   get_headers() const;
+    std::string_view host() const;
+    std::string_view body() const;
+    size_t           content_length() const;
+    bool             chunked() const;
 
     /// @brief Append to the body of the request.
     ///
     /// @param body The body to append.
-    void append_body(const std::string& body);
+    void append_body(std::string_view body);
 
-    /// @brief Remove the chunked encoding from the body.
+    /// @brief Remove the chunked encoding from the body, in place.
     void unchunk_body();
 
 private:
-    using MethodMap = std::unordered_map<std::string, Method>;
+    Method           _method;
+    std::pmr::string _uri;
+    /// The URI with its percent-encoded octets decoded, what locations and files are matched on
+    std::pmr::string _path;
+    std::pmr::string _query;
+    Headers          _headers;
+    /// On the heap rather than the arena, which never frees the buffers a growing body outgrows
+    std::string      _body;
+    size_t           _content_length;
+    bool             _chunked;
 
-    Method      _method;
-    std::string _uri;
-    std::string _query;
-    Headers     _headers;
-    std::string _body;
-    size_t      _content_length;
-    bool        _chunked;
+    void parse_line(std::string_view line);
+    void parse_headers(std::string_view headers);
 
-    void parse_line(const std::string& line);
-    void parse_headers(const std::string& headers);
+    static constexpr int HEADER_LIMIT = 8192;
 
-    static const MethodMap METHOD_MAP;
-    static constexpr int   HEADER_LIMIT = 8192;
+    /// The most reserved up front for a body of a known length, which isn't trusted
+    static constexpr size_t BODY_RESERVE_LIMIT = 1024 * 1024;
 };
 }  // namespace webserv::http
@@ -1,25 +1,38 @@
 #pragma once
 
+#include <functional>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "async/Promise.hpp"
+#include "async/ThreadPool.hpp"
 #include "config/Config.hpp"
+#include "http/Autoindex.hpp"
 #include "http/CGI.hpp"
+#include "http/Cache.hpp"
+#include "http/Proxy.hpp"
 #include "http/Request.hpp"
+#include "http/ResponseBuilder.hpp"
 #include "utils/Logger.hpp"
 
 namespace webserv::http
 {
 using async::Promise;
 using config::Config;
+using config::ResolvedLocation;
 using utils::ErrorLogger;
 
 class Request;
 
-class Response : public std::stringstream
+/// Handles a request and builds the response to it.
+///
+/// The response is built by a `ResponseBuilder`, which `get_output` hands
+/// to the client to send once it is complete. Files are opened, written
+/// and removed on the thread pool, unless the location has `aio off`;
+/// `get_output` finishes the response when that is done.
+class Response
 {
 public:
     enum class StatusCode : int
@@ -34,11 +47,23 @@ public:
         REQUEST_ENTITY_TOO_LARGE   = 413,
         INTERNAL_SERVER_ERROR      = 500,
         NOT_IMPLEMENTED            = 501,
+        BAD_GATEWAY                = 502,
         HTTP_VERSION_NOT_SUPPORTED = 505,
     };
 
     Response(const Request& request, const Config& config, ErrorLogger& elog);
-    Response(StatusCode code, const Config& config, ErrorLogger& elog);
+    /// @brief Creates an error response
+    ///
+    /// @param code Status code
+    /// @param config The server
+    /// @param elog The error logger
+    /// @param request The request that failed, if it could be parsed,
+    ///                used to find the location it is logged to
+    Response(StatusCode     code,
+             const Config&  config,
+             ErrorLogger&   elog,
+             const Request* request = nullptr);
+    ~Response();
 
     /// @brief Sets the response status code
     ///
@@ -61,7 +86,7 @@ public:
     /// @param body Response body, Content-Length will be set to body.size()
     Response& body(const std::string& body);
 
-    /// @brief Sends a file as the response body
+    /// @brief Sends a file as the response body, once it has been opened
     ///
     /// @param path Path to the file
     Response& file(const std::string& path);
@@ -69,30 +94,27 @@ public:
     /// @brief Sets the content type header based on the file extension
     ///
     /// @param extension File extension
-    Response& content_type(const std::string& extension);
+    Response& content_type(std::string_view extension);
 
     /// @brief Write request's multipart/form-data to a file
     ///
     /// @param uri URI of the request
     /// @param body Request body
-    Response& upload_file(const std::string& uri, const std::string& body);
+    Response& upload_file(std::string_view uri, std::string_view body);
 
     /// @brief Delete a file
     ///
     /// @param uri URI of the request
     Response& delete_file(const std::string& uri);
 
-    /// @brief Generates an autoindex page for a directory with a html template
+    /// @brief Lists a directory, in the format and pages of the location
     ///
-    /// @param path Path to the directory
-    /// @param uri URI of the request
-    Response& autoindex(const std::string& path, const std::string& uri);
-
-    /// @brief Generates an autoindex page for a directory with a buildin template
+    /// The directory is checked on the thread pool and its listing is
+    /// cached; the page is rendered by `get_output` once the listing is ready.
     ///
     /// @param path Path to the directory
     /// @param uri URI of the request
-    Response& autoindex_buildin(const std::string& path, const std::string& uri);
+    Response& autoindex(const std::string& path, const std::string& uri);
 
     /// @brief Returns the Content-Length header value
     ///
@@ -115,21 +137,22 @@ public:
     ///
     /// @param extension File extension
     /// @return Content type (MIME type)
-    static const std::string& get_content_type(const std::string& extension);
+    static std::string_view get_content_type(std::string_view extension);
 
     /// @brief Maps status code to its string representation
     ///
     /// @param code Status code
-    /// @return String representation of the status code
-    static const std::string& code_to_string(StatusCode code);
-
-    static const std::unordered_map<std::string, std::string> CONTENT_TYPES;
-    bool                                                      is_cgi(const std::string& uri);
+    /// @return String representation of the status code, "200 OK"
+    static std::string_view code_to_string(StatusCode code);
 
-    /// @brief generate a response page from a template
+    /// @brief Returns the status line of a status code
     ///
-    /// @param path Path to the template file
-    void generate_response_page(const std::string& path);
+    /// @param code Status code
+    /// @return The whole line, "HTTP/1.1 200 OK\r\n", or the one of 500 for
+    ///         codes without a line
+    static std::string_view status_line(StatusCode code);
+
+    bool is_cgi(const std::string& uri);
 
     /// @brief replace a placeholder in a html template
     ///
@@ -140,14 +163,84 @@ public:
                              const std::string& placeholder,
                              const std::string& value);
 
-    Promise<std::string> get_output();
+    /// @brief Waits for the response to be complete
+    ///
+    /// @return The builder of the response, owned by this object, as a promise
+    Promise<ResponseBuilder*> get_output();
+
+    /// @brief Returns the response built so far as a string
+    std::string str() const;
+
+    /// @brief Returns the status code of the response, 0 if there is none yet
+    int status() const;
+
+    /// @brief Returns the access log of the location, or `nullptr` if there is none
+    utils::AccessLog* access_log() const;
+
+    /// @brief Returns the counters of the location, or `nullptr` if there is none
+    utils::Metrics::Location* metrics() const;
 
 private:
-    const Config& _config;
+    /// What the filesystem work of a response found, defined with it
+    struct Job;
 
-    ssize_t _content_length;
+    using JobFn = std::function<void(Job&)>;
+
+    const Config&           _config;
+    const ResolvedLocation* _location;
+    const Request*          _request;
+
+    ResponseBuilder _builder;
+    ssize_t         _content_length;
+
+    std::unique_ptr<CGI>   _cgi;
+    std::unique_ptr<Proxy> _proxy;
+
+    /// The filesystem work running on the thread pool, and what is done
+    /// with it on the event loop
+    std::shared_ptr<async::Task<Job>> _job;
+    JobFn                             _then;
+
+    /// The directory being listed, until the page is rendered
+    std::shared_ptr<const Autoindex::Scan> _autoindex;
+    std::string                            _autoindex_uri;
+    std::string                            _autoindex_template;
+
+    Cache*      _cache;
+    std::string _cache_key;
+    bool        _cache_locked;
+
+    /// @brief Serves the response from the proxy cache
+    ///
+    /// The cached response is read like a file, on the thread pool with
+    /// `aio threads`. Otherwise the upstream is set up in `_proxy`, and
+    /// fetched if this response holds the cache lock.
+    void from_cache();
+
+    /// @brief Renders the autoindex page once the directory has been read
+    void render_autoindex();
+
+    /// @brief Runs filesystem work on the thread pool
+    ///
+    /// @param work Fills the job on a worker, a `StatusCode` it throws is
+    ///        kept in the job; it must not use the response, which may be
+    ///        destroyed before it runs
+    /// @param then Finishes the response on the event loop, a `StatusCode`
+    ///        it throws turns the response into an error page
+    void run(JobFn work, JobFn then);
+
+    /// @brief Finishes the response with the job once it is done
+    void resume();
+
+    /// @brief Sends the file opened by a job
+    ///
+    /// @param job The job
+    /// @param path The path of the file, for its content type
+    /// @throw StatusCode The status of the job if the file couldn't be opened
+    void send(Job& job, std::string_view path);
 
-    std::unique_ptr<CGI> _cgi;
+    /// @brief Replaces the response with the error page of a status code
+    void error(StatusCode code);
 
     ErrorLogger& _elog;
 };
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <string>
+#include <string_view>
+
+namespace webserv::http
+{
+/// Builds a response as two segments: the status line and headers in a
+/// contiguous buffer, and the body, kept in memory or as a range of a file.
+///
+/// The segments are handed to the socket as iovecs and files are sent with
+/// `sendfile`, so the body is never copied into the head. Sending advances
+/// through the segments, so a response can be written over several calls.
+class ResponseBuilder
+{
+public:
+    /// A range of a file left to send
+    struct FileRange
+    {
+        int    fd;
+        off_t  offset;
+        size_t length;
+    };
+
+    ResponseBuilder();
+
+    /// @brief Closes the file of the body
+    ~ResponseBuilder();
+
+    ResponseBuilder(const ResponseBuilder&)            = delete;
+    ResponseBuilder& operator=(const ResponseBuilder&) = delete;
+    ResponseBuilder(ResponseBuilder&& other) noexcept;
+    ResponseBuilder& operator=(ResponseBuilder&& other) noexcept;
+
+    /// @brief Starts the response with a status line, dropping what was built
+    ///
+    /// @param line The whole line, "HTTP/1.1 200 OK\r\n"
+    ResponseBuilder& status_line(std::string_view line);
+
+    /// @brief Starts the response with a status line, dropping what was built
+    ///
+    /// @param code The status code and reason, "200 OK"
+    ResponseBuilder& status(std::string_view code);
+
+    /// @brief Adds a header
+    ResponseBuilder& header(std::string_view key, std::string_view value);
+
+    /// @brief Adds a header with a numeric value
+    ResponseBuilder& header(std::string_view key, size_t value);
+
+    /// @brief Ends the headers with Content-Length and sets a body in memory
+    ///
+    /// @param body The body
+    ResponseBuilder& body(std::string body);
+
+    /// @brief Ends the headers with Content-Length and sets a file as the body
+    ///
+    /// @param fd The file, closed by the builder
+    /// @param size The size of the file
+    ResponseBuilder& file(int fd, size_t size);
+
+    /// @brief Replaces the response with one that is already serialized
+    ///
+    /// @param response The status line, headers and body
+    ResponseBuilder& raw(std::string response);
+
+    /// @brief Returns the status code of the response, 0 if there is none
+    int status_code() const;
+
+    /// @brief Returns the whole response as a string, reading the file of the body
+    std::string str() const;
+
+    /// @brief Gets the memory segments left to send
+    ///
+    /// @param iov The segments, the head and a body in memory
+    /// @return The number of segments, 0 when only the file is left
+    size_t iovecs(iovec (&iov)[2]) const;
+
+    /// @brief Returns the range of the file left to send, once the head is sent
+    ///
+    /// @return The range, or `nullptr` if the body isn't a file or it is sent
+    const FileRange* file_range() const;
+
+    /// @brief Returns true if part of the body is left to send from a file
+    bool has_file() const { return _file.fd != -1 && _file.length > 0; }
+
+    /// @brief Marks bytes as sent, in the order of the segments
+    void advance(size_t bytes);
+
+    /// @brief Returns true once the whole response has been sent
+    bool done() const;
+
+    /// @brief Returns the bytes sent so far
+    size_t sent() const { return _sent; }
+
+private:
+    static constexpr size_t HEAD_SIZE = 512;
+
+    std::string _head;
+    std::string _body;
+    FileRange   _file;
+
+    /// Bytes sent so far, counted from the start of the head
+    size_t _sent;
+
+    void close_file();
+};
+}  // namespace webserv::http
@@ -18,6 +18,12 @@ public:
     sockaddr_in& get_sockaddr();
     int          get_port() const;
 
+    /// Returns true for the wildcard address 0.0.0.0
+    bool is_any() const;
+
+    bool operator==(const Address& other) const;
+    bool operator<(const Address& other) const;
+
     /// Returns a string representation of the address
     /// in the format "address:port".
     std::string to_string() const;
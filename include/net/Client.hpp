@@ -1,9 +1,13 @@
 #pragma once
 
+#include <chrono>
+#include <optional>
+
 #include "config/Config.hpp"
 #include "http/Request.hpp"
 #include "http/Response.hpp"
 #include "net/Socket.hpp"
+#include "utils/Arena.hpp"
 #include "utils/Logger.hpp"
 
 namespace webserv::net
@@ -30,21 +34,49 @@ public:
 
     bool is_connected() const;
 
+    /// Closes the connection, the client is freed by its virtual server
+    void disconnect();
+
+    /// Returns true if the client is waiting for a new request
+    bool is_idle() const;
+
+    /// Returns true if the client has a request being answered
+    bool is_writing() const;
+
 private:
     /// Asynchronously reads a request from the client
     ///
     /// @return The request as a promise
     Promise<StatusCode> read_request();
 
+    /// Parses what was read of the request so far
+    ///
+    /// @return The status of the request once it is complete or invalid
+    std::optional<StatusCode> parse_request();
+
+    /// Records the request that was just answered in the metrics
+    /// and queues it to the access log
+    ///
+    /// @param bytes_sent The number of bytes sent, -1 if sending failed
+    void record(ssize_t bytes_sent);
+
     VirtualServer& _server;
     ErrorLogger&   _elog;
 
-    std::unique_ptr<Request>  _request;
+    /// The configuration of the current request, kept alive across reloads
+    std::shared_ptr<const Config> _generation;
+
+    /// Holds the current request, rewound once it has been answered
+    utils::Arena _arena;
+
+    std::optional<Request>    _request;
     std::unique_ptr<Response> _response;
 
-    std::vector<char> _buffer;
-    std::string       _request_str;
-    std::string       _response_str;
+    /// When the first byte of the current request arrived
+    std::chrono::steady_clock::time_point _start;
+
+    /// The request line and headers until they are parsed
+    std::pmr::string _request_str;
 
     bool _is_connected = true;
 };
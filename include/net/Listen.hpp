@@ -10,6 +10,13 @@ class Listen : public Socket
 public:
     Listen(Address address);
 
+    /// Takes over a socket that is already listening,
+    /// e.g. one inherited from the process that exec'd this one.
+    ///
+    /// @param address The address the socket is bound to
+    /// @param fd The listening socket
+    Listen(Address address, int fd);
+
     Listen(const Listen&)            = delete;
     Listen& operator=(const Listen&) = delete;
 
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <list>
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "async/Signal.hpp"
 #include "config/Config.hpp"
+#include "net/Upstream.hpp"
 #include "net/VirtualServer.hpp"
 #include "utils/Logger.hpp"
 
@@ -13,23 +19,125 @@ using config::Config;
 using utils::ErrorLogger;
 
 /// A single-threaded non-blocking web server.
+///
+/// Reloads its configuration file on SIGHUP: listening sockets that are
+/// still configured are kept, new ones are bound and removed ones stop
+/// accepting while their clients finish.
+///
+/// On SIGUSR2 it execs its binary again, handing over the listening
+/// sockets, and exits once its clients are done.
 class Server
 {
 public:
-    using VirtualServers = std::map<int, std::unique_ptr<VirtualServer>>;
+    using VirtualServers = std::map<Address, std::unique_ptr<VirtualServer>>;
 
-    Server(const Config& config, ErrorLogger& elog);
+    /// @brief Loads the configuration and binds its listening sockets
+    ///
+    /// @param config_path Path to the configuration file
+    /// @param elog The error logger
+    Server(const std::string& config_path, ErrorLogger& elog);
 
-    /// Runs the event loop.
+    /// @brief Stops reporting the connections to the metrics
+    ~Server();
+
+    /// Runs the event loop until the server has been upgraded
+    /// and its last client is done, or it receives SIGTERM.
     void run();
 
     /// @brief Returns the http directive configuration.
     const Config& get_config() const;
 
+    /// @brief Loads the configuration file again and applies it
+    ///
+    /// The running configuration is kept if the file is invalid
+    /// or one of its addresses can't be bound.
+    void reload();
+
+    /// @brief Starts the binary again with the same arguments
+    ///
+    /// The new process inherits the listening sockets. Once it
+    /// is ready, this one stops accepting and drains its clients.
+    void upgrade();
+
+    /// Listening sockets handed to an upgraded binary, as `address=fd;...`
+    static constexpr const char* LISTEN_FDS_ENV = "WEBSERV_LISTEN_FDS";
+
+    /// A pipe the upgraded binary writes to once it runs
+    static constexpr const char* READY_FD_ENV = "WEBSERV_READY_FD";
+
 private:
-    const Config& _config;
-    ErrorLogger&  _elog;
+    /// An address a server listens on and the socket that accepts its connections
+    struct Binding
+    {
+        Address       address;
+        const Config* server;
+        bool          default_server;
+    };
+
+    using Bindings = std::map<Address, std::vector<Binding>>;
+
+    std::string  _config_path;
+    ErrorLogger& _elog;
+
+    std::shared_ptr<const Config> _config;
+
+    VirtualServers                            _virtual_servers;
+    std::list<std::unique_ptr<VirtualServer>> _draining;
+
+    /// Listening sockets inherited from the previous binary
+    std::map<Address, int> _inherited;
+
+    async::Signal _reload;
+    async::Signal _upgrade;
+    async::Signal _terminate;
+    bool          _upgrading;
+    bool          _terminating;
+
+    /// @brief Applies a configuration
+    ///
+    /// @param config The main directive of the configuration
+    /// @throw std::runtime_error if the configuration can't be applied,
+    ///        in which case the running one is left untouched
+    void apply(std::shared_ptr<const Config> config);
+
+    /// @brief Creates the upstreams that locations can proxy to
+    ///
+    /// @param http The http directive
+    /// @return The upstreams by name
+    static Upstream::Registry upstreams(const Config& http);
+
+    /// @brief Groups the addresses of the servers by listening socket
+    ///
+    /// @param http The http directive
+    /// @return The bindings of each listening socket
+    static Bindings bindings(const Config& http);
+
+    /// @brief Reloads the configuration on each SIGHUP
+    void wait_reload();
+
+    /// @brief Upgrades the binary on each SIGUSR2
+    void wait_upgrade();
+
+    /// @brief Stops the event loop on SIGTERM
+    ///
+    /// The server returns from `run` instead of being killed, so that
+    /// destructors and exit handlers, such as the profile dump of an
+    /// instrumented build, run.
+    void wait_terminate();
+
+    /// @brief Takes the listening sockets of the previous binary from the environment
+    void inherit();
+
+    /// @brief Tells the previous binary that this one is ready
+    ///
+    /// Closes the inherited sockets the configuration doesn't use.
+    void notify_ready();
 
-    VirtualServers _virtual_servers;
+    /// @brief Logs a callback slower than `slow_callback_threshold`
+    ///
+    /// @param fd The fd of the callback, -1 for a blocking promise
+    /// @param peer The peer address of the fd, or `nullptr`
+    /// @param duration The time it ran for
+    void log_slow_callback(int fd, const sockaddr_in* peer, std::chrono::microseconds duration);
 };
 }  // namespace webserv::net
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string_view>
+
+#include "config/Config.hpp"
+#include "utils/FlatMap.hpp"
+
+namespace webserv::net
+{
+using config::Config;
+
+/// Resolves the `Host` of a request to one of the servers listening on an address.
+///
+/// Names are matched case-insensitively in the order: exact names, the longest
+/// leading wildcard (`*.example.com`), then the longest trailing wildcard
+/// (`www.example.*`). Hosts that match no name go to the `default_server`,
+/// or to the first server added. The names are views of the config's
+/// parameters, so matching never allocates.
+class ServerNames
+{
+public:
+    ServerNames();
+
+    /// @brief Adds the names of a server
+    ///
+    /// A name already added by a previous server is kept.
+    ///
+    /// @param server The server directive
+    /// @param default_server The server is the default for its address
+    void add(const Config& server, bool default_server);
+
+    /// @brief Finds the server for a host
+    ///
+    /// @param host The host name, without the port
+    /// @return The matching server or the default one
+    const Config& find(std::string_view host) const;
+
+private:
+    /// Case-insensitive hash and equality of names
+    struct Hash
+    {
+        size_t operator()(std::string_view name) const;
+    };
+    struct Equal
+    {
+        bool operator()(std::string_view lhs, std::string_view rhs) const;
+    };
+
+    using Names = utils::FlatMap<std::string_view, const Config*, Hash, Equal>;
+
+    Names _exact;
+    Names _leading;   // `*.example.com` stored as ".example.com"
+    Names _trailing;  // `www.example.*` stored as "www.example."
+
+    const Config* _default;
+    bool          _explicit_default;
+};
+}  // namespace webserv::net
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <vector>
-
 #include "async/Promise.hpp"
+#include "http/ResponseBuilder.hpp"
 #include "net/Address.hpp"
+#include "utils/BufferPool.hpp"
 
 namespace webserv::net
 {
@@ -32,17 +32,25 @@ public:
     /// @param address The address to bind to the socket
     void bind(Address address);
 
-    /// Asynchronously reads data from the socket into the buffer
+    /// Reads the data available on the socket
+    ///
+    /// The buffer is borrowed from a shared pool only once there is data,
+    /// and goes back to it when the caller is done with it. The data is
+    /// taken with `Poller::receive`, so the socket is watched for
+    /// `Event::RECEIVE`.
     ///
-    /// @param buffer The buffer to read data into
-    /// @return The number of bytes read as a promise
-    Promise<ssize_t> read(std::vector<char>& buffer);
+    /// @return The data read, empty at the end of the stream or on error,
+    ///         or nothing if no data is available yet
+    std::optional<utils::BufferPool::Buffer> read();
 
-    /// Asynchronously writes data from the buffer to the socket
+    /// Asynchronously writes a response to the socket
+    ///
+    /// The head and a body in memory are sent with one `sendmsg`,
+    /// a file body with `sendfile`, until all of it is sent.
     ///
-    /// @param buffer The buffer to write data from
-    /// @return The number of bytes written as a promise
-    Promise<ssize_t> write(const std::vector<char>& buffer);
+    /// @param response The response, which must outlive the promise
+    /// @return The number of bytes written, or -1 on error, as a promise
+    Promise<ssize_t> write(http::ResponseBuilder& response);
 
 protected:
     Address _address;
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config/Config.hpp"
+#include "net/Address.hpp"
+
+namespace webserv::net
+{
+using config::Config;
+
+/// A group of backend servers that requests can be proxied to.
+class Upstream
+{
+public:
+    using Clock    = std::chrono::steady_clock;
+    using Registry = std::map<std::string, std::shared_ptr<Upstream>>;
+
+    enum class Balance
+    {
+        ROUND_ROBIN,
+        LEAST_CONN,
+        HASH,
+    };
+
+    struct Peer
+    {
+        Address address;
+        int     weight       = 1;
+        int     max_fails    = 1;
+        int     fail_timeout = 10;
+
+        int               current_weight = 0;
+        int               active         = 0;
+        int               fails          = 0;
+        Clock::time_point down_until     = {};
+
+        /// Idle keep-alive connections to this peer
+        std::vector<int> idle;
+
+        /// @brief Checks if the peer can be selected
+        ///
+        /// A peer is marked down for `fail_timeout` seconds
+        /// after `max_fails` consecutive failures, never if it is 0.
+        bool is_up(Clock::time_point now) const;
+    };
+
+    /// @brief Creates an upstream from an `upstream` block
+    ///
+    /// @param config The upstream directive
+    Upstream(const Config& config);
+
+    /// @brief Creates an upstream with a single peer
+    ///
+    /// Used for `proxy_pass` targets that are an address instead of an upstream name.
+    ///
+    /// @param name Name of the upstream
+    /// @param address Address of the peer
+    Upstream(const std::string& name, Address address);
+    ~Upstream();
+
+    Upstream(const Upstream&)            = delete;
+    Upstream& operator=(const Upstream&) = delete;
+
+    /// @brief Selects a peer using the configured balancing method
+    ///
+    /// @param key The key used by the `hash` method
+    /// @return The selected peer or `nullptr` if all peers are down
+    Peer* select(const std::string& key);
+
+    /// @brief Gets a connection to a peer
+    ///
+    /// Reuses an idle keep-alive connection if there is one,
+    /// otherwise starts a non-blocking connect.
+    ///
+    /// @param peer The peer to connect to
+    /// @param reused Set to true if an idle connection was reused
+    /// @return The file descriptor of the connection or -1 on failure
+    int connect(Peer& peer, bool& reused);
+
+    /// @brief Gives a connection back to the upstream
+    ///
+    /// @param peer The peer the connection belongs to
+    /// @param fd The file descriptor of the connection
+    /// @param keep_alive Keep the connection in the idle pool if there is room
+    void release(Peer& peer, int fd, bool keep_alive);
+
+    /// @brief Resets the failure count of a peer
+    void success(Peer& peer);
+
+    /// @brief Counts a failure for a peer, marking it down after `max_fails`
+    void failure(Peer& peer);
+
+    const std::string&       get_name() const;
+    Balance                  get_balance() const;
+    const std::string&       get_hash_key() const;
+    const std::vector<Peer>& get_peers() const;
+
+    /// @brief Returns all upstreams by name
+    static Registry& registry();
+
+    /// @brief Finds an upstream by name
+    ///
+    /// The upstream is shared so requests in flight keep it
+    /// when the configuration is reloaded.
+    ///
+    /// @param name Name of the upstream
+    /// @return The upstream or `nullptr` if it doesn't exist
+    static std::shared_ptr<Upstream> find(const std::string& name);
+
+    /// @brief Parses an address in the format "host[:port]"
+    ///
+    /// The host is resolved to its first IPv4 address with getaddrinfo.
+    ///
+    /// @param address The address to parse
+    /// @return The parsed address, the port defaults to 80
+    /// @throw std::runtime_error if the port is invalid or the host can't be resolved
+    static Address parse_address(const std::string& address);
+
+private:
+    using Ring = std::vector<std::pair<uint32_t, size_t>>;
+
+    static constexpr int RING_POINTS = 160;
+
+    std::string       _name;
+    Balance           _balance;
+    std::string       _hash_key;
+    size_t            _keepalive;
+    std::vector<Peer> _peers;
+    Ring              _ring;
+
+    Peer* select_round_robin(Clock::time_point now);
+    Peer* select_least_conn(Clock::time_point now);
+    Peer* select_hash(const std::string& key, Clock::time_point now);
+
+    /// Builds the consistent hash ring, `RING_POINTS` per unit of weight
+    void build_ring();
+};
+}  // namespace webserv::net
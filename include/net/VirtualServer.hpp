@@ -1,45 +1,94 @@
 #pragma once
 
-#include <string>
-#include <unordered_map>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 #include "config/Config.hpp"
 #include "net/Client.hpp"
 #include "net/Listen.hpp"
+#include "net/ServerNames.hpp"
 #include "utils/Logger.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/Pool.hpp"
 
 namespace webserv::net
 {
 using config::Config;
 using utils::Logger;
 
+/// A listening socket and the servers reachable through it.
+///
+/// A socket bound to the wildcard address also takes the connections for
+/// the other addresses on its port, each with their own servers.
 class VirtualServer : public Listen
 {
 public:
-    using ConfigMap = std::unordered_map<std::string, const Config*>;
-    using Clients   = std::vector<std::unique_ptr<Client>>;
+    using Names   = std::map<Address, ServerNames>;
+    using Clients = utils::Pool<Client>;
 
-    VirtualServer(Address address, const std::string& default_name, ErrorLogger& elog);
+    VirtualServer(Address address, ErrorLogger& elog);
 
-    /// @brief Accepts new connections and adds them to the clients list
+    /// @brief Creates a virtual server on an inherited listening socket
+    ///
+    /// @param address The address the socket is bound to
+    /// @param fd The listening socket
+    /// @param elog The error logger
+    VirtualServer(Address address, int fd, ErrorLogger& elog);
+
+    /// @brief Accepts new connections and frees the clients that disconnected
     void listen();
 
+    /// @brief Marks a client as disconnected, it is freed by the next `listen`
+    ///
+    /// @param client The client, which mustn't be used afterwards
+    void disconnect(Client& client);
+
+    /// @brief Replaces the servers with the ones of a new configuration
+    ///
+    /// Clients keep the configuration of the request they are handling.
+    ///
+    /// @param config The main directive of the new configuration
+    void set_generation(std::shared_ptr<const Config> config);
+
+    /// @brief Returns the main directive of the configuration in use
+    std::shared_ptr<const Config> get_generation() const;
+
+    /// @brief Stops accepting connections
+    ///
+    /// The clients finish their current request, idle ones are closed.
+    void stop();
+
+    /// @brief Returns true if a stopped virtual server has no clients left
+    bool is_drained() const;
+
+    /// @brief Adds the clients to the connection counts of the metrics
+    void count_connections(utils::Metrics::Connections& connections) const;
+
     /// @brief Add config to the virtual server
     ///
+    /// @param address The address the server listens on
     /// @param config Config to add
-    void add_config(const Config& config);
+    /// @param default_server The server is the default for its address
+    void add_config(const Address& address, const Config& config, bool default_server);
 
     /// @brief Get config by host
     ///
+    /// @param client The connection the request came from
     /// @param host Host to get config for
-    const Config& get_config(const std::string& host) const;
+    const Config& get_config(const Socket& client, std::string_view host) const;
 
 private:
     ErrorLogger& _elog;
 
-    const std::string& _default_name;
+    std::shared_ptr<const Config> _generation;
+
+    Names   _names;
+    Clients _clients;
+    bool    _stopped;
 
-    ConfigMap _configs;
-    Clients   _clients;
+    /// The clients to free, a disconnect can happen in one of their callbacks
+    std::vector<Client*> _disconnected;
 };
 }  // namespace webserv::net
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <netinet/in.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "utils/RingBuffer.hpp"
+
+namespace webserv::utils
+{
+/// Logs the requests that were served, one line per request.
+///
+/// The event loop only copies a record into a preallocated ring buffer.
+/// A background thread formats the records and writes them to the file
+/// in large batches, and sleeps while there are none. Records are dropped,
+/// and counted, if the writer falls behind.
+class AccessLog
+{
+public:
+    enum class Format
+    {
+        COMBINED,
+        JSON,
+    };
+
+    /// The fields of a request that are logged, truncated to fit
+    struct Record
+    {
+        time_t   time;
+        uint32_t address;
+        int      status;
+        size_t   bytes_sent;
+        uint32_t request_time_us;
+
+        /// Empty when the connection had no request
+        char method[16];
+        char uri[384];
+        char query[128];
+        char referer[256];
+        char user_agent[256];
+    };
+
+    using Registry = std::map<std::pair<std::string, Format>, std::unique_ptr<AccessLog>>;
+
+    /// @brief Opens the log file and starts the writer thread
+    ///
+    /// @param path Path to the log file, opened for appending
+    /// @param format The format of the lines
+    /// @throw std::runtime_error if the file can't be opened
+    AccessLog(const std::string& path, Format format);
+
+    /// @brief Writes the remaining records and stops the writer thread
+    ~AccessLog();
+
+    AccessLog(const AccessLog&)            = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    /// @brief Queues a request to be logged, from the event loop only
+    ///
+    /// @param address The client address
+    /// @param status The response status code
+    /// @param bytes_sent The number of bytes sent to the client
+    /// @param request_time_us The time spent on the request in microseconds
+    /// @param method The request method, empty without a request
+    /// @param uri The request URI, without the query
+    /// @param query The query string
+    /// @param referer The Referer header
+    /// @param user_agent The User-Agent header
+    void log(const sockaddr_in& address,
+             int                status,
+             size_t             bytes_sent,
+             uint32_t           request_time_us,
+             std::string_view   method,
+             std::string_view   uri,
+             std::string_view   query,
+             std::string_view   referer,
+             std::string_view   user_agent);
+
+    /// @brief Returns the number of records dropped because the buffer was full
+    size_t dropped() const;
+
+    /// @brief Gets the log for a file and format, opening it on first use
+    ///
+    /// Locations that log to the same file in different formats get a log
+    /// each, which append whole batches of lines.
+    ///
+    /// @param path Path to the log file
+    /// @param format The format, "combined" or "json"
+    /// @return The log
+    /// @throw std::runtime_error if the format is unknown or the file can't be opened
+    static AccessLog& get(const std::string& path, const std::string& format);
+
+    /// @brief Returns the format with a name
+    ///
+    /// @throw std::runtime_error if the format is unknown
+    static Format format_of(const std::string& name);
+
+    /// @brief Formats a record as a line
+    ///
+    /// @param record The record
+    /// @param format The format of the line
+    /// @param timestamp The time of the record, as formatted for `format`
+    /// @param line The string to append the line to
+    static void format(const Record&    record,
+                       Format           format,
+                       std::string_view timestamp,
+                       std::string&     line);
+
+private:
+    static constexpr size_t CAPACITY   = 4096;
+    static constexpr size_t BATCH_SIZE = 64 * 1024;
+
+    int                          _fd;
+    Format                       _format;
+    RingBuffer<Record, CAPACITY> _records;
+    std::atomic<size_t>          _dropped;
+    std::atomic<bool>            _running;
+    std::thread                  _writer;
+
+    /// Set while the writer waits for records on `_wakeup`
+    std::atomic<bool>       _sleeping;
+    std::mutex              _mutex;
+    std::condition_variable _wakeup;
+
+    /// The timestamp of the last second seen by the writer
+    time_t _timestamp_time;
+    char   _timestamp[64];
+
+    /// @brief Formats and writes the queued records until stopped
+    void write_loop();
+
+    /// @brief Waits until records are queued or the log is stopped, writer only
+    void wait();
+
+    /// @brief Wakes the writer if it is waiting
+    void wake();
+
+    /// @brief Returns the formatted timestamp, refreshed once per second
+    std::string_view timestamp(time_t time);
+
+    static Registry& registry();
+};
+}  // namespace webserv::utils
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+#include "utils/BufferPool.hpp"
+
+namespace webserv::utils
+{
+/// A monotonic arena over a block borrowed from a pool.
+///
+/// Allocating bumps a pointer and deallocating does nothing, the memory is
+/// only reclaimed by `reset`. The block is taken on the first allocation and
+/// given back on reset, so an arena with nothing allocated holds no memory.
+/// What doesn't fit in the block is taken from the heap and freed on reset.
+///
+/// Objects allocated from the arena must be destroyed before it is reset.
+class Arena : public std::pmr::memory_resource
+{
+public:
+    /// Enough for the request line, headers and bookkeeping of most requests
+    static constexpr size_t BLOCK_SIZE = 16384;
+
+    /// @brief Creates an arena without a block
+    ///
+    /// @param pool The pool to take the block from
+    explicit Arena(BufferPool& pool = Arena::blocks());
+
+    Arena(const Arena&)            = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// @brief Frees everything allocated since the last reset and gives the block back
+    void reset();
+
+    /// @brief Returns the number of allocations since the last reset
+    size_t allocations() const { return _allocations; }
+
+    /// @brief Returns the bytes allocated since the last reset
+    size_t allocated() const { return _allocated; }
+
+    /// @brief Returns the pool of `BLOCK_SIZE` blocks of the event loop
+    static BufferPool& blocks();
+
+private:
+    BufferPool&        _pool;
+    BufferPool::Buffer _block;
+
+    /// Set while the arena has a block
+    std::optional<std::pmr::monotonic_buffer_resource> _resource;
+
+    size_t _allocations = 0;
+    size_t _allocated   = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void  do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+}  // namespace webserv::utils
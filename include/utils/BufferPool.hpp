@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace webserv::utils
+{
+/// A pool of fixed-size buffers, borrowed while there is data to hold.
+///
+/// Connections only take a buffer once data is ready and give it back when
+/// they are done with it, so the buffers in use follow the active
+/// connections rather than the open ones. Released buffers are kept for
+/// reuse, up to `max_free`, and the rest are freed.
+///
+/// A pool is used by a single thread, the event loop.
+class BufferPool
+{
+public:
+    /// Enough to keep the buffers of a burst of connections
+    static constexpr size_t MAX_FREE = 1024;
+
+    /// A buffer borrowed from a pool, returned when it is destroyed
+    class Buffer
+    {
+    public:
+        Buffer() = default;
+        ~Buffer();
+
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+
+        char*       data() { return _data.get(); }
+        const char* data() const { return _data.get(); }
+
+        /// @brief Returns the number of bytes of the buffer that hold data
+        size_t size() const { return _size; }
+
+        /// @brief Sets the number of bytes of the buffer that hold data
+        void resize(size_t size) { _size = size; }
+
+        /// @brief Returns the size of the buffer
+        size_t capacity() const;
+
+        /// @brief Returns the data of the buffer
+        std::string_view view() const { return {_data.get(), _size}; }
+
+        /// @brief Returns true if the buffer was borrowed, false if it is empty
+        explicit operator bool() const { return _data != nullptr; }
+
+    private:
+        friend class BufferPool;
+
+        Buffer(BufferPool& pool, std::unique_ptr<char[]> data);
+
+        BufferPool*             _pool = nullptr;
+        std::unique_ptr<char[]> _data;
+        size_t                  _size = 0;
+    };
+
+    /// @brief Creates an empty pool
+    ///
+    /// @param buffer_size The size of each buffer
+    /// @param max_free The number of released buffers kept for reuse
+    explicit BufferPool(size_t buffer_size, size_t max_free = MAX_FREE);
+
+    BufferPool(const BufferPool&)            = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /// @brief Borrows a buffer, reusing a released one if there is any
+    Buffer acquire();
+
+    /// @brief Returns the size of each buffer
+    size_t buffer_size() const { return _buffer_size; }
+
+    /// @brief Returns the number of buffers borrowed
+    size_t in_use() const { return _in_use; }
+
+    /// @brief Returns the number of released buffers kept for reuse
+    size_t free() const { return _free.size(); }
+
+private:
+    size_t _buffer_size;
+    size_t _max_free;
+    size_t _in_use = 0;
+
+    std::vector<std::unique_ptr<char[]>> _free;
+
+    void release(std::unique_ptr<char[]> data);
+};
+}  // namespace webserv::utils
@@ -0,0 +1,412 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace webserv::utils
+{
+/// An open-addressing hash map laid out like a SwissTable.
+///
+/// Each slot has a control byte holding 7 bits of the hash of its key, or
+/// marking it empty or deleted. Lookups probe groups of 16 control bytes,
+/// comparing them at once with SSE2, and only compare keys whose hash bits
+/// match, so most lookups touch one group and one slot. Maps that fit in a
+/// single group are scanned without hashing.
+///
+/// Elements move when the map grows: references and iterators are
+/// invalidated by inserting. Lookups are heterogeneous when the hash and
+/// equality accept other key types, like `std::string_view`.
+template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<>>
+class FlatMap
+{
+public:
+    using key_type    = K;
+    using mapped_type = V;
+    using value_type  = std::pair<const K, V>;
+
+    template <bool Const>
+    class Iterator
+    {
+    public:
+        using value_type =
+            std::conditional_t<Const, const FlatMap::value_type, FlatMap::value_type>;
+        using reference = value_type&;
+        using pointer   = value_type*;
+
+        Iterator() = default;
+
+        reference operator*() const { return *_slot; }
+        pointer   operator->() const { return _slot; }
+
+        Iterator& operator++()
+        {
+            ++_ctrl;
+            ++_slot;
+            this->skip_free();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return _slot == other._slot; }
+
+        operator Iterator<true>() const
+            requires(!Const)
+        {
+            return Iterator<true>(_ctrl, _slot, _end);
+        }
+
+    private:
+        friend class FlatMap;
+
+        Iterator(const int8_t* ctrl, pointer slot, const int8_t* end)
+            : _ctrl(ctrl), _slot(slot), _end(end)
+        {
+        }
+
+        void skip_free()
+        {
+            while (_ctrl != _end && *_ctrl < 0) {
+                ++_ctrl;
+                ++_slot;
+            }
+        }
+
+        const int8_t* _ctrl = nullptr;
+        pointer       _slot = nullptr;
+        const int8_t* _end  = nullptr;
+    };
+
+    using iterator       = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatMap() = default;
+
+    ~FlatMap() { this->destroy(); }
+
+    FlatMap(const FlatMap& other) : FlatMap()
+    {
+        this->reserve(other.size());
+        for (const auto& [key, value] : other) {
+            this->emplace(key, value);
+        }
+    }
+
+    FlatMap(FlatMap&& other) noexcept
+        : _ctrl(std::exchange(other._ctrl, nullptr)),
+          _slots(std::exchange(other._slots, nullptr)),
+          _capacity(std::exchange(other._capacity, 0)),
+          _size(std::exchange(other._size, 0)),
+          _growth_left(std::exchange(other._growth_left, 0))
+    {
+    }
+
+    FlatMap& operator=(FlatMap other) noexcept
+    {
+        std::swap(_ctrl, other._ctrl);
+        std::swap(_slots, other._slots);
+        std::swap(_capacity, other._capacity);
+        std::swap(_size, other._size);
+        std::swap(_growth_left, other._growth_left);
+        return *this;
+    }
+
+    iterator       begin() { return this->make_iterator(0, true); }
+    const_iterator begin() const { return this->make_iterator(0, true); }
+    iterator       end() { return this->make_iterator(_capacity, false); }
+    const_iterator end() const { return this->make_iterator(_capacity, false); }
+
+    size_t size() const { return _size; }
+    bool   empty() const { return _size == 0; }
+
+    /// @brief Finds the element of a key
+    template <typename Q>
+    iterator find(const Q& key)
+    {
+        size_t index = this->find_index(key);
+        return index == NOT_FOUND ? this->end() : this->make_iterator(index, false);
+    }
+
+    template <typename Q>
+    const_iterator find(const Q& key) const
+    {
+        size_t index = this->find_index(key);
+        return index == NOT_FOUND ? this->end() : this->make_iterator(index, false);
+    }
+
+    template <typename Q>
+    bool contains(const Q& key) const
+    {
+        return this->find_index(key) != NOT_FOUND;
+    }
+
+    /// @brief Inserts an element if its key isn't in the map
+    ///
+    /// @return The element with the key, and whether it was inserted
+    template <typename Q, typename... Args>
+    std::pair<iterator, bool> emplace(Q&& key, Args&&... args)
+    {
+        size_t hash  = Hash{}(key);
+        size_t index = this->find_index(key, hash);
+        if (index != NOT_FOUND) {
+            return {this->make_iterator(index, false), false};
+        }
+
+        if (_growth_left == 0) {
+            this->grow();
+        }
+        index = this->find_free(hash);
+        std::construct_at(&_slots[index],
+                          std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<Q>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        if (_ctrl[index] == EMPTY) {
+            --_growth_left;
+        }
+        _ctrl[index] = h2(hash);
+        ++_size;
+        return {this->make_iterator(index, false), true};
+    }
+
+    /// @brief Returns the value of a key, inserting a default one if it isn't in the map
+    V& operator[](const K& key) { return this->emplace(key).first->second; }
+
+    /// @brief Erases the element of a key
+    ///
+    /// @return The number of elements erased
+    template <typename Q>
+    size_t erase(const Q& key)
+    {
+        size_t index = this->find_index(key);
+        if (index == NOT_FOUND) {
+            return 0;
+        }
+        this->erase_at(index);
+        return 1;
+    }
+
+    /// @brief Erases an element
+    ///
+    /// @return The element after it
+    iterator erase(const_iterator it)
+    {
+        size_t index = it._slot - _slots;
+        this->erase_at(index);
+        return this->make_iterator(index + 1, true);
+    }
+
+    iterator erase(iterator it) { return this->erase(const_iterator(it)); }
+
+    void clear()
+    {
+        this->destroy();
+        _ctrl        = nullptr;
+        _slots       = nullptr;
+        _capacity    = 0;
+        _size        = 0;
+        _growth_left = 0;
+    }
+
+    /// @brief Makes room for `count` elements without growing
+    void reserve(size_t count)
+    {
+        size_t capacity = std::bit_ceil(std::max(GROUP_SIZE, count + count / 7 + 1));
+        if (capacity > _capacity) {
+            this->rehash(capacity);
+        }
+    }
+
+private:
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr size_t NOT_FOUND  = SIZE_MAX;
+
+    /// Control bytes of the slots without an element, the others hold 7 bits of the hash
+    static constexpr int8_t EMPTY   = -128;
+    static constexpr int8_t DELETED = -2;
+
+    int8_t*     _ctrl        = nullptr;
+    value_type* _slots       = nullptr;
+    size_t      _capacity    = 0;
+    size_t      _size        = 0;
+    size_t      _growth_left = 0;
+
+    static int8_t h2(size_t hash) { return hash & 0x7F; }
+
+    /// The hash picks the first group, the bits left after the control byte
+    size_t first_group(size_t hash) const { return (hash >> 7) & (_capacity / GROUP_SIZE - 1); }
+
+    /// Returns a mask of the bytes of the group at `ctrl` that equal `byte`
+    static uint32_t match(const int8_t* ctrl, int8_t byte)
+    {
+#ifdef __SSE2__
+        __m128i group = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            mask |= uint32_t(ctrl[i] == byte) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Returns a mask of the empty and deleted bytes of the group at `ctrl`, the negative ones
+    static uint32_t match_free(const int8_t* ctrl)
+    {
+#ifdef __SSE2__
+        return _mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            mask |= uint32_t(ctrl[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+
+    template <typename Q>
+    size_t find_index(const Q& key) const
+    {
+        if (_capacity == GROUP_SIZE) {
+            // Comparing the few keys of a single group is cheaper than hashing
+            for (uint32_t mask = ~match_free(_ctrl) & 0xFFFF; mask != 0; mask &= mask - 1) {
+                size_t index = std::countr_zero(mask);
+                if (Equal{}(_slots[index].first, key)) {
+                    return index;
+                }
+            }
+            return NOT_FOUND;
+        }
+        return _size == 0 ? NOT_FOUND : this->find_index(key, Hash{}(key));
+    }
+
+    template <typename Q>
+    size_t find_index(const Q& key, size_t hash) const
+    {
+        if (_size == 0) {
+            return NOT_FOUND;
+        }
+        size_t groups = _capacity / GROUP_SIZE;
+        size_t group  = this->first_group(hash);
+
+        // Triangular probing visits every group once when their number is a power of two
+        for (size_t probe = 1; probe <= groups; ++probe) {
+            const int8_t* ctrl = _ctrl + group * GROUP_SIZE;
+            for (uint32_t mask = match(ctrl, h2(hash)); mask != 0; mask &= mask - 1) {
+                size_t index = group * GROUP_SIZE + std::countr_zero(mask);
+                if (Equal{}(_slots[index].first, key)) {
+                    return index;
+                }
+            }
+            // An empty slot ends the chain the key would have been inserted in
+            if (match(ctrl, EMPTY) != 0) {
+                break;
+            }
+            group = (group + probe) & (groups - 1);
+        }
+        return NOT_FOUND;
+    }
+
+    /// Finds a slot for a new element, there is always one
+    size_t find_free(size_t hash) const
+    {
+        size_t groups = _capacity / GROUP_SIZE;
+        size_t group  = this->first_group(hash);
+
+        for (size_t probe = 1;; ++probe) {
+            const int8_t* ctrl = _ctrl + group * GROUP_SIZE;
+            if (uint32_t mask = match_free(ctrl)) {
+                return group * GROUP_SIZE + std::countr_zero(mask);
+            }
+            group = (group + probe) & (groups - 1);
+        }
+    }
+
+    void erase_at(size_t index)
+    {
+        std::destroy_at(&_slots[index]);
+        _ctrl[index] = DELETED;
+        --_size;
+    }
+
+    /// Makes room for an element, dropping the deleted slots or doubling the capacity
+    void grow()
+    {
+        if (_capacity == 0) {
+            this->rehash(GROUP_SIZE);
+        } else if (_size < (_capacity - _capacity / 8) / 2) {
+            this->rehash(_capacity);
+        } else {
+            this->rehash(_capacity * 2);
+        }
+    }
+
+    void rehash(size_t capacity)
+    {
+        int8_t*     ctrl     = _ctrl;
+        value_type* slots    = _slots;
+        size_t      previous = _capacity;
+
+        _ctrl  = static_cast<int8_t*>(::operator new(capacity, std::align_val_t(GROUP_SIZE)));
+        _slots    = std::allocator<value_type>().allocate(capacity);
+        _capacity = capacity;
+        // At most 7/8 of the slots are used, so probing ends on an empty one
+        _growth_left = capacity - capacity / 8 - _size;
+        std::fill_n(_ctrl, capacity, EMPTY);
+
+        for (size_t i = 0; i < previous; ++i) {
+            if (ctrl[i] >= 0) {
+                size_t hash  = Hash{}(slots[i].first);
+                size_t index = this->find_free(hash);
+                std::construct_at(&_slots[index], std::move(slots[i]));
+                _ctrl[index] = h2(hash);
+                std::destroy_at(&slots[i]);
+            }
+        }
+        if (ctrl != nullptr) {
+            ::operator delete(ctrl, std::align_val_t(GROUP_SIZE));
+            std::allocator<value_type>().deallocate(slots, previous);
+        }
+    }
+
+    void destroy()
+    {
+        if (_ctrl == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < _capacity; ++i) {
+            if (_ctrl[i] >= 0) {
+                std::destroy_at(&_slots[i]);
+            }
+        }
+        ::operator delete(_ctrl, std::align_val_t(GROUP_SIZE));
+        std::allocator<value_type>().deallocate(_slots, _capacity);
+    }
+
+    iterator make_iterator(size_t index, bool skip)
+    {
+        iterator it(_ctrl + index, _slots + index, _ctrl + _capacity);
+        if (skip) {
+            it.skip_free();
+        }
+        return it;
+    }
+
+    const_iterator make_iterator(size_t index, bool skip) const
+    {
+        const_iterator it(_ctrl + index, _slots + index, _ctrl + _capacity);
+        if (skip) {
+            it.skip_free();
+        }
+        return it;
+    }
+};
+}  // namespace webserv::utils
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+
+namespace webserv::utils
+{
+/// @brief Appends a value to a string, used for each `{}` of `format_to`
+///
+/// Overloaded for strings, characters, booleans, numbers and any
+/// type with a `to_string()` member.
+///
+/// @param out The string to append to
+/// @param value The value to append
+inline void format_arg(std::string& out, std::string_view value)
+{
+    out.append(value);
+}
+
+inline void format_arg(std::string& out, const char* value)
+{
+    out.append(value);
+}
+
+inline void format_arg(std::string& out, char value)
+{
+    out.push_back(value);
+}
+
+inline void format_arg(std::string& out, bool value)
+{
+    out.append(value ? "true" : "false");
+}
+
+template <typename T>
+    requires std::integral<T> || std::floating_point<T>
+void format_arg(std::string& out, T value)
+{
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+template <typename T>
+    requires requires(const T& value) {
+        { value.to_string() } -> std::convertible_to<std::string_view>;
+    }
+void format_arg(std::string& out, const T& value)
+{
+    out.append(value.to_string());
+}
+
+namespace detail
+{
+using Appender = void (*)(std::string&, const void*);
+
+template <typename T>
+void append(std::string& out, const void* value)
+{
+    format_arg(out, *static_cast<const T*>(value));
+}
+
+void format_to(std::string&      out,
+               std::string_view  format,
+               const void* const values[],
+               const Appender    appenders[],
+               size_t            count);
+}  // namespace detail
+
+/// @brief Appends a formatted string to `out`
+///
+/// Each `{}` in `format` is replaced by the next argument, `{{` and `}}`
+/// are a literal brace. Missing arguments are left as `{}`, extra ones
+/// are ignored.
+///
+/// @param out The string to append to
+/// @param format The format string
+/// @param args The arguments
+template <typename... Args>
+void format_to(std::string& out, std::string_view format, const Args&... args)
+{
+    if constexpr (sizeof...(Args) == 0) {
+        detail::format_to(out, format, nullptr, nullptr, 0);
+    } else {
+        const void* const      values[]    = {&args...};
+        const detail::Appender appenders[] = {&detail::append<Args>...};
+        detail::format_to(out, format, values, appenders, sizeof...(Args));
+    }
+}
+
+/// @brief Appends a string as the content of a JSON string
+///
+/// Quotes and backslashes are escaped, control characters are written as `\u00XX`.
+///
+/// @param out The string to append to
+/// @param value The string to escape
+void append_json(std::string& out, std::string_view value);
+
+/// @brief Formats a string
+///
+/// @see format_to
+template <typename... Args>
+std::string format(std::string_view format, const Args&... args)
+{
+    std::string out;
+    utils::format_to(out, format, args...);
+    return out;
+}
+}  // namespace webserv::utils
@@ -1,6 +1,29 @@
 #pragma once
 
+#include <ctime>
 #include <string>
+#include <string_view>
+
+#include "utils/Format.hpp"
+
+/// @brief Logs a formatted message if `level` is enabled
+///
+/// The arguments are only evaluated when the message is logged.
+///
+/// @param logger The ErrorLogger
+/// @param level The level of the message, without the `ErrorLogger::` prefix
+#define ELOG(logger, level, ...)                                               \
+    do {                                                                       \
+        if ((logger).enabled(webserv::utils::ErrorLogger::level)) {            \
+            (logger).log(webserv::utils::ErrorLogger::level, __VA_ARGS__);     \
+        }                                                                      \
+    } while (0)
+
+#define ELOG_DEBUG(logger, ...)    ELOG(logger, DEBUG, __VA_ARGS__)
+#define ELOG_INFO(logger, ...)     ELOG(logger, INFO, __VA_ARGS__)
+#define ELOG_WARNING(logger, ...)  ELOG(logger, WARNING, __VA_ARGS__)
+#define ELOG_ERROR(logger, ...)    ELOG(logger, ERROR, __VA_ARGS__)
+#define ELOG_CRITICAL(logger, ...) ELOG(logger, CRITICAL, __VA_ARGS__)
 
 namespace webserv::utils
 {
@@ -9,17 +32,24 @@ class Logger
 public:
     Logger();
 
-    /// @brief Returns the current timestamp as a string
+    /// @brief Returns the current timestamp
+    ///
+    /// format: YYYY-MM-DD HH:MM:SS
     ///
-    /// format: [YYYY-MM-DD HH:MM:SS]
+    /// The string is only formatted again when the second changes.
     ///
-    /// @return The current timestamp
-    static std::string get_timestamp();
+    /// @return The current timestamp, valid until the next call on this thread
+    static std::string_view get_timestamp();
 
 protected:
-    std::ostream& _stream;
+    int _fd;
 };
 
+/// Logs messages of a level greater or equal to its own.
+///
+/// Lines are written to stderr, with colors, or to a file. Writes to a
+/// file are buffered until `flush` is called, the buffer is full or the
+/// message is an error. Only the event loop thread may log.
 class ErrorLogger : public Logger
 {
 public:
@@ -34,20 +64,50 @@ public:
 
     ErrorLogger(Level level);
 
+    /// @brief Flushes and closes the log file
+    ~ErrorLogger();
+
+    ErrorLogger(const ErrorLogger&)            = delete;
+    ErrorLogger& operator=(const ErrorLogger&) = delete;
+
+    /// @brief Returns true if messages of `level` are logged
+    bool enabled(Level level) const { return level >= _level; }
+
     /// @brief Log a message with a specific level
     //
     // format: [TIMESTAMP][LEVEL]: `message`
     //
     // @param level The level of the message
     // @param message The message to log
-    void log(Level level, const std::string& message);
+    void log(Level level, std::string_view message);
+
+    /// @brief Log a formatted message with a specific level
+    ///
+    /// Prefer the ELOG_* macros, which skip formatting the arguments
+    /// when the level is disabled.
+    ///
+    /// @param level The level of the message
+    /// @param format The format string, see `format_to`
+    /// @param args The arguments
+    template <typename... Args>
+        requires(sizeof...(Args) > 0)
+    void log(Level level, std::string_view format, const Args&... args)
+    {
+        if (!enabled(level)) {
+            return;
+        }
+        std::string& message = message_buffer();
+        message.clear();
+        utils::format_to(message, format, args...);
+        log(level, message);
+    }
 
     /// @brief Log a message with a level of DEBUG
     //
     // format: [TIMESTAMP][DEBUG]: `message`
     //
     // @param message The message to log
-    void log(const std::string& message);
+    void log(std::string_view message);
 
     /// @brief Set the level of the logger
     ///
@@ -65,7 +125,23 @@ public:
     /// @param level The level of the logger
     void set_level(const std::string& level);
 
+    /// @brief Writes to a file instead of stderr
+    ///
+    /// @param path Path to the file, opened for appending, or empty for stderr
+    /// @throw std::runtime_error if the file can't be opened
+    void set_file(const std::string& path);
+
+    /// @brief Writes the buffered lines to the file
+    void flush();
+
 private:
-    Level _level;
+    static constexpr size_t BUFFER_SIZE = 8192;
+
+    Level       _level;
+    std::string _path;
+    std::string _buffer;
+
+    /// @brief Returns the buffer the formatted messages are built in
+    static std::string& message_buffer();
 };
 }  // namespace webserv::utils
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace webserv::utils
+{
+/// Counts requests, connections and latencies, exposed in the Prometheus
+/// text format by the `metrics` location handler.
+///
+/// Recording a request is a few relaxed atomic increments on counters that
+/// only the event loop writes to, so they never contend and a scrape can
+/// read them from any thread without a lock.
+class Metrics
+{
+public:
+    /// The number of latency buckets, two per power of two microseconds up to ~33s
+    static constexpr size_t BUCKETS = 50;
+
+    /// A latency histogram with logarithmic buckets, like HdrHistogram with
+    /// one bit of precision.
+    struct Histogram
+    {
+        /// The last bucket counts the values over the largest bound
+        std::array<std::atomic<uint64_t>, BUCKETS + 1> buckets = {};
+        std::atomic<uint64_t>                          sum     = 0;
+
+        /// @brief Records a value
+        ///
+        /// @param us The value in microseconds
+        void record(uint64_t us);
+
+        /// @brief Returns the bucket of a value
+        static size_t bucket(uint64_t us);
+
+        /// @brief Returns the exclusive upper bound of a bucket in microseconds
+        static uint64_t upper_bound(size_t bucket);
+    };
+
+    /// The counters of a location, kept across reloads
+    struct Location
+    {
+        std::string server;
+        std::string path;
+
+        /// Responses by status class, 1xx to 5xx
+        std::array<std::atomic<uint64_t>, 5> responses = {};
+        Histogram                            latency;
+    };
+
+    /// The work of the event loop
+    struct Loop
+    {
+        /// Time spent handling the events of one iteration, in microseconds
+        Histogram iteration;
+        /// Time spent in one callback, in microseconds
+        Histogram callback;
+        /// Events returned by one wait
+        Histogram ready_events;
+
+        std::atomic<uint64_t> blocking_promises = 0;
+        std::atomic<uint64_t> slow_callbacks    = 0;
+        /// `epoll_wait`, `epoll_ctl` and `io_uring_enter` calls
+        std::atomic<uint64_t> syscalls = 0;
+    };
+
+    /// The jobs of the thread pool
+    struct Pool
+    {
+        /// Time a job waited for a worker, in microseconds
+        Histogram wait;
+
+        std::atomic<uint64_t> queued    = 0;
+        std::atomic<uint64_t> overflows = 0;
+    };
+
+    /// The client connections by state
+    struct Connections
+    {
+        size_t reading = 0;
+        size_t writing = 0;
+        size_t idle    = 0;
+    };
+
+    Metrics(const Metrics&)            = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    static Metrics& instance();
+
+    /// @brief Gets the counters of a location, creating them on first use
+    ///
+    /// @param server The name of the server
+    /// @param path The path of the location, empty for the server itself
+    /// @return The counters, valid for the lifetime of the program
+    Location& location(const std::string& server, const std::string& path);
+
+    /// @brief Records a response
+    ///
+    /// @param location The location that served it
+    /// @param status The status code
+    /// @param us The time spent on the request in microseconds
+    void record(Location& location, int status, uint64_t us);
+
+    /// @brief Records an iteration of the event loop
+    ///
+    /// @param us The time spent handling the events in microseconds
+    /// @param ready_events The number of events returned by the wait
+    /// @param blocking_promises The number of promises polled every iteration
+    void record_iteration(uint64_t us, size_t ready_events, size_t blocking_promises);
+
+    /// @brief Records a callback of the event loop
+    ///
+    /// @param us The time spent in the callback in microseconds
+    /// @param slow Whether it exceeded the slow callback threshold
+    void record_callback(uint64_t us, bool slow);
+
+    void add_accepted() { _accepted.fetch_add(1, std::memory_order_relaxed); }
+    void add_received(size_t bytes) { _received.fetch_add(bytes, std::memory_order_relaxed); }
+    void add_sent(size_t bytes) { _sent.fetch_add(bytes, std::memory_order_relaxed); }
+    void add_cgi_spawn() { _cgi_spawns.fetch_add(1, std::memory_order_relaxed); }
+
+    /// @brief Counts a system call of the event loop waiting for or watching fds
+    void add_loop_syscall() { _loop.syscalls.fetch_add(1, std::memory_order_relaxed); }
+
+    /// @brief Records the time a job of the thread pool waited for a worker
+    void record_pool_wait(uint64_t us) { _pool.wait.record(us); }
+
+    /// @brief Sets the number of jobs waiting for a worker
+    void set_pool_queued(size_t queued) { _pool.queued.store(queued, std::memory_order_relaxed); }
+
+    /// @brief Counts a job run without a worker, as the queue was full
+    void add_pool_overflow() { _pool.overflows.fetch_add(1, std::memory_order_relaxed); }
+
+    /// @brief Sets the function counting the current connections
+    ///
+    /// @param connections The function, or `nullptr` to report none
+    void set_connections(std::function<Connections()> connections);
+
+    /// @brief Returns the metrics in the Prometheus text format
+    std::string str() const;
+
+private:
+    Metrics() = default;
+
+    std::array<std::atomic<uint64_t>, 600> _responses  = {};
+    std::atomic<uint64_t>                  _accepted   = 0;
+    std::atomic<uint64_t>                  _received   = 0;
+    std::atomic<uint64_t>                  _sent       = 0;
+    std::atomic<uint64_t>                  _cgi_spawns = 0;
+
+    Loop _loop;
+    Pool _pool;
+
+    std::function<Connections()> _connections;
+
+    /// Guards `_locations`, which the config loader adds to
+    mutable std::mutex _mutex;
+
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<Location>> _locations;
+};
+}  // namespace webserv::utils
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace webserv::utils
+{
+/// Allocates objects in slabs of `SlabSize` slots, reusing freed slots.
+///
+/// Objects never move once created. The live ones are also kept in a dense
+/// list, each slot remembering its position in it, so destroying an object
+/// is O(1) and iterating visits only live objects. Slabs are kept until the
+/// pool is destroyed.
+template <typename T, size_t SlabSize = 64>
+class Pool
+{
+public:
+    using iterator = typename std::vector<T*>::const_iterator;
+
+    Pool() = default;
+
+    /// @brief Destroys the objects left
+    ~Pool()
+    {
+        while (!_live.empty()) {
+            this->destroy(_live.back());
+        }
+    }
+
+    Pool(const Pool&)            = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /// @brief Constructs an object in a free slot, adding a slab if there is none
+    ///
+    /// @return The object, valid until it is destroyed
+    template <typename... Args>
+    T* create(Args&&... args)
+    {
+        if (_free == nullptr) {
+            this->add_slab();
+        }
+        Slot* slot   = _free;
+        T*    object = new (slot->storage) T(std::forward<Args>(args)...);
+
+        _free       = slot->next;
+        slot->index = _live.size();
+        _live.push_back(object);
+        return object;
+    }
+
+    /// @brief Destroys an object created by this pool and frees its slot
+    void destroy(T* object)
+    {
+        Slot* slot = reinterpret_cast<Slot*>(object);
+
+        // Move the last live object into the position of this one
+        T* last                              = _live.back();
+        _live[slot->index]                   = last;
+        reinterpret_cast<Slot*>(last)->index = slot->index;
+        _live.pop_back();
+
+        object->~T();
+        slot->next = _free;
+        _free      = slot;
+    }
+
+    /// @brief Returns the number of live objects
+    size_t size() const { return _live.size(); }
+
+    bool empty() const { return _live.empty(); }
+
+    /// @brief Returns the number of slots, live or free
+    size_t capacity() const { return _slabs.size() * SlabSize; }
+
+    /// Iterates over the live objects, in no particular order
+    iterator begin() const { return _live.begin(); }
+    iterator end() const { return _live.end(); }
+
+private:
+    /// The storage comes first, so an object and its slot share an address
+    struct Slot
+    {
+        alignas(T) std::byte storage[sizeof(T)];
+        union
+        {
+            /// The position in `_live` while the slot is used
+            size_t index;
+            /// The next free slot while it isn't
+            Slot* next;
+        };
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> _slabs;
+    std::vector<T*>                      _live;
+    Slot*                                _free = nullptr;
+
+    void add_slab()
+    {
+        Slot* slab = _slabs.emplace_back(new Slot[SlabSize]).get();
+        for (size_t i = SlabSize; i-- > 0;) {
+            slab[i].next = _free;
+            _free        = &slab[i];
+        }
+    }
+};
+}  // namespace webserv::utils
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace webserv::utils
+{
+/// A set of regular expressions matched together in a single pass.
+///
+/// The patterns are compiled into one NFA, which is turned into a DFA
+/// lazily while matching: each DFA state is built the first time it is
+/// reached and cached for the following matches.
+///
+/// Supported syntax: literals, `.`, `[...]`, `[^...]`, `\d \w \s \D \W \S`,
+/// escapes, groups `(...)` and `(?:...)`, `|`, `*`, `+`, `?`, a leading
+/// `^` and `$`.
+class RegexSet
+{
+public:
+    RegexSet();
+
+    /// @brief Adds a pattern to the set
+    ///
+    /// @param pattern The regular expression
+    /// @param icase Match the pattern case-insensitively
+    /// @return The index of the pattern
+    /// @throw std::runtime_error if the pattern is invalid
+    size_t add(const std::string& pattern, bool icase = false);
+
+    /// @brief Finds the first pattern that matches the input
+    ///
+    /// A pattern matches if it matches any part of the input,
+    /// unless it is anchored with `^` or `$`.
+    ///
+    /// @param input The input to match
+    /// @return The index of the first matching pattern, or -1 if none match
+    int match(std::string_view input) const;
+
+    /// @brief Returns the number of patterns in the set
+    size_t size() const;
+
+private:
+    using CharSet = std::bitset<256>;
+
+    struct State
+    {
+        enum Kind
+        {
+            CHAR,
+            SPLIT,
+            END,
+            MATCH,
+        };
+
+        Kind    kind;
+        CharSet chars   = {};
+        int     out     = -1;
+        int     out1    = -1;
+        int     pattern = -1;
+    };
+
+    /// A partially built NFA: its start state and the outs still to be connected
+    struct Fragment
+    {
+        int                              start;
+        std::vector<std::pair<int, int>> outs;
+    };
+
+    struct DState
+    {
+        std::vector<int>     states;
+        std::array<int, 256> next;
+        int                  accept;
+        int                  accept_end;
+    };
+
+    static constexpr size_t MAX_DSTATES = 4096;
+
+    std::vector<State> _states;
+    std::vector<int>   _starts;
+    size_t             _count;
+
+    mutable std::vector<DState>             _dstates;
+    mutable std::map<std::vector<int>, int> _dindex;
+
+    // Pattern parser
+    Fragment parse_alternation(std::string_view& pattern, bool icase);
+    Fragment parse_concatenation(std::string_view& pattern, bool icase);
+    Fragment parse_repetition(std::string_view& pattern, bool icase);
+    Fragment parse_atom(std::string_view& pattern, bool icase);
+    CharSet  parse_class(std::string_view& pattern);
+    CharSet  parse_escape(std::string_view& pattern);
+
+    int      add_state(State state);
+    Fragment char_fragment(CharSet chars, bool icase);
+    void     patch(const Fragment& fragment, int target);
+
+    // Lazy DFA
+    void add_closure(std::vector<int>& set, int state, bool at_end, std::vector<bool>& seen) const;
+    int  dstate(std::vector<int> states) const;
+    int  step(int dstate, unsigned char c) const;
+};
+}  // namespace webserv::utils
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace webserv::utils
+{
+/// A fixed-size queue for one producer thread and one consumer thread.
+///
+/// The slots are allocated once and reused, so pushing never allocates.
+/// Each side only writes its own index, so no lock is needed.
+///
+/// @tparam T The type of the elements
+/// @tparam N The number of slots, a power of two
+template <typename T, size_t N>
+class RingBuffer
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
+public:
+    RingBuffer() : _slots(std::make_unique<T[]>(N)), _head(0), _tail(0) {}
+
+    RingBuffer(const RingBuffer&)            = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /// @brief Returns the next free slot to fill, producer only
+    ///
+    /// @return The slot or `nullptr` if the buffer is full
+    T* acquire()
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == N) {
+            return nullptr;
+        }
+        return &_slots[tail & (N - 1)];
+    }
+
+    /// @brief Makes the slot returned by `acquire` visible to the consumer
+    void publish()
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// @brief Returns the oldest element, consumer only
+    ///
+    /// @return The element or `nullptr` if the buffer is empty
+    T* front()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &_slots[head & (N - 1)];
+    }
+
+    /// @brief Frees the slot returned by `front` for the producer
+    void pop()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<T[]> _slots;
+
+    // On separate cache lines so the two threads don't contend
+    alignas(64) std::atomic<size_t> _head;
+    alignas(64) std::atomic<size_t> _tail;
+};
+}  // namespace webserv::utils
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace webserv::utils
+{
+/// A read-only map from strings to values, built at compile time.
+///
+/// The keys are placed with a perfect hash: the constructor searches for a
+/// seed under which no two keys share a slot, so a lookup hashes the key
+/// once and compares it to at most one entry. The map lives in read-only
+/// data and needs no initialization at startup.
+template <typename V, size_t N>
+class StaticMap
+{
+public:
+    using Entry = std::pair<std::string_view, V>;
+
+    /// Four slots per key, so a collision-free seed is found in a few tries
+    static constexpr size_t SLOTS = std::bit_ceil(N * 4);
+
+    /// @brief Builds the map, failing to compile if no seed places every key
+    ///        in its own slot, which happens when keys are duplicated
+    consteval explicit StaticMap(const Entry (&entries)[N])
+    {
+        for (size_t i = 0; i < N; ++i) {
+            _entries[i] = entries[i];
+        }
+        for (_seed = 0; !this->place(); ++_seed) {
+            if (_seed == MAX_SEED) {
+                throw "StaticMap: no perfect hash found, are the keys unique?";
+            }
+        }
+    }
+
+    /// @brief Returns the value of a key, or nullptr if it isn't in the map
+    constexpr const V* find(std::string_view key) const
+    {
+        uint8_t index = _slots[hash(_seed, key) & (SLOTS - 1)];
+        if (index == EMPTY || _entries[index].first != key) {
+            return nullptr;
+        }
+        return &_entries[index].second;
+    }
+
+    constexpr bool contains(std::string_view key) const { return this->find(key) != nullptr; }
+
+    static constexpr size_t size() { return N; }
+
+    /// Iterates over the entries in the order they were given
+    constexpr auto begin() const { return _entries.begin(); }
+    constexpr auto end() const { return _entries.end(); }
+
+private:
+    static_assert(N > 0 && N < 255, "StaticMap holds 1 to 254 keys");
+
+    static constexpr uint8_t  EMPTY    = 0xFF;
+    static constexpr uint32_t MAX_SEED = 1 << 16;
+
+    std::array<Entry, N>       _entries{};
+    std::array<uint8_t, SLOTS> _slots{};
+    uint32_t                   _seed = 0;
+
+    /// FNV-1a, starting from the seed
+    static constexpr uint32_t hash(uint32_t seed, std::string_view key)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash ^ (hash >> 15);
+    }
+
+    /// @brief Places the keys under the current seed
+    ///
+    /// @return false if two keys land in the same slot
+    consteval bool place()
+    {
+        _slots.fill(EMPTY);
+        for (size_t i = 0; i < N; ++i) {
+            uint8_t& slot = _slots[hash(_seed, _entries[i].first) & (SLOTS - 1)];
+            if (slot != EMPTY) {
+                return false;
+            }
+            slot = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+};
+
+/// @brief Builds a `StaticMap`, deducing the number of entries
+///
+/// @tparam V The type of the values
+template <typename V, size_t N>
+consteval StaticMap<V, N> make_static_map(const std::pair<std::string_view, V> (&entries)[N])
+{
+    return StaticMap<V, N>(entries);
+}
+}  // namespace webserv::utils
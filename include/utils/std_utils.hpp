@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
 namespace webserv::utils
 {
@@ -17,5 +19,10 @@ bool contains(const Container& container, const T& value)
     return std::find(container.begin(), container.end(), value) != container.end();
 }
 
-void free_string_array(char** array);
+/// @brief Returns the null-terminated array of pointers `execve` takes
+///
+/// Building it before `fork` keeps allocations out of the child.
+///
+/// @param strings The strings, which must outlive the array
+std::vector<char*> c_str_array(std::vector<std::string>& strings);
 }  // namespace webserv::utils
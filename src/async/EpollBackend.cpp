@@ -0,0 +1,85 @@
+#include "async/EpollBackend.hpp"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+
+#include "async/Event.hpp"
+#include "utils/Metrics.hpp"
+
+namespace webserv::async
+{
+EpollBackend::EpollBackend()
+{
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+}
+
+EpollBackend::~EpollBackend()
+{
+    close(_epoll_fd);
+}
+
+void EpollBackend::watch(int fd, uint32_t type)
+{
+    epoll_event ev;
+    ev.events  = EPOLLET;
+    ev.data.fd = fd;
+    if (type & Event::READABLE) {
+        ev.events |= EPOLLIN;
+    }
+    if (type & Event::WRITABLE) {
+        ev.events |= EPOLLOUT;
+    }
+
+    if (size_t(fd) >= _added.size()) {
+        _added.resize(fd + 1);
+    }
+    utils::Metrics::instance().add_loop_syscall();
+    if (!_added[fd]) {
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            throw std::runtime_error("Failed to add event to epoll instance");
+        }
+        _added[fd] = true;
+        return;
+    }
+
+    // A closed fd is dropped by epoll, so a reused fd number has to be added again
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &ev) == -1 &&
+        (errno != ENOENT || epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)) {
+        throw std::runtime_error("Failed to modify event in epoll instance");
+    }
+}
+
+void EpollBackend::remove(int fd)
+{
+    if (size_t(fd) >= _added.size() || !_added[fd]) {
+        return;
+    }
+    utils::Metrics::instance().add_loop_syscall();
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    _added[fd] = false;
+}
+
+int EpollBackend::wait(int* fds, int max, int timeout_ms)
+{
+    _ready.resize(max);
+    utils::Metrics::instance().add_loop_syscall();
+    int num_events = epoll_wait(_epoll_fd, _ready.data(), max, timeout_ms);
+    if (num_events == -1) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error("Failed to wait for epoll events");
+    }
+
+    for (int i = 0; i < num_events; ++i) {
+        fds[i] = _ready[i].data.fd;
+    }
+    return num_events;
+}
+}  // namespace webserv::async
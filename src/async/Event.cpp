@@ -1,7 +1,5 @@
 #include "async/Event.hpp"
 
-#include <sys/epoll.h>
-
 #include <functional>
 
 #include "async/Promise.hpp"
@@ -14,16 +12,9 @@ Event::Event(int fd, uint32_t type, std::unique_ptr<IPromise> promise)
     _poll = std::bind(&IPromise::poll, _promise.get());
 }
 
-uint32_t Event::to_epoll() const
+uint32_t Event::get_type() const
 {
-    uint32_t type = EPOLLET;
-
-    if (_type & READABLE)
-        type |= EPOLLIN;
-    if (_type & WRITABLE)
-        type |= EPOLLOUT;
-
-    return type;
+    return _type;
 }
 
 int Event::get_fd() const
@@ -1,83 +1,202 @@
 #include "async/Poller.hpp"
 
-#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <stdexcept>
 
+#include "async/EpollBackend.hpp"
 #include "async/Promise.hpp"
+#include "async/UringBackend.hpp"
+#include "utils/Metrics.hpp"
 
 #ifndef MAX_EVENTS
-#define MAX_EVENTS 10
+#define MAX_EVENTS 256
 #endif
 
 namespace webserv::async
 {
 Poller::Poller()
+    : _backend(std::make_unique<EpollBackend>()),
+      _engine(Engine::EPOLL),
+      _slow_threshold(0),
+      _peer()
 {
-    _epoll_fd = epoll_create(1);
-    if (_epoll_fd == -1) {
-        throw std::runtime_error("Failed to create epoll instance");
-    }
-    if (fcntl(_epoll_fd, F_SETFD, FD_CLOEXEC) == -1) {
-        throw std::runtime_error("Failed to set FD_CLOEXEC on epoll instance");
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wake_fd == -1) {
+        throw std::runtime_error("Failed to create eventfd");
     }
+    // Stays readable until the posted callbacks ran
+    _backend->watch(_wake_fd, Event::READABLE);
 
     _blocking_promises.reserve(MAX_EVENTS);
 }
 
 Poller::~Poller()
 {
-    close(_epoll_fd);
+    // The backend may still hold the eventfd
+    _backend.reset();
+    close(_wake_fd);
 }
 
 void Poller::poll()
 {
-    epoll_event events[MAX_EVENTS];
-    int         num_events = epoll_wait(_epoll_fd, events, 10, 10);
-    if (num_events == -1) {
-        throw std::runtime_error("Failed to wait for epoll events");
+    int fds[MAX_EVENTS];
+    int num_events = _backend->wait(fds, MAX_EVENTS, _carried_ready.empty() ? 10 : 0);
+
+    // The leftovers of the previous engine are taken without waiting for the new one
+    for (; !_carried_ready.empty() && num_events < MAX_EVENTS; _carried_ready.pop_back()) {
+        fds[num_events++] = _carried_ready.back();
     }
 
+    Clock::time_point start    = Clock::now();
+    Clock::time_point callback = start;
+
     for (int i = 0; i < num_events; i++) {
-        Event* event = _events[events[i].data.fd].get();
-        Poll   poll  = event->poll();
-        if (poll == Poll::READY) {
-            epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, event->get_fd(), nullptr);
-            _events.erase(event->get_fd());
+        int fd = fds[i];
+        if (fd == _wake_fd) {
+            callback = this->run_posted(callback);
+            _backend->rearm(_wake_fd);
+            continue;
+        }
+        if (size_t(fd) >= _events.size() || _events[fd] == nullptr) {
+            continue;
+        }
+
+        Event*             event = _events[fd].get();
+        const sockaddr_in* peer  = _slow_threshold.count() > 0 ? this->peer_of(fd) : nullptr;
+        Poll               poll  = event->poll();
+        callback                 = this->record_callback(fd, callback, peer);
+        // The callback may have registered a new promise for the same fd
+        if (poll == Poll::READY && _events[fd].get() == event) {
+            _backend->suspend(fd);
+            _events[fd].reset();
+        } else if (_events[fd] != nullptr) {
+            _backend->rearm(fd);
         }
     }
 
-    for (auto it = _blocking_promises.begin(); it != _blocking_promises.end();) {
+    // By index, a callback may add a promise and reallocate the vector
+    for (size_t i = 0; i < _blocking_promises.size();) {
         try {
-            Poll poll = (*it)->poll();
+            Poll poll = _blocking_promises[i]->poll();
+            callback  = this->record_callback(-1, callback);
             if (poll == Poll::READY) {
-                it = _blocking_promises.erase(it);
+                _blocking_promises.erase(_blocking_promises.begin() + i);
                 continue;
             }
         } catch (const std::exception& e) {
-            it = _blocking_promises.erase(it);
+            callback = this->record_callback(-1, callback);
+            _blocking_promises.erase(_blocking_promises.begin() + i);
             continue;
         }
-        ++it;
+        ++i;
     }
+
+    _retired.clear();
+
+    auto iteration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    utils::Metrics::instance().record_iteration(
+        iteration.count(), num_events, _blocking_promises.size());
 }
 
 void Poller::add_promise(std::unique_ptr<IPromise> promise, int fd, Event::Type type)
 {
     auto event_ptr = std::make_unique<Event>(Event(fd, type, std::move(promise)));
 
-    if (_events.find(fd) == _events.end()) {
-        epoll_event ev;
-        ev.events  = event_ptr->to_epoll();
-        ev.data.fd = fd;
+    if (size_t(fd) >= _events.size()) {
+        _events.resize(fd + 1);
+    }
+    _backend->watch(fd, type);
+
+    // The old event may be the one currently running
+    std::unique_ptr<Event>& slot = _events[fd];
+    if (slot != nullptr) {
+        _retired.push_back(std::move(slot));
+    }
+    slot = std::move(event_ptr);
+}
+
+void Poller::remove(int fd)
+{
+    if (fd < 0) {
+        return;
+    }
+
+    // The engine may still accept or receive on it between promises
+    _backend->remove(fd);
+    if (!_carried.empty()) {
+        if (auto it = _carried.find(fd); it != _carried.end()) {
+            for (int accepted : it->second.accepted) {
+                close(accepted);
+            }
+            _carried.erase(it);
+        }
+    }
+    if (size_t(fd) < _events.size() && _events[fd] != nullptr) {
+        _retired.push_back(std::move(_events[fd]));
+    }
+}
+
+int Poller::accept(int fd, sockaddr_in& address)
+{
+    std::optional<int> accepted;
+    if (auto it = _carried.find(fd); it != _carried.end() && !it->second.accepted.empty()) {
+        accepted = it->second.accepted.back();
+        it->second.accepted.pop_back();
+        if (it->second.accepted.empty()) {
+            _carried.erase(it);
+        }
+    } else {
+        accepted = _backend->accept(fd);
+    }
+
+    socklen_t length = sizeof(address);
+    if (!accepted) {
+        return ::accept4(fd,
+                         reinterpret_cast<sockaddr*>(&address),
+                         &length,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+    }
+    // Multishot accepts don't have an address of their own for each connection
+    if (*accepted != -1 &&
+        getpeername(*accepted, reinterpret_cast<sockaddr*>(&address), &length) == -1) {
+        address = {};
+    }
+    return *accepted;
+}
 
-        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, event_ptr->get_fd(), &ev) == -1) {
-            throw std::runtime_error("Failed to add event to epoll instance");
+ssize_t Poller::receive(int fd, char* buffer, size_t size)
+{
+    if (!_carried.empty()) {
+        if (auto it = _carried.find(fd); it != _carried.end()) {
+            Carried& carried = it->second;
+            if (!carried.received.empty()) {
+                size_t bytes = carried.received.copy(buffer, size);
+                carried.received.erase(0, bytes);
+                if (carried.received.empty() && !carried.end) {
+                    _carried.erase(it);
+                }
+                return bytes;
+            }
+            if (carried.end) {
+                int end = *carried.end;
+                _carried.erase(it);
+                if (end < 0) {
+                    errno = -end;
+                    return -1;
+                }
+                return end;
+            }
         }
     }
 
-    _events[fd] = std::move(event_ptr);
+    if (std::optional<ssize_t> bytes = _backend->receive(fd, buffer, size)) {
+        return *bytes;
+    }
+    return ::read(fd, buffer, size);
 }
 
 void Poller::add_promise(std::unique_ptr<IPromise> promise)
@@ -85,6 +204,146 @@ void Poller::add_promise(std::unique_ptr<IPromise> promise)
     _blocking_promises.push_back(std::move(promise));
 }
 
+void Poller::post(std::function<void()> callback)
+{
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(_posted_mutex);
+        wake = _posted.empty();
+        _posted.push_back(std::move(callback));
+    }
+    // The callbacks already posted have woken the loop
+    if (wake) {
+        uint64_t one = 1;
+        while (write(_wake_fd, &one, sizeof(one)) == -1 && errno == EINTR) {
+        }
+    }
+}
+
+void Poller::set_slow_callback(std::chrono::microseconds threshold, SlowCallback callback)
+{
+    _slow_threshold = threshold;
+    _slow_callback  = std::move(callback);
+}
+
+Poller::Clock::time_point Poller::record_callback(int                fd,
+                                                  Clock::time_point  start,
+                                                  const sockaddr_in* peer)
+{
+    Clock::time_point end      = Clock::now();
+    auto              duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    bool              slow     = _slow_threshold.count() > 0 && duration >= _slow_threshold;
+
+    utils::Metrics::instance().record_callback(duration.count(), slow);
+    if (slow && _slow_callback) {
+        _slow_callback(fd, peer, duration);
+        // Reporting isn't part of the next callback
+        return Clock::now();
+    }
+    return end;
+}
+
+const sockaddr_in* Poller::peer_of(int fd)
+{
+    // Clients and upstreams are sockets, CGI pipes have no peer
+    socklen_t length = sizeof(_peer);
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&_peer), &length) == -1 ||
+        _peer.sin_family != AF_INET) {
+        return nullptr;
+    }
+    return &_peer;
+}
+
+Poller::Clock::time_point Poller::run_posted(Clock::time_point start)
+{
+    // Cleared first, a callback posted after the swap wakes the loop again
+    uint64_t count;
+    while (read(_wake_fd, &count, sizeof(count)) == -1 && errno == EINTR) {
+    }
+
+    std::vector<std::function<void()>> posted;
+    {
+        std::lock_guard<std::mutex> lock(_posted_mutex);
+        posted.swap(_posted);
+    }
+    for (std::function<void()>& callback : posted) {
+        try {
+            callback();
+        } catch (const std::exception& e) {
+        }
+        start = this->record_callback(_wake_fd, start);
+    }
+    return start;
+}
+
+Poller::Engine Poller::set_engine(Engine engine)
+{
+    if (engine == _engine) {
+        return _engine;
+    }
+
+    std::unique_ptr<Backend> backend;
+    if (engine == Engine::IO_URING) {
+        try {
+            backend = std::make_unique<UringBackend>();
+        } catch (const std::runtime_error&) {
+            return _engine;
+        }
+    } else {
+        backend = std::make_unique<EpollBackend>();
+    }
+
+    _backend->stop([this](const Backend::Completion& completion) { this->carry(completion); });
+    backend->watch(_wake_fd, Event::READABLE);
+    for (const std::unique_ptr<Event>& event : _events) {
+        if (event != nullptr) {
+            backend->watch(event->get_fd(), event->get_type());
+        }
+    }
+    _backend = std::move(backend);
+    _engine  = engine;
+    return _engine;
+}
+
+void Poller::carry(const Backend::Completion& completion)
+{
+    auto [it, inserted] = _carried.try_emplace(completion.fd);
+    if (inserted) {
+        _carried_ready.push_back(completion.fd);
+    }
+
+    Carried& carried = it->second;
+    if (completion.type == Event::ACCEPT) {
+        // Taken from the back
+        carried.accepted.insert(carried.accepted.begin(), completion.result);
+    } else if (completion.result > 0) {
+        carried.received.append(completion.data);
+    } else {
+        carried.end = completion.result;
+    }
+}
+
+Poller::Engine Poller::get_engine() const
+{
+    return _engine;
+}
+
+Poller::Engine Poller::engine_of(const std::string& name)
+{
+    if (name == "epoll") {
+        return Engine::EPOLL;
+    }
+    if (name == "io_uring") {
+        return Engine::IO_URING;
+    }
+    throw std::runtime_error("Unknown event engine: " + name);
+}
+
+std::string_view Poller::name(Engine engine)
+{
+    return engine == Engine::IO_URING ? "io_uring" : "epoll";
+}
+
 Poller& Poller::instance()
 {
     static Poller instance;
@@ -0,0 +1,66 @@
+#include "async/Signal.hpp"
+
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+namespace webserv::async
+{
+namespace
+{
+/// The signals blocked by `Signal`
+sigset_t& blocked()
+{
+    static sigset_t signals = [] {
+        sigset_t signals;
+        sigemptyset(&signals);
+        return signals;
+    }();
+    return signals;
+}
+}  // namespace
+
+Signal::Signal(int signal)
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, signal);
+
+    if (sigprocmask(SIG_BLOCK, &mask, nullptr) == -1) {
+        throw std::runtime_error("Failed to block signal");
+    }
+    sigaddset(&blocked(), signal);
+
+    _fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to create signalfd");
+    }
+}
+
+Signal::~Signal()
+{
+    Poller::instance().remove(_fd);
+    close(_fd);
+}
+
+Promise<int> Signal::wait()
+{
+    return Promise<int>(
+        [this]() -> std::optional<int> {
+            signalfd_siginfo info;
+            if (read(_fd, &info, sizeof(info)) != sizeof(info)) {
+                return std::nullopt;
+            }
+            return static_cast<int>(info.ssi_signo);
+        },
+        _fd,
+        Event::READABLE);
+}
+
+void Signal::unblock_all()
+{
+    sigprocmask(SIG_UNBLOCK, &blocked(), nullptr);
+}
+}  // namespace webserv::async
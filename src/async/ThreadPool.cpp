@@ -0,0 +1,104 @@
+#include "async/ThreadPool.hpp"
+
+#include <system_error>
+
+#include "async/Poller.hpp"
+#include "utils/Metrics.hpp"
+
+namespace webserv::async
+{
+ThreadPool::ThreadPool()
+{
+    // Created first, the poller outlives the workers posting to it
+    Poller::instance();
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _available.notify_all();
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Job work, Job done)
+{
+    utils::Metrics& metrics = utils::Metrics::instance();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_threads.empty()) {
+            this->start();
+        }
+        if (!_threads.empty() && _queue.size() < MAX_QUEUED) {
+            _queue.push_back({std::move(work), std::move(done), Clock::now()});
+            metrics.set_pool_queued(_queue.size());
+            _available.notify_one();
+            return;
+        }
+    }
+
+    metrics.add_pool_overflow();
+    try {
+        work();
+    } catch (...) {
+    }
+    Poller::instance().post(std::move(done));
+}
+
+size_t ThreadPool::queued() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool instance;
+    return instance;
+}
+
+void ThreadPool::start()
+{
+    _threads.reserve(THREADS);
+    for (size_t i = 0; i < THREADS; ++i) {
+        try {
+            _threads.emplace_back(&ThreadPool::work, this);
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+}
+
+void ThreadPool::work()
+{
+    utils::Metrics& metrics = utils::Metrics::instance();
+
+    for (;;) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _available.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_stopping) {
+                return;
+            }
+            entry = std::move(_queue.front());
+            _queue.pop_front();
+            metrics.set_pool_queued(_queue.size());
+        }
+
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                                          entry.submitted);
+        metrics.record_pool_wait(wait.count());
+
+        try {
+            entry.work();
+        } catch (...) {
+        }
+        Poller::instance().post(std::move(entry.done));
+    }
+}
+}  // namespace webserv::async
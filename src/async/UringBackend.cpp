@@ -0,0 +1,617 @@
+#include "async/UringBackend.hpp"
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "async/Event.hpp"
+#include "utils/Metrics.hpp"
+
+namespace webserv::async
+{
+namespace
+{
+/// The user data of cancellations, whose completions are ignored
+constexpr uint64_t CANCEL = UINT64_MAX;
+
+/// The bits of the user data of multishot operations
+constexpr uint64_t MULTISHOT = uint64_t(1) << 32;
+constexpr uint64_t ACCEPT    = uint64_t(1) << 33;
+
+/// The group of the provided buffers
+constexpr uint16_t BUFFER_GROUP = 0;
+
+/// The user data of an operation: its generation, kind and file descriptor
+uint64_t user_data(int fd, uint32_t generation, uint64_t kind = 0)
+{
+    return (uint64_t(generation) << 34) | kind | uint32_t(fd);
+}
+
+/// The user data of the multishot operation of a kind, `Event::ACCEPT` or `Event::RECEIVE`
+uint64_t multishot_data(int fd, uint32_t generation, uint32_t kind)
+{
+    return user_data(fd, generation, MULTISHOT | (kind == Event::ACCEPT ? ACCEPT : 0));
+}
+
+/// Loads an index of a ring written by the kernel
+unsigned load(unsigned* index)
+{
+    return std::atomic_ref<unsigned>(*index).load(std::memory_order_acquire);
+}
+
+/// Stores an index of a ring read by the kernel
+void store(unsigned* index, unsigned value)
+{
+    std::atomic_ref<unsigned>(*index).store(value, std::memory_order_release);
+}
+
+std::runtime_error error(const std::string& what)
+{
+    return std::runtime_error(what + ": " + strerror(errno));
+}
+}  // namespace
+
+UringBackend::UringBackend()
+{
+    io_uring_params params = {};
+    // Completions are only processed when waiting for them, on the loop
+    params.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER |
+                        IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = ENTRIES * 4;
+    _ring_fd          = syscall(__NR_io_uring_setup, ENTRIES, &params);
+    if (_ring_fd == -1 && errno == EINVAL) {
+        // Before Linux 6.1
+        params            = {};
+        params.flags      = IORING_SETUP_CQSIZE;
+        params.cq_entries = ENTRIES * 4;
+        _ring_fd          = syscall(__NR_io_uring_setup, ENTRIES, &params);
+    }
+    if (_ring_fd == -1) {
+        throw error("Failed to set up io_uring");
+    }
+
+    // Before Linux 5.11
+    uint32_t required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required) {
+        this->release();
+        throw std::runtime_error("io_uring lacks the features used");
+    }
+
+    _rings_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                           params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    _rings      = mmap(nullptr,
+                  _rings_size,
+                  PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE,
+                  _ring_fd,
+                  IORING_OFF_SQ_RING);
+    _sqes_size  = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes_map   = mmap(nullptr,
+                     _sqes_size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE,
+                     _ring_fd,
+                     IORING_OFF_SQES);
+    if (_rings == MAP_FAILED || _sqes_map == MAP_FAILED) {
+        std::runtime_error e = error("Failed to map the io_uring rings");
+        this->release();
+        throw e;
+    }
+
+    char* rings = static_cast<char*>(_rings);
+    _sq_head    = reinterpret_cast<unsigned*>(rings + params.sq_off.head);
+    _sq_tail    = reinterpret_cast<unsigned*>(rings + params.sq_off.tail);
+    _sq_mask    = *reinterpret_cast<unsigned*>(rings + params.sq_off.ring_mask);
+    _sq_entries = *reinterpret_cast<unsigned*>(rings + params.sq_off.ring_entries);
+    _sqes       = static_cast<io_uring_sqe*>(_sqes_map);
+    _tail       = *_sq_tail;
+    _cq_head    = reinterpret_cast<unsigned*>(rings + params.cq_off.head);
+    _cq_tail    = reinterpret_cast<unsigned*>(rings + params.cq_off.tail);
+    _cq_mask    = *reinterpret_cast<unsigned*>(rings + params.cq_off.ring_mask);
+    _cqes       = reinterpret_cast<io_uring_cqe*>(rings + params.cq_off.cqes);
+
+    // Since Linux 5.17, cancellations that succeed don't wake the wait
+    _skip_success = params.features & IORING_FEAT_CQE_SKIP;
+
+    // Each slot of the ring points to the entry of the same index
+    unsigned* array = reinterpret_cast<unsigned*>(rings + params.sq_off.array);
+    for (unsigned i = 0; i < _sq_entries; ++i) {
+        array[i] = i;
+    }
+
+    // Since Linux 5.19, multishot operations fill the buffers of a ring they share.
+    // Without it, sockets are polled like the other file descriptors
+    void* buf_ring = mmap(nullptr,
+                          BUFFERS * sizeof(io_uring_buf),
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1,
+                          0);
+    if (buf_ring == MAP_FAILED) {
+        return;
+    }
+    io_uring_buf_reg reg = {};
+    reg.ring_addr        = reinterpret_cast<uint64_t>(buf_ring);
+    reg.ring_entries     = BUFFERS;
+    reg.bgid             = BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+        munmap(buf_ring, BUFFERS * sizeof(io_uring_buf));
+        return;
+    }
+    _buf_ring  = static_cast<io_uring_buf_ring*>(buf_ring);
+    _buffers   = std::make_unique<char[]>(BUFFERS * BUFFER_SIZE);
+    _multishot = true;
+    for (unsigned i = 0; i < BUFFERS; ++i) {
+        this->recycle(i);
+    }
+}
+
+UringBackend::~UringBackend()
+{
+    for (size_t fd = 0; fd < _watches.size(); ++fd) {
+        this->drop(fd, _watches[fd]);
+    }
+    this->release();
+    if (_buf_ring != nullptr) {
+        munmap(_buf_ring, BUFFERS * sizeof(io_uring_buf));
+    }
+}
+
+void UringBackend::watch(int fd, uint32_t type)
+{
+    if (size_t(fd) >= _watches.size()) {
+        _watches.resize(fd + 1);
+    }
+    Watch& watch = _watches[fd];
+    // What is in flight already waits for it, like the accept promises every iteration
+    if (watch.watched && watch.type == type) {
+        this->rearm(fd);
+        return;
+    }
+    if (watch.armed) {
+        this->cancel(fd, watch);
+    }
+    ++watch.generation;
+    watch.type    = type;
+    watch.watched = true;
+    this->rearm(fd);
+}
+
+void UringBackend::rearm(int fd)
+{
+    Watch& watch = _watches[fd];
+    if (!watch.watched) {
+        return;
+    }
+
+    uint32_t multishot = this->multishot_type(watch);
+    if (multishot != 0) {
+        // What was completed while no promise wanted it is reported without waiting
+        if (watch.pending()) {
+            this->report(fd, watch);
+        } else if (!watch.multishot) {
+            this->arm_multishot(fd, watch, multishot);
+        }
+    }
+    if (!watch.armed && this->polled(watch) != 0) {
+        this->arm(fd, watch);
+    }
+}
+
+void UringBackend::remove(int fd)
+{
+    if (size_t(fd) >= _watches.size()) {
+        return;
+    }
+    Watch& watch = _watches[fd];
+    this->suspend(fd);
+    if (watch.multishot) {
+        this->cancel_multishot(fd, watch);
+    }
+    this->drop(fd, watch);
+}
+
+void UringBackend::suspend(int fd)
+{
+    if (size_t(fd) >= _watches.size() || !_watches[fd].watched) {
+        return;
+    }
+    Watch& watch = _watches[fd];
+    if (watch.armed) {
+        this->cancel(fd, watch);
+    }
+    ++watch.generation;
+    watch.watched = false;
+}
+
+int UringBackend::wait(int* fds, int max, int timeout_ms)
+{
+    ++_waits;
+    int count = 0;
+    for (; !_ready.empty() && count < max; _ready.pop_back()) {
+        int    fd    = _ready.back();
+        Watch& watch = _watches[fd];
+        watch.ready  = false;
+        if (watch.watched && watch.reported != _waits) {
+            watch.reported = _waits;
+            fds[count++]   = fd;
+        }
+    }
+
+    // Completions left by the last wait are taken without a system call
+    count += this->reap(fds + count, max - count);
+    if (count > 0 && this->queued() == 0) {
+        return count;
+    }
+    this->enter(count > 0 ? 0 : 1, timeout_ms);
+    return count + this->reap(fds + count, max - count);
+}
+
+std::optional<int> UringBackend::accept(int fd)
+{
+    if (size_t(fd) >= _watches.size()) {
+        return std::nullopt;
+    }
+    Watch& watch = _watches[fd];
+    if (watch.pending() && watch.kind == Event::ACCEPT) {
+        int connection = watch.completed[watch.taken++].result;
+        if (!watch.pending()) {
+            watch.completed.clear();
+            watch.taken = 0;
+        }
+        return connection;
+    }
+    if (!watch.multishot || watch.kind != Event::ACCEPT) {
+        return std::nullopt;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+std::optional<ssize_t> UringBackend::receive(int fd, char* buffer, size_t size)
+{
+    if (size_t(fd) >= _watches.size()) {
+        return std::nullopt;
+    }
+    Watch& watch = _watches[fd];
+    if (!watch.pending() || watch.kind != Event::RECEIVE) {
+        if (!watch.multishot || watch.kind != Event::RECEIVE) {
+            return std::nullopt;
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+
+    Completed& completed = watch.completed[watch.taken];
+    ssize_t    result    = completed.result;
+    if (result > 0) {
+        result = std::min<size_t>(size, completed.result - completed.offset);
+        std::memcpy(buffer, &_buffers[completed.buffer * BUFFER_SIZE + completed.offset], result);
+        completed.offset += result;
+        if (completed.offset < uint32_t(completed.result)) {
+            return result;
+        }
+        this->recycle(completed.buffer);
+    }
+    if (++watch.taken == watch.completed.size()) {
+        watch.completed.clear();
+        watch.taken = 0;
+    }
+    if (result < 0) {
+        errno  = -result;
+        result = -1;
+    }
+    return result;
+}
+
+void UringBackend::stop(const Leftover& leftover)
+{
+    for (size_t fd = 0; fd < _watches.size(); ++fd) {
+        Watch& watch = _watches[fd];
+        if (watch.armed) {
+            this->cancel(fd, watch);
+        }
+        watch.watched = false;
+        if (watch.multishot && !watch.stopping) {
+            this->stop_multishot(fd, watch);
+        }
+    }
+
+    // Each multishot operation ends with a completion of its own
+    int fds[64];
+    for (int i = 0; i < 10 && (_in_flight > 0 || this->queued() > 0); ++i) {
+        this->enter(_in_flight > 0 ? 1 : 0, 100);
+        while (this->reap(fds, 64) > 0) {
+        }
+    }
+
+    for (size_t fd = 0; fd < _watches.size(); ++fd) {
+        this->drop(fd, _watches[fd], &leftover);
+    }
+}
+
+void UringBackend::release()
+{
+    if (_sqes_map != nullptr && _sqes_map != MAP_FAILED) {
+        munmap(_sqes_map, _sqes_size);
+    }
+    if (_rings != nullptr && _rings != MAP_FAILED) {
+        munmap(_rings, _rings_size);
+    }
+    close(_ring_fd);
+}
+
+io_uring_sqe* UringBackend::next()
+{
+    if (_tail - load(_sq_head) == _sq_entries) {
+        this->enter(0, 0);
+        if (_tail - load(_sq_head) == _sq_entries) {
+            throw std::runtime_error("The io_uring submission ring is full");
+        }
+    }
+
+    io_uring_sqe* sqe = &_sqes[_tail & _sq_mask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+unsigned UringBackend::queued() const
+{
+    return _tail - load(_sq_head);
+}
+
+void UringBackend::arm(int fd, Watch& watch)
+{
+    io_uring_sqe* sqe  = this->next();
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd;
+    sqe->user_data     = user_data(fd, watch.generation);
+    sqe->poll32_events = this->polled(watch);
+    store(_sq_tail, ++_tail);
+    watch.armed = true;
+}
+
+void UringBackend::cancel(int fd, Watch& watch)
+{
+    io_uring_sqe* sqe = this->next();
+    sqe->opcode       = IORING_OP_POLL_REMOVE;
+    sqe->fd           = -1;
+    sqe->addr         = user_data(fd, watch.generation);
+    sqe->user_data    = CANCEL;
+    if (_skip_success) {
+        sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+    }
+    store(_sq_tail, ++_tail);
+    watch.armed = false;
+}
+
+uint32_t UringBackend::multishot_type(const Watch& watch) const
+{
+    if (!_multishot) {
+        return 0;
+    }
+    if ((watch.type & Event::ACCEPT) == Event::ACCEPT) {
+        return Event::ACCEPT;
+    }
+    if ((watch.type & Event::RECEIVE) == Event::RECEIVE) {
+        return Event::RECEIVE;
+    }
+    return 0;
+}
+
+uint32_t UringBackend::polled(const Watch& watch) const
+{
+    uint32_t events = 0;
+    if ((watch.type & Event::READABLE) && this->multishot_type(watch) == 0) {
+        events |= POLLIN;
+    }
+    if (watch.type & Event::WRITABLE) {
+        events |= POLLOUT;
+    }
+    return events;
+}
+
+void UringBackend::arm_multishot(int fd, Watch& watch, uint32_t type)
+{
+    io_uring_sqe* sqe = this->next();
+    sqe->fd           = fd;
+    sqe->user_data    = multishot_data(fd, watch.multishot_generation, type);
+    if (type == Event::ACCEPT) {
+        // Connections must not leak into CGI scripts or an upgraded binary
+        sqe->opcode       = IORING_OP_ACCEPT;
+        sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    } else {
+        sqe->opcode    = IORING_OP_RECV;
+        sqe->ioprio    = IORING_RECV_MULTISHOT;
+        sqe->flags     = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+    }
+    store(_sq_tail, ++_tail);
+    watch.multishot = true;
+    watch.stopping  = false;
+    watch.kind      = type;
+    ++_in_flight;
+}
+
+void UringBackend::cancel_multishot(int fd, Watch& watch)
+{
+    io_uring_sqe* sqe = this->next();
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->fd           = -1;
+    sqe->addr         = multishot_data(fd, watch.multishot_generation, watch.kind);
+    sqe->user_data    = CANCEL;
+    if (_skip_success) {
+        sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+    }
+    store(_sq_tail, ++_tail);
+    ++watch.multishot_generation;
+    watch.multishot = false;
+}
+
+void UringBackend::stop_multishot(int fd, Watch& watch)
+{
+    // Without a new generation, so that what it completed before counts
+    io_uring_sqe* sqe = this->next();
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->fd           = -1;
+    sqe->addr         = multishot_data(fd, watch.multishot_generation, watch.kind);
+    sqe->user_data    = CANCEL;
+    if (_skip_success) {
+        sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+    }
+    store(_sq_tail, ++_tail);
+    watch.stopping = true;
+}
+
+void UringBackend::report(int fd, Watch& watch)
+{
+    if (!watch.ready) {
+        watch.ready = true;
+        _ready.push_back(fd);
+    }
+}
+
+bool UringBackend::complete(int fd, const io_uring_cqe& cqe)
+{
+    Watch&   watch      = _watches[fd];
+    uint32_t generation = uint32_t(cqe.user_data >> 34);
+    uint32_t kind       = (cqe.user_data & ACCEPT) ? Event::ACCEPT : Event::RECEIVE;
+    bool     more       = cqe.flags & IORING_CQE_F_MORE;
+    bool     buffer     = cqe.flags & IORING_CQE_F_BUFFER;
+    if (!more) {
+        --_in_flight;
+    }
+
+    // Cancelled since, what it accepted or received belongs to no one
+    if (watch.multishot_generation != generation || !watch.multishot) {
+        if (buffer) {
+            this->recycle(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        } else if (kind == Event::ACCEPT && cqe.res >= 0) {
+            close(cqe.res);
+        }
+        return false;
+    }
+
+    if (!more) {
+        watch.multishot = false;
+    }
+    if (cqe.res == -EINVAL) {
+        // Before Linux 6.0, the sockets are polled from then on
+        _multishot = false;
+    } else if (kind == Event::ACCEPT ? cqe.res >= 0
+                                     : cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+        watch.completed.push_back(
+            {cqe.res, uint16_t(buffer ? cqe.flags >> IORING_CQE_BUFFER_SHIFT : 0), 0});
+    }
+    // A receive is armed again once what it holds was taken
+    if (kind == Event::RECEIVE && watch.multishot && !watch.stopping &&
+        watch.completed.size() - watch.taken >= MAX_HELD) {
+        this->stop_multishot(fd, watch);
+    }
+
+    // Once it ended, the promise accepts or reads itself, and arms it again while pending
+    return watch.watched && (watch.type & kind) == kind && watch.reported != _waits;
+}
+
+void UringBackend::drop(int fd, Watch& watch, const Leftover* leftover)
+{
+    for (size_t i = watch.taken; i < watch.completed.size(); ++i) {
+        const Completed& completed = watch.completed[i];
+        bool             data      = watch.kind == Event::RECEIVE && completed.result > 0;
+        if (leftover != nullptr) {
+            std::string_view received;
+            if (data) {
+                received = std::string_view(&_buffers[completed.buffer * BUFFER_SIZE],
+                                            completed.result)
+                               .substr(completed.offset);
+            }
+            (*leftover)({watch.kind, fd, completed.result, received});
+        } else if (watch.kind == Event::ACCEPT) {
+            close(completed.result);
+        }
+        if (data) {
+            this->recycle(completed.buffer);
+        }
+    }
+    watch.completed.clear();
+    watch.taken = 0;
+}
+
+void UringBackend::recycle(uint16_t buffer)
+{
+    // Not `bufs`: in C++, the empty struct declaring the flexible array moves it past the tail
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(_buf_ring)[_buf_tail & (BUFFERS - 1)];
+    entry.addr          = reinterpret_cast<uint64_t>(&_buffers[buffer * BUFFER_SIZE]);
+    entry.len           = BUFFER_SIZE;
+    entry.bid           = buffer;
+    std::atomic_ref<uint16_t>(_buf_ring->tail).store(++_buf_tail, std::memory_order_release);
+}
+
+void UringBackend::enter(unsigned min_complete, int timeout_ms)
+{
+    __kernel_timespec      timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+    io_uring_getevents_arg arg     = {};
+    arg.ts                         = reinterpret_cast<uint64_t>(&timeout);
+
+    utils::Metrics::instance().add_loop_syscall();
+    long submitted = syscall(__NR_io_uring_enter,
+                             _ring_fd,
+                             this->queued(),
+                             min_complete,
+                             IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                             &arg,
+                             sizeof(arg));
+    // Timing out, a signal, or completions to take before submitting more
+    if (submitted == -1 && errno != ETIME && errno != EINTR && errno != EBUSY &&
+        errno != EAGAIN) {
+        throw error("Failed to wait for io_uring completions");
+    }
+}
+
+int UringBackend::reap(int* fds, int max)
+{
+    unsigned head  = *_cq_head;
+    unsigned tail  = load(_cq_tail);
+    int      count = 0;
+
+    for (; head != tail && count < max; ++head) {
+        const io_uring_cqe& cqe = _cqes[head & _cq_mask];
+        if (cqe.user_data == CANCEL) {
+            continue;
+        }
+
+        int fd = int(uint32_t(cqe.user_data));
+        if (cqe.user_data & MULTISHOT) {
+            if (this->complete(fd, cqe)) {
+                _watches[fd].reported = _waits;
+                fds[count++]          = fd;
+            }
+            continue;
+        }
+
+        uint32_t generation = uint32_t(cqe.user_data >> 34);
+        Watch&   watch      = _watches[fd];
+        // Replaced or removed since it was armed
+        if (watch.generation != generation || !watch.armed) {
+            continue;
+        }
+        watch.armed = false;
+        if (watch.reported != _waits) {
+            watch.reported = _waits;
+            fds[count++]   = fd;
+        }
+    }
+    store(_cq_head, head);
+    return count;
+}
+}  // namespace webserv::async
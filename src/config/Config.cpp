@@ -16,21 +16,37 @@ using Type = Config::Type;
 
 // clang-format off
 const std::map<std::string, Type> Config::TYPE_MAP = {
-    {"",                     MAIN},
-    {"http",                 HTTP},
-    {"server",               SERVER},
-    {"location",             LOCATION},
-    {"server_name",          SERVER_NAME},
-    {"listen",               LISTEN},
-    {"root",                 ROOT},
-    {"index",                INDEX},
-    {"log_level",            LOG_LEVEL},
-    {"limit_except",         LIMIT_EXCEPT},
-    {"autoindex",            AUTOINDEX},
-    {"client_max_body_size", CLIENT_MAX_BODY_SIZE},
-    {"return",               RETURN},
-    {"error_page",           ERROR_PAGE},
-    {"upload_dir",           UPLOAD_DIR}
+    {"",                        MAIN},
+    {"http",                    HTTP},
+    {"server",                  SERVER},
+    {"location",                LOCATION},
+    {"server_name",             SERVER_NAME},
+    {"listen",                  LISTEN},
+    {"root",                    ROOT},
+    {"index",                   INDEX},
+    {"log_level",               LOG_LEVEL},
+    {"limit_except",            LIMIT_EXCEPT},
+    {"autoindex",               AUTOINDEX},
+    {"client_max_body_size",    CLIENT_MAX_BODY_SIZE},
+    {"return",                  RETURN},
+    {"error_page",              ERROR_PAGE},
+    {"upload_dir",              UPLOAD_DIR},
+    {"upstream",                UPSTREAM},
+    {"least_conn",              LEAST_CONN},
+    {"hash",                    HASH},
+    {"keepalive",               KEEPALIVE},
+    {"proxy_pass",              PROXY_PASS},
+    {"proxy_cache",             PROXY_CACHE},
+    {"proxy_cache_valid",       PROXY_CACHE_VALID},
+    {"access_log",              ACCESS_LOG},
+    {"error_log",               ERROR_LOG},
+    {"metrics",                 METRICS},
+    {"slow_callback_threshold", SLOW_CALLBACK_THRESHOLD},
+    {"autoindex_format",        AUTOINDEX_FORMAT},
+    {"autoindex_page_size",     AUTOINDEX_PAGE_SIZE},
+    {"aio",                     AIO},
+    {"event_engine",            EVENT_ENGINE},
+    {"proxy_cache_max_size",    PROXY_CACHE_MAX_SIZE}
 };
 
 // format: {{<allowed parents>, <unique>, [min params], [max params]}}
@@ -40,7 +56,7 @@ const Config::Constraint Config::CONSTRAINTS[] = {
     {{HTTP}, false, nullopt, 0},                 // SERVER
     {{SERVER}, false, 1},                        // LOCATION
     {{SERVER}, false, 1},                        // SERVER_NAME
-    {{SERVER}, false, 1, 2},                     // LISTEN
+    {{SERVER}, false, 1, 3},                     // LISTEN
     {{HTTP, SERVER, LOCATION}, true, 1, 1},      // ROOT
     {{HTTP, SERVER, LOCATION}, true, 1},         // INDEX
     {{MAIN}, true, 1, 1},                        // LOG_LEVEL
@@ -49,7 +65,24 @@ const Config::Constraint Config::CONSTRAINTS[] = {
     {{HTTP, SERVER, LOCATION}, true, 1, 1},      // CLIENT_MAX_BODY_SIZE
     {{HTTP, SERVER, LOCATION}, true, 1, 2},      // RETURN
     {{HTTP, SERVER, LOCATION}, false, 2},        // ERROR_PAGE
-    {{HTTP, SERVER, LOCATION}, true, 1, 1}       // UPLOAD_DIR
+    {{HTTP, SERVER, LOCATION}, true, 1, 1},      // UPLOAD_DIR
+    {{HTTP}, false, 1, 1},                       // UPSTREAM
+    {{UPSTREAM}, false, 1, 4},                   // UPSTREAM_SERVER
+    {{UPSTREAM}, true, 0, 0},                    // LEAST_CONN
+    {{UPSTREAM}, true, 1, 1},                    // HASH
+    {{UPSTREAM}, true, 1, 1},                    // KEEPALIVE
+    {{LOCATION}, true, 1, 1},                    // PROXY_PASS
+    {{HTTP, SERVER, LOCATION}, true, 1, 1},      // PROXY_CACHE
+    {{HTTP, SERVER, LOCATION}, true, 1, 1},      // PROXY_CACHE_VALID
+    {{HTTP, SERVER, LOCATION}, true, 1, 2},      // ACCESS_LOG
+    {{MAIN}, true, 1, 1},                        // ERROR_LOG
+    {{LOCATION}, true, 0, 0},                    // METRICS
+    {{MAIN}, true, 1, 1},                        // SLOW_CALLBACK_THRESHOLD
+    {{HTTP, SERVER, LOCATION}, true, 1, 1},      // AUTOINDEX_FORMAT
+    {{HTTP, SERVER, LOCATION}, true, 1, 1},      // AUTOINDEX_PAGE_SIZE
+    {{HTTP, SERVER, LOCATION}, true, 1, 1},      // AIO
+    {{MAIN}, true, 1, 1},                        // EVENT_ENGINE
+    {{HTTP, SERVER, LOCATION}, true, 1, 1}       // PROXY_CACHE_MAX_SIZE
 };
 
 const Config::Parameters Config::DEFAULT_PARAMS[] = {
@@ -68,6 +101,23 @@ const Config::Parameters Config::DEFAULT_PARAMS[] = {
     {301},             // RETURN
     {},                // ERROR_PAGE
     {},                // UPLOAD_DIR
+    {},                // UPSTREAM
+    {},                // UPSTREAM_SERVER
+    {},                // LEAST_CONN
+    {},                // HASH
+    {32},              // KEEPALIVE
+    {""},              // PROXY_PASS
+    {""},              // PROXY_CACHE
+    {0},               // PROXY_CACHE_VALID
+    {"", "combined"},  // ACCESS_LOG
+    {""},              // ERROR_LOG
+    {},                // METRICS
+    {0},               // SLOW_CALLBACK_THRESHOLD (ms, 0 disables)
+    {"html"},          // AUTOINDEX_FORMAT
+    {0},               // AUTOINDEX_PAGE_SIZE (0 lists every entry on one page)
+    {"threads"},       // AIO
+    {"epoll"},         // EVENT_ENGINE
+    {268435456},       // PROXY_CACHE_MAX_SIZE (256MiB)
 };
 // clang-format on
 
@@ -129,6 +179,8 @@ Config::Config(const std::string& file_path) : _name(""), _type(MAIN), _parent(n
 
     Parser parser(buffer.str());
     parser.parse(*this);
+
+    this->compile();
 }
 
 Config::Config(const std::string& name, Type type, Config* parent)
@@ -205,18 +257,62 @@ Config::iterator Config::end() const
     return Config::iterator(this, _children.size());
 }
 
-const Config& Config::location(const std::string& uri) const
+const Config& Config::location(std::string_view uri) const
+{
+    if (!_locations) {
+        _locations = std::make_shared<LocationMatcher>(*this);
+    }
+
+    const Config* location = _locations->match(uri);
+    return location != nullptr ? *location : *this;
+}
+
+const ResolvedLocation& Config::resolved() const
+{
+    if (!_resolved) {
+        _resolved = std::make_shared<ResolvedLocation>(*this);
+    }
+    return *_resolved;
+}
+
+void Config::compile()
 {
-    for (auto it = this->begin(Type::LOCATION); it != this->end(); it = it.next(Type::LOCATION)) {
-        for (const auto& param : it->get_parameters()) {
-            std::string param_name = std::get<std::string>(param);
-            if (param_name == uri || (param_name.ends_with('/') && uri.starts_with(param_name))) {
-                return *it;
+    if (_type == SERVER) {
+        _locations = std::make_shared<LocationMatcher>(*this);
+    }
+    if (_type == SERVER || _type == LOCATION) {
+        _resolved = std::make_shared<ResolvedLocation>(*this);
+    }
+
+    for (auto& child : _children) {
+        child->compile();
+    }
+}
+
+std::vector<Config::Listen> Config::listens() const
+{
+    const Parameters& defaults = get_default_params(LISTEN);
+
+    std::vector<Listen> listens;
+    for (auto it = this->begin(LISTEN); it != this->end(); it = it.next(LISTEN)) {
+        const Parameters& params = it->get_parameters();
+
+        Listen listen = {std::get<std::string>(defaults[1]), std::get<int>(params[0]), false};
+        for (size_t i = 1; i < params.size(); ++i) {
+            const std::string& param = std::get<std::string>(params[i]);
+            if (param == "default_server") {
+                listen.default_server = true;
+            } else {
+                listen.host = param;
             }
         }
+        listens.push_back(listen);
     }
 
-    return *this;
+    if (listens.empty()) {
+        listens.push_back({std::get<std::string>(defaults[1]), std::get<int>(defaults[0]), false});
+    }
+    return listens;
 }
 
 const std::string& Config::server_name() const
@@ -226,7 +322,11 @@ const std::string& Config::server_name() const
 
 const std::string& Config::host() const
 {
-    return this->value<std::string>(LISTEN, 1);
+    const std::string& host = this->value<std::string>(LISTEN, 1);
+    if (host == "default_server") {
+        return std::get<std::string>(get_default_params(LISTEN)[1]);
+    }
+    return host;
 }
 
 const std::string& Config::root() const
@@ -281,6 +381,68 @@ const std::string& Config::upload_dir() const
     return this->value<std::string>(UPLOAD_DIR, 0);
 }
 
+const std::string& Config::proxy_pass() const
+{
+    return this->value<std::string>(PROXY_PASS, 0);
+}
+
+const std::string& Config::proxy_cache() const
+{
+    return this->value<std::string>(PROXY_CACHE, 0);
+}
+
+const std::string& Config::access_log() const
+{
+    // `access_log off;` is lexed as a boolean
+    const Config* directive = this->get(ACCESS_LOG);
+    if (directive != nullptr && std::holds_alternative<bool>(directive->get_parameters()[0])) {
+        return std::get<std::string>(DEFAULT_PARAMS[static_cast<int>(ACCESS_LOG)][0]);
+    }
+    return this->value<std::string>(ACCESS_LOG, 0);
+}
+
+const std::string& Config::access_log_format() const
+{
+    return this->value<std::string>(ACCESS_LOG, 1);
+}
+
+const std::string& Config::error_log() const
+{
+    return this->value<std::string>(ERROR_LOG, 0);
+}
+
+int Config::slow_callback_threshold() const
+{
+    return this->value<int>(SLOW_CALLBACK_THRESHOLD, 0);
+}
+
+const std::string& Config::autoindex_format() const
+{
+    return this->value<std::string>(AUTOINDEX_FORMAT, 0);
+}
+
+const std::string& Config::aio() const
+{
+    static const std::string on = "on", off = "off";
+
+    // `aio off;` is lexed as a boolean
+    const Config* directive = this->get(AIO);
+    if (directive != nullptr && std::holds_alternative<bool>(directive->get_parameters()[0])) {
+        return std::get<bool>(directive->get_parameters()[0]) ? on : off;
+    }
+    return this->value<std::string>(AIO, 0);
+}
+
+const std::string& Config::event_engine() const
+{
+    return this->value<std::string>(EVENT_ENGINE, 0);
+}
+
+int Config::autoindex_page_size() const
+{
+    return this->value<int>(AUTOINDEX_PAGE_SIZE, 0);
+}
+
 int Config::port() const
 {
     return this->value<int>(LISTEN, 0);
@@ -321,6 +483,16 @@ int Config::return_code() const
     return std::get<int>(return_it->_parameters.at(0));
 }
 
+int Config::proxy_cache_valid() const
+{
+    return this->value<int>(PROXY_CACHE_VALID, 0);
+}
+
+int Config::proxy_cache_max_size() const
+{
+    return this->value<int>(PROXY_CACHE_MAX_SIZE, 0);
+}
+
 Type Config::get_type() const
 {
     return _type;
@@ -354,6 +526,8 @@ void Config::add_parameter(const Value& value)
 void Config::add_child(std::shared_ptr<Config> child)
 {
     _children.push_back(child);
+    _locations.reset();
+    _resolved.reset();
 }
 
 const Config::Constraint& Config::get_constraint(Type type)
@@ -0,0 +1,99 @@
+#include "config/LocationMatcher.hpp"
+
+#include <stdexcept>
+
+#include "config/Config.hpp"
+
+namespace webserv::config
+{
+LocationMatcher::LocationMatcher(const Config& server) : _nodes(1)
+{
+    for (auto it = server.begin(Config::LOCATION); it != server.end();
+         it      = it.next(Config::LOCATION)) {
+        const auto& params   = it->get_parameters();
+        const auto& modifier = std::get<std::string>(params[0]);
+
+        if (modifier == "~" || modifier == "~*") {
+            if (params.size() != 2) {
+                throw std::runtime_error("Regex location requires exactly one pattern");
+            }
+            _regex.add(std::get<std::string>(params[1]), modifier == "~*");
+            _regex_locations.push_back(&*it);
+            continue;
+        }
+
+        for (const auto& param : params) {
+            std::string_view path = std::get<std::string>(param);
+
+            // The first location declared for a path wins
+            _exact.emplace(path, &*it);
+            if (path.starts_with('/') && path.ends_with('/')) {
+                this->insert(path, &*it);
+            }
+        }
+    }
+}
+
+const Config* LocationMatcher::match(std::string_view uri) const
+{
+    auto exact = _exact.find(uri);
+    if (exact != _exact.end()) {
+        return exact->second;
+    }
+
+    int regex = _regex.match(uri);
+    if (regex != -1) {
+        return _regex_locations[regex];
+    }
+
+    if (!uri.starts_with('/')) {
+        return nullptr;
+    }
+
+    const Node*   node = &_nodes[0];
+    const Config* best = node->location;
+
+    // Only segments followed by a '/' can match a location
+    size_t pos = 1;
+    size_t end;
+    while ((end = uri.find('/', pos)) != std::string_view::npos) {
+        auto child = node->children.find(uri.substr(pos, end - pos));
+        if (child == node->children.end()) {
+            break;
+        }
+
+        node = &_nodes[child->second];
+        if (node->location != nullptr) {
+            best = node->location;
+        }
+        pos = end + 1;
+    }
+
+    return best;
+}
+
+void LocationMatcher::insert(std::string_view path, const Config* location)
+{
+    size_t node = 0;
+    size_t pos  = 1;
+    size_t end;
+
+    while ((end = path.find('/', pos)) != std::string_view::npos) {
+        std::string_view segment = path.substr(pos, end - pos);
+
+        auto child = _nodes[node].children.find(segment);
+        if (child == _nodes[node].children.end()) {
+            _nodes[node].children.emplace(segment, _nodes.size());
+            node = _nodes.size();
+            _nodes.emplace_back();
+        } else {
+            node = child->second;
+        }
+        pos = end + 1;
+    }
+
+    if (_nodes[node].location == nullptr) {
+        _nodes[node].location = location;
+    }
+}
+}  // namespace webserv::config
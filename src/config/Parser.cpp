@@ -69,7 +69,13 @@ std::shared_ptr<Config> Parser::parse_directive(Config* parent)
     if (it == Config::TYPE_MAP.end()) {
         throw std::runtime_error("Unknown directive: " + name);
     }
-    std::shared_ptr<Config> directive(std::make_shared<Config>(name, it->second, parent));
+    Type type = it->second;
+
+    // `server` inside an `upstream` block names a backend, not a virtual server
+    if (type == Type::SERVER && parent->get_type() == Type::UPSTREAM) {
+        type = Type::UPSTREAM_SERVER;
+    }
+    std::shared_ptr<Config> directive(std::make_shared<Config>(name, type, parent));
 
     // Check if the directive is allowed in the parent directive
     const auto& constraint = Config::get_constraint(directive->get_type());
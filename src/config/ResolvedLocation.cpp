@@ -0,0 +1,96 @@
+#include "config/ResolvedLocation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "config/Config.hpp"
+
+namespace webserv::config
+{
+namespace
+{
+/// Returns the upload directory, or "" if uploads aren't allowed
+const std::string& upload_dir_of(const Config& location)
+{
+    static const std::string empty = "";
+
+    if (location.get(Config::UPLOAD_DIR) == nullptr) {
+        return empty;
+    }
+    return location.upload_dir();
+}
+
+/// Returns the access log, or `nullptr` if it is unset or `off`
+utils::AccessLog* access_log_of(const Config& location)
+{
+    const std::string& path = location.access_log();
+    if (path == "") {
+        return nullptr;
+    }
+    return &utils::AccessLog::get(path, location.access_log_format());
+}
+
+/// Returns the counters of a location, labelled by its server name and path
+utils::Metrics::Location& metrics_of(const Config& location)
+{
+    std::string path;
+    if (location.get_type() == Config::LOCATION) {
+        for (const auto& parameter : location.get_parameters()) {
+            if (const auto* value = std::get_if<std::string>(&parameter)) {
+                path += (path.empty() ? "" : " ") + *value;
+            }
+        }
+    }
+    return utils::Metrics::instance().location(location.server_name(), path);
+}
+
+/// Returns the autoindex format, which must be known
+const std::string& autoindex_format_of(const Config& location)
+{
+    const std::string& format = location.autoindex_format();
+    if (format != "html" && format != "json" && format != "xml") {
+        throw std::runtime_error("Unknown autoindex format: " + format);
+    }
+    return format;
+}
+
+/// Returns true for `aio threads`, false for `aio off`
+bool aio_threads_of(const Config& location)
+{
+    const std::string& aio = location.aio();
+    if (aio != "threads" && aio != "off") {
+        throw std::runtime_error("Unknown aio mode: " + aio);
+    }
+    return aio == "threads";
+}
+}  // namespace
+
+ResolvedLocation::ResolvedLocation(const Config& location)
+    : root(location.root()),
+      index(location.index()),
+      upload_dir(upload_dir_of(location)),
+      return_uri(location.return_uri()),
+      proxy_pass(location.proxy_pass()),
+      proxy_cache(location.proxy_cache()),
+      autoindex_format(autoindex_format_of(location)),
+      access_log(access_log_of(location)),
+      metrics(metrics_of(location)),
+      client_max_body_size(std::max(location.client_max_body_size(), 0)),
+      return_code(location.return_code()),
+      proxy_cache_valid(location.proxy_cache_valid()),
+      proxy_cache_max_size(std::max(location.proxy_cache_max_size(), 0)),
+      autoindex_page_size(std::max(location.autoindex_page_size(), 0)),
+      autoindex(location.autoindex()),
+      aio_threads(aio_threads_of(location)),
+      metrics_endpoint(location.get(Config::METRICS) != nullptr)
+{
+    for (size_t i = 0; i < methods.size(); ++i) {
+        methods[i] = location.limit_except(METHODS[i]);
+    }
+}
+
+bool ResolvedLocation::allows(int method) const
+{
+    return methods[method];
+}
+}  // namespace webserv::config
@@ -0,0 +1,354 @@
+#include "http/Autoindex.hpp"
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#include "async/ThreadPool.hpp"
+#include "http/Response.hpp"
+#include "utils/Format.hpp"
+
+namespace webserv::http
+{
+using StatusCode = Response::StatusCode;
+
+namespace
+{
+/// The record `getdents64` fills, which glibc only declares in recent versions
+struct LinuxDirent64
+{
+    ino64_t        d_ino;
+    off64_t        d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+};
+
+/// Entries are read in batches of this many bytes
+constexpr size_t DIRENT_BUFFER_SIZE = 32768;
+
+/// Appends a string with the characters special to HTML and XML escaped
+void append_escaped(std::string& out, std::string_view value)
+{
+    for (char c : value) {
+        switch (c) {
+        case '&':
+            out += "&amp;";
+            break;
+        case '<':
+            out += "&lt;";
+            break;
+        case '>':
+            out += "&gt;";
+            break;
+        case '"':
+            out += "&quot;";
+            break;
+        default:
+            out += c;
+        }
+    }
+}
+
+/// Appends a path with everything but unreserved characters and '/' percent-encoded, so that
+/// names with '#', '?', '%' or spaces link to themselves
+void append_uri_encoded(std::string& out, std::string_view value)
+{
+    static const char HEX[] = "0123456789ABCDEF";
+
+    for (unsigned char c : value) {
+        if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~' || c == '/') {
+            out += c;
+        } else {
+            out += '%';
+            out += HEX[c >> 4];
+            out += HEX[c & 0xf];
+        }
+    }
+}
+
+/// Appends a time in UTC with a `strftime` format
+void append_time(std::string& out, time_t time, const char* format)
+{
+    char buffer[64];
+    tm   utc;
+    gmtime_r(&time, &utc);
+    out.append(buffer, strftime(buffer, sizeof(buffer), format, &utc));
+}
+
+void render_html(std::string&            out,
+                 const Autoindex::Entry* begin,
+                 const Autoindex::Entry* end,
+                 std::string_view        uri)
+{
+    for (const Autoindex::Entry* entry = begin; entry != end; ++entry) {
+        out += "<li><a href=\"";
+        append_uri_encoded(out, uri);
+        append_uri_encoded(out, entry->name);
+        out += entry->is_dir ? "/\">" : "\">";
+        append_escaped(out, entry->name);
+        out += "</a></li>\n";
+    }
+}
+
+/// The format of nginx's `autoindex_format json`
+void render_json(std::string& out, const Autoindex::Entry* begin, const Autoindex::Entry* end)
+{
+    out += "[\n";
+    for (const Autoindex::Entry* entry = begin; entry != end; ++entry) {
+        out += "{ \"name\":\"";
+        utils::append_json(out, entry->name);
+        out += entry->is_dir ? "\", \"type\":\"directory\", \"mtime\":\""
+                             : "\", \"type\":\"file\", \"mtime\":\"";
+        append_time(out, entry->mtime, "%a, %d %b %Y %H:%M:%S GMT");
+        out += '"';
+        if (!entry->is_dir) {
+            utils::format_to(out, ", \"size\":{}", entry->size);
+        }
+        out += entry + 1 != end ? " },\n" : " }\n";
+    }
+    out += "]\n";
+}
+
+/// The format of nginx's `autoindex_format xml`
+void render_xml(std::string& out, const Autoindex::Entry* begin, const Autoindex::Entry* end)
+{
+    out += "<?xml version=\"1.0\"?>\n<list>\n";
+    for (const Autoindex::Entry* entry = begin; entry != end; ++entry) {
+        out += entry->is_dir ? "<directory mtime=\"" : "<file mtime=\"";
+        append_time(out, entry->mtime, "%Y-%m-%dT%H:%M:%SZ");
+        out += '"';
+        if (!entry->is_dir) {
+            utils::format_to(out, " size=\"{}\"", entry->size);
+        }
+        out += '>';
+        append_escaped(out, entry->name);
+        out += entry->is_dir ? "</directory>\n" : "</file>\n";
+    }
+    out += "</list>\n";
+}
+}  // namespace
+
+bool Autoindex::Scan::outdated(const struct stat& current) const
+{
+    if (current.st_ino != _stat.st_ino || current.st_dev != _stat.st_dev ||
+        current.st_mtim.tv_sec != _stat.st_mtim.tv_sec ||
+        current.st_mtim.tv_nsec != _stat.st_mtim.tv_nsec) {
+        return true;
+    }
+    // Timestamps are coarse: a directory modified less than a second before it
+    // was read may have changed again without its time changing
+    return this->ready() && _stat.st_mtim.tv_sec + 1 >= _started.tv_sec;
+}
+
+std::shared_ptr<const Autoindex::Scan> Autoindex::list(const std::string& path)
+{
+    struct stat dir_stat;
+    if (stat(path.c_str(), &dir_stat) == -1 || !S_ISDIR(dir_stat.st_mode)) {
+        throw StatusCode::FORBIDDEN;
+    }
+    return list(path, dir_stat);
+}
+
+std::shared_ptr<const Autoindex::Scan> Autoindex::list(const std::string& path,
+                                                       const struct stat& dir_stat)
+{
+    Registry& cache = registry();
+    auto      it    = cache.find(path);
+    if (it != cache.end() && !it->second->outdated(dir_stat)) {
+        return it->second;
+    }
+    if (it == cache.end() && cache.size() >= MAX_DIRECTORIES) {
+        // Scans in progress are kept alive by their job
+        cache.erase(cache.begin());
+    }
+
+    auto scan   = std::make_shared<Scan>();
+    scan->_stat = dir_stat;
+    clock_gettime(CLOCK_REALTIME, &scan->_started);
+    cache[path] = scan;
+
+    async::ThreadPool::instance().submit([scan, path] { scan->_failed = !read(path, scan->_listing); },
+                                         [scan] { scan->_ready = true; });
+    return scan;
+}
+
+bool Autoindex::read(const std::string& path, Listing& listing)
+{
+    int dir_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd == -1) {
+        return false;
+    }
+
+    listing.clear();
+    auto    buffer = std::make_unique<char[]>(DIRENT_BUFFER_SIZE);
+    ssize_t bytes;
+    while ((bytes = syscall(SYS_getdents64, dir_fd, buffer.get(), DIRENT_BUFFER_SIZE)) > 0) {
+        for (ssize_t offset = 0; offset < bytes;) {
+            auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.get() + offset);
+            offset += dirent->d_reclen;
+
+            std::string_view name = dirent->d_name;
+            if (name == "." || name == ".." || name == ".gitignore") {
+                continue;
+            }
+            // Follows symbolic links, like the files they lead to are served
+            struct stat file_stat;
+            if (fstatat(dir_fd, dirent->d_name, &file_stat, 0) == 0) {
+                listing.push_back({std::string(name),
+                                   S_ISDIR(file_stat.st_mode),
+                                   file_stat.st_size,
+                                   file_stat.st_mtime});
+            }
+        }
+    }
+    close(dir_fd);
+
+    std::sort(listing.begin(), listing.end(), [](const Entry& a, const Entry& b) {
+        return a.name < b.name;
+    });
+    return bytes == 0;
+}
+
+std::string Autoindex::render(const Listing&     listing,
+                              Format             format,
+                              std::string_view   uri,
+                              Page               page,
+                              const std::string& html_template)
+{
+    const Entry* begin = listing.data();
+    const Entry* end   = listing.data() + listing.size();
+    if (page.size > 0) {
+        size_t first = std::min(std::min(page.number - 1, listing.size()) * page.size,
+                                listing.size());
+        begin        = listing.data() + first;
+        end          = begin + std::min(page.size, listing.size() - first);
+    }
+
+    std::string out;
+    out.reserve((end - begin) * 96 + html_template.size() + 512);
+
+    switch (format) {
+    case Format::JSON:
+        render_json(out, begin, end);
+        return out;
+    case Format::XML:
+        render_xml(out, begin, end);
+        return out;
+    case Format::HTML:
+        break;
+    }
+
+    std::string entries;
+    render_html(entries, begin, end, uri);
+    if (page.size > 0) {
+        if (page.number > 1) {
+            utils::format_to(
+                entries, "<li><a href=\"?page={}\">Previous</a></li>\n", page.number - 1);
+        }
+        if (end != listing.data() + listing.size()) {
+            utils::format_to(entries, "<li><a href=\"?page={}\">Next</a></li>\n", page.number + 1);
+        }
+    }
+
+    std::string escaped_uri;
+    append_escaped(escaped_uri, uri);
+    if (html_template.empty()) {
+        utils::format_to(out,
+                         "<!DOCTYPE html>\n"
+                         "<html lang=\"en-US\"><head><meta charset=\"utf-8\" />\n"
+                         "    <head>\n"
+                         "		<title>Index of {}</title>\n"
+                         "    </head>\n"
+                         "    <body>\n"
+                         "		<h1>Index of {}</h1>\n"
+                         "    <ul>\n"
+                         "{}"
+                         "        </ul>\n"
+                         "    </body>\n"
+                         "</html>\n",
+                         escaped_uri,
+                         escaped_uri,
+                         entries);
+        return out;
+    }
+
+    // Fills the placeholders in one pass
+    std::string_view rest = html_template;
+    while (!rest.empty()) {
+        size_t pos = rest.find("{{");
+        out.append(rest.substr(0, pos));
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        rest.remove_prefix(pos);
+        if (rest.starts_with("{{URI}}")) {
+            out += escaped_uri;
+            rest.remove_prefix(7);
+        } else if (rest.starts_with("{{DIRECTORY_ENTRIES}}")) {
+            out += entries;
+            rest.remove_prefix(21);
+        } else {
+            out += "{{";
+            rest.remove_prefix(2);
+        }
+    }
+    return out;
+}
+
+Autoindex::Format Autoindex::format_of(const std::string& format)
+{
+    if (format == "html") {
+        return Format::HTML;
+    }
+    if (format == "json") {
+        return Format::JSON;
+    }
+    if (format == "xml") {
+        return Format::XML;
+    }
+    throw std::runtime_error("Unknown autoindex format: " + format);
+}
+
+std::string_view Autoindex::extension(Format format)
+{
+    switch (format) {
+    case Format::JSON:
+        return "json";
+    case Format::XML:
+        return "xml";
+    case Format::HTML:
+        break;
+    }
+    return "html";
+}
+
+Autoindex::Page Autoindex::page_of(std::string_view query, size_t size)
+{
+    Page page{1, size};
+    while (!query.empty()) {
+        size_t           end   = std::min(query.find('&'), query.size());
+        std::string_view param = query.substr(0, end);
+        query.remove_prefix(std::min(end + 1, query.size()));
+
+        if (param.starts_with("page=")) {
+            size_t number = 0;
+            std::from_chars(param.data() + 5, param.data() + param.size(), number);
+            page.number = std::max<size_t>(number, 1);
+        }
+    }
+    return page;
+}
+
+Autoindex::Registry& Autoindex::registry()
+{
+    static Registry registry;
+    return registry;
+}
+}  // namespace webserv::http
@@ -1,13 +1,16 @@
 #include "http/CGI.hpp"
 
+#include <signal.h>
 #include <sys/stat.h>  // For stat
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <algorithm>
-#include <cstring>
 
+#include "async/Signal.hpp"
 #include "http/Response.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/StaticMap.hpp"
 #include "utils/std_utils.hpp"
 
 #ifndef BUFFER_SIZE
@@ -16,6 +19,17 @@
 
 namespace webserv::http
 {
+namespace
+{
+/// The interpreter of each script extension
+constexpr auto CGI_INTERPRETERS = utils::make_static_map<std::string_view>({
+    {".py", "/bin/python3"},
+    // {".php", "/usr/bin/php-cgi"},
+    // {".pl", "/usr/bin/perl"},
+    // {".rb", "/usr/bin/ruby"}
+});
+}  // namespace
+
 CGI::CGI(const Request& request, const std::string& uri, const std::string& interpreter)
     : _request(request), _state(State::IDLE), _bytes_written(0)
 {
@@ -25,6 +39,13 @@ CGI::CGI(const Request& request, const std::string& uri, const std::string& inte
         throw Response::StatusCode::INTERNAL_SERVER_ERROR;
     }
 
+    // Everything the child needs is allocated before `fork`: another thread may hold the
+    // allocator's lock, which the child would never see released
+    std::vector<std::string> env  = create_env();
+    std::vector<char*>       envp = utils::c_str_array(env);
+    std::vector<std::string> args = {interpreter, uri};
+    std::vector<char*>       argv = utils::c_str_array(args);
+
     _pid = fork();
     if (_pid < 0) {
         throw Response::StatusCode::INTERNAL_SERVER_ERROR;
@@ -39,17 +60,16 @@ CGI::CGI(const Request& request, const std::string& uri, const std::string& inte
         dup2(_stdin_pipe[0], STDIN_FILENO);
         close(_stdin_pipe[0]);
 
-        char** env    = create_envp();
-        char*  argv[] = {
-            const_cast<char*>(interpreter.c_str()), const_cast<char*>(uri.c_str()), nullptr};
+        async::Signal::unblock_all();
+        // Ignored signals stay ignored across `execve`
+        signal(SIGPIPE, SIG_DFL);
 
-        if (execve(interpreter.c_str(), argv, env) == -1) {
-            utils::free_string_array(env);
-            exit(EXIT_FAILURE);
-        }
+        execve(argv[0], argv.data(), envp.data());
+        _exit(EXIT_FAILURE);
     } else {
         close(_stdout_pipe[1]);
         close(_stdin_pipe[0]);
+        utils::Metrics::instance().add_cgi_spawn();
     }
 }
 
@@ -65,7 +85,7 @@ void CGI::try_file(const std::string& uri) const
     }
 }
 
-char** CGI::create_envp() const
+std::vector<std::string> CGI::create_env() const
 {
     std::unordered_map<std::string, std::string> env_map;
 
@@ -74,22 +94,21 @@ char** CGI::create_envp() const
     if (_request.get_method() == Request::Method::POST) {
         env_map["CONTENT_LENGTH"] = std::to_string(_request.body().size());
     }
-    env_map["REQUEST_URI"]     = _request.get_uri();
-    env_map["QUERY_STRING"]    = _request.get_query();
+    env_map["REQUEST_URI"]     = std::string(_request.get_uri());
+    env_map["QUERY_STRING"]    = std::string(_request.get_query());
     env_map["SERVER_PROTOCOL"] = "HTTP/1.1";
 
     // Dynamically convert HTTP headers to CGI environment variables
-    const Request::Headers& headers = _request.get_headers();
-    for (const auto& [key, value] : headers) {
+    for (const auto& [id, key, value] : _request.get_headers()) {
         std::string env_key;
         // Special cases for Content-Type and Content-Length (without HTTP_ prefix)
-        if (key == "Content-Type") {
+        if (id == Header::CONTENT_TYPE) {
             env_key = "CONTENT_TYPE";
-        } else if (key == "Content-Length") {
+        } else if (id == Header::CONTENT_LENGTH) {
             env_key = "CONTENT_LENGTH";
         } else {
             // For other headers, dynamically apply the CGI transformation
-            env_key = "HTTP_" + key;  // Prefix with HTTP_ (TODO: check if this is correct)
+            env_key = "HTTP_" + std::string(key);  // Prefix with HTTP_ (TODO: check if this is correct)
             std::transform(env_key.begin(),
                            env_key.end(),
                            env_key.begin(),
@@ -98,44 +117,30 @@ char** CGI::create_envp() const
                 env_key.begin(), env_key.end(), '-', '_');  // Replace hyphens with underscores
         }
         // Add the transformed header to the environment map
-        env_map[env_key] = value;
+        env_map[env_key] = std::string(value);
     }
-    return convert_map_to_envp(env_map);
-}
 
-char** CGI::convert_map_to_envp(const std::unordered_map<std::string, std::string>& env_map) const
-{
-    char** envp = new char*[env_map.size() + 1];
-
-    size_t i = 0;
+    std::vector<std::string> env;
+    env.reserve(env_map.size());
     for (const auto& [key, value] : env_map) {
-        std::string env = key + "=" + value;
-        envp[i]         = new char[env.size() + 1];
-        std::strcpy(envp[i], env.c_str());
-        ++i;
+        env.push_back(key + "=" + value);
     }
-    envp[i] = nullptr;
-    return envp;
+    return env;
 }
 
 bool CGI::is_cgi_request(const std::string& uri, std::string& interpreter)
 {
-    std::unordered_map<std::string, std::string> cgi_interpreters = {
-        {".py", "/bin/python3"},
-        // {".php", "/usr/bin/php-cgi"},
-        // {".pl", "/usr/bin/perl"},
-        // {".rb", "/usr/bin/ruby"}
-    };
-
-    for (const auto& [extension, path] : cgi_interpreters) {
-        size_t ext_size = extension.size();
-        if (uri.size() >= ext_size &&
-            uri.compare(uri.size() - ext_size, ext_size, extension) == 0) {
-            interpreter = path;
-            return true;
-        }
+    size_t dot = uri.find_last_of("./");
+    if (dot == std::string::npos || uri[dot] != '.') {
+        return false;
     }
-    return false;
+
+    const std::string_view* path = CGI_INTERPRETERS.find(std::string_view(uri).substr(dot));
+    if (path == nullptr) {
+        return false;
+    }
+    interpreter = *path;
+    return true;
 }
 
 CGI::State CGI::state() const
@@ -159,10 +164,10 @@ Promise<ssize_t> CGI::read(std::string& buffer)
         async::Event::READABLE);
 }
 
-Promise<ssize_t> CGI::write(const std::string& buffer)
+Promise<ssize_t> CGI::write(std::string_view buffer)
 {
     return Promise<ssize_t>(
-        [this, &buffer]() -> std::optional<ssize_t> {
+        [this, buffer]() -> std::optional<ssize_t> {
             ssize_t bytes_written = ::write(_stdin_pipe[1], buffer.data(), buffer.size());
             if (bytes_written == -1) {
                 return std::nullopt;
@@ -179,7 +184,9 @@ Promise<std::string> CGI::get_output()
 
     return Promise<std::string>([this]() -> std::optional<std::string> {
         if (_state == State::WRITE) {
-            this->write(_request.body()).then([this](ssize_t bytes_written) {
+            // Only the part of the body the child hasn't read yet
+            std::string_view body = _request.body().substr(_bytes_written);
+            this->write(body).then([this](ssize_t bytes_written) {
                 _bytes_written += bytes_written;
                 if (_bytes_written >= _request.body().size()) {
                     close(_stdin_pipe[1]);
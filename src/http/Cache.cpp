@@ -0,0 +1,316 @@
+#include "http/Cache.hpp"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#include "utils/Format.hpp"
+
+namespace webserv::http
+{
+namespace
+{
+/// Returns the value of a header in a lowercased header block, or "" if it's missing
+std::string header_value(const std::string& head, const std::string& name)
+{
+    size_t pos = head.find("\r\n" + name + ":");
+    if (pos == std::string::npos) {
+        return "";
+    }
+
+    size_t start = head.find_first_not_of(' ', pos + name.size() + 3);
+    size_t end   = head.find("\r\n", pos + 2);
+    if (start == std::string::npos || start >= end) {
+        return "";
+    }
+    return head.substr(start, end - start);
+}
+
+/// Parses the seconds of a `directive=seconds` Cache-Control directive, or -1 if it's missing
+time_t directive_seconds(const std::string& cache_control, const std::string& directive)
+{
+    size_t pos = cache_control.find(directive + "=");
+    while (pos != std::string::npos && pos != 0 && cache_control[pos - 1] != ' ' &&
+           cache_control[pos - 1] != ',') {
+        pos = cache_control.find(directive + "=", pos + 1);
+    }
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    return std::strtol(cache_control.c_str() + pos + directive.size() + 1, nullptr, 10);
+}
+
+/// Rebuilds the request line and headers of a bodyless request
+std::string request_head(const Request& request)
+{
+    std::string head = utils::format("{} {}", request.method_str(), request.get_uri());
+    if (!request.get_query().empty()) {
+        utils::format_to(head, "?{}", request.get_query());
+    }
+    head += " HTTP/1.1\r\n";
+    for (const auto& [id, name, value] : request.get_headers()) {
+        utils::format_to(head, "{}: {}\r\n", name, value);
+    }
+    return head + "\r\n";
+}
+}  // namespace
+
+Cache::Refresh::Refresh(std::string key, std::string head)
+    : key(std::move(key)), head(std::move(head)), request(this->head)
+{
+}
+
+Cache::Cache(const std::string& dir, size_t max_size) : _dir(dir), _max_size(max_size), _size(0)
+{
+    std::error_code error;
+    std::filesystem::create_directories(_dir, error);
+}
+
+Cache::Lookup Cache::lookup(const std::string& key, std::string& path)
+{
+    time_t now   = std::time(nullptr);
+    auto   it    = _entries.try_emplace(key).first;
+    Entry& entry = it->second;
+
+    if (entry.locked && entry.stale_until <= now) {
+        return Lookup::WAIT;
+    }
+
+    if (entry.path != "" && entry.stale_until > now) {
+        path = entry.path;
+        _lru.splice(_lru.begin(), _lru, entry.lru);
+        if (entry.expires > now) {
+            return Lookup::HIT;
+        }
+        // Stale but servable, the first one to see it revalidates
+        if (entry.locked) {
+            return Lookup::UPDATING;
+        }
+        entry.locked = true;
+        return Lookup::STALE;
+    }
+
+    entry.locked = true;
+    return Lookup::MISS;
+}
+
+void Cache::store(const std::string& key, const std::string& response, time_t valid)
+{
+    time_t now   = std::time(nullptr);
+    time_t stale = 0;
+    time_t fresh = freshness(response, now, valid, stale);
+
+    if (fresh <= 0 || response.size() > _max_size || !this->write(key, response)) {
+        this->unlock(key);
+        return;
+    }
+
+    auto   it    = _entries.try_emplace(key).first;
+    Entry& entry = it->second;
+    if (entry.path != "") {
+        _size -= entry.size;
+        _lru.erase(entry.lru);
+    }
+
+    entry.path        = this->path(key);
+    entry.size        = response.size();
+    entry.expires     = now + fresh;
+    entry.stale_until = entry.expires + stale;
+    entry.locked      = false;
+    entry.lru         = _lru.insert(_lru.begin(), key);
+    _size += entry.size;
+
+    this->shrink();
+}
+
+void Cache::unlock(const std::string& key)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return;
+    }
+
+    // Entries without a response only exist while a request holds their lock
+    it->second.locked = false;
+    if (it->second.path == "") {
+        _entries.erase(it);
+    }
+}
+
+void Cache::forget(const std::string& key)
+{
+    // The file is gone, or a key with the same file name replaced it
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        this->evict(it);
+    }
+}
+
+void Cache::revalidate(const std::string& key,
+                       const Request&     request,
+                       const std::string& target,
+                       time_t             valid)
+{
+    auto     it      = _refreshes.emplace(_refreshes.end(), key, request_head(request));
+    Refresh& refresh = *it;
+    refresh.proxy.reset(new Proxy(refresh.request, target));
+    // Each refresh is dropped by its own callback, other lookups can't tell when that ran
+    refresh.proxy->get_output().then([this, it, valid](const std::string& output) {
+        if (it->proxy->state() == Proxy::State::FAILED) {
+            this->unlock(it->key);
+        } else {
+            this->store(it->key, output, valid);
+        }
+        _refreshes.erase(it);
+    });
+}
+
+Cache& Cache::get(const std::string& dir, size_t max_size)
+{
+    auto it = registry().find(dir);
+    if (it == registry().end()) {
+        it = registry().emplace(dir, std::make_unique<Cache>(dir, max_size)).first;
+    } else if (it->second->_max_size != max_size) {
+        it->second->_max_size = max_size;
+        it->second->shrink();
+    }
+    return *it->second;
+}
+
+std::string Cache::key(const Request& request)
+{
+    std::string key =
+        utils::format("{} {}{}", request.method_str(), request.host(), request.get_uri());
+    if (!request.get_query().empty()) {
+        utils::format_to(key, "?{}", request.get_query());
+    }
+    return key;
+}
+
+time_t Cache::freshness(const std::string& response, time_t now, time_t valid, time_t& stale)
+{
+    stale = 0;
+
+    size_t head_end = response.find("\r\n\r\n");
+    if (head_end == std::string::npos) {
+        return 0;
+    }
+    std::string head = response.substr(0, head_end + 2);
+    std::transform(head.begin(), head.end(), head.begin(), ::tolower);
+
+    std::string status = head.substr(head.find(' ') + 1, 3);
+    if ((status != "200" && status != "301" && status != "404") ||
+        head.find("\r\nset-cookie:") != std::string::npos) {
+        return 0;
+    }
+
+    std::string cache_control = header_value(head, "cache-control");
+    if (cache_control.find("no-store") != std::string::npos ||
+        cache_control.find("no-cache") != std::string::npos ||
+        cache_control.find("private") != std::string::npos) {
+        return 0;
+    }
+
+    stale = std::max<time_t>(0, directive_seconds(cache_control, "stale-while-revalidate"));
+
+    // s-maxage is meant for shared caches and wins over max-age
+    time_t max_age = directive_seconds(cache_control, "s-maxage");
+    if (max_age < 0) {
+        max_age = directive_seconds(cache_control, "max-age");
+    }
+    if (max_age >= 0) {
+        return max_age;
+    }
+
+    std::string expires = header_value(head, "expires");
+    if (expires != "") {
+        std::tm tm = {};
+        if (strptime(expires.c_str(), "%a, %d %b %Y %H:%M:%S gmt", &tm) == nullptr) {
+            return 0;
+        }
+        return std::max<time_t>(0, timegm(&tm) - now);
+    }
+
+    return valid;
+}
+
+bool Cache::read(const std::string& path, const std::string& key, std::string& response)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string   stored;
+    if (!std::getline(file, stored) || stored != key) {
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    response = buffer.str();
+    return true;
+}
+
+bool Cache::write(const std::string& key, const std::string& response) const
+{
+    // Write to a temporary file first so readers never see a partial response
+    std::string path = this->path(key);
+    std::string tmp  = path + ".tmp";
+    int         fd   = open(tmp.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return false;
+    }
+
+    std::string head    = key + "\n";
+    iovec       iov[2]  = {{head.data(), head.size()},
+                           {const_cast<char*>(response.data()), response.size()}};
+    ssize_t     written = ::writev(fd, iov, 2);
+    close(fd);
+    if (written != static_cast<ssize_t>(head.size() + response.size()) ||
+        std::rename(tmp.c_str(), path.c_str()) == -1) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Cache::evict(Entries::iterator it)
+{
+    Entry& entry = it->second;
+    if (entry.path != "") {
+        std::remove(entry.path.c_str());
+        _size -= entry.size;
+        _lru.erase(entry.lru);
+    }
+
+    if (entry.locked) {
+        entry        = Entry();
+        entry.locked = true;
+    } else {
+        _entries.erase(it);
+    }
+}
+
+void Cache::shrink()
+{
+    while (_size > _max_size && !_lru.empty()) {
+        this->evict(_entries.find(_lru.back()));
+    }
+}
+
+std::string Cache::path(const std::string& key) const
+{
+    std::stringstream name;
+    name << std::hex << std::hash<std::string>{}(key);
+    return _dir + "/" + name.str();
+}
+
+Cache::Registry& Cache::registry()
+{
+    static Registry registry;
+    return registry;
+}
+}  // namespace webserv::http
@@ -0,0 +1,206 @@
+#include "http/Headers.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "http/Response.hpp"
+
+namespace webserv::http
+{
+using StatusCode = Response::StatusCode;
+
+namespace
+{
+/// The lowercase names of the well-known headers, in the order of their ids
+constexpr std::string_view NAMES[] = {
+    "host",
+    "connection",
+    "keep-alive",
+    "content-length",
+    "content-type",
+    "transfer-encoding",
+    "accept",
+    "accept-encoding",
+    "accept-language",
+    "user-agent",
+    "referer",
+    "cookie",
+    "authorization",
+    "cache-control",
+    "pragma",
+    "origin",
+    "upgrade",
+    "if-modified-since",
+    "if-none-match",
+    "proxy-connection",
+    "x-forwarded-for",
+};
+static_assert(std::size(NAMES) == static_cast<size_t>(Header::OTHER));
+
+/// @brief Returns bit 0x20 of each byte holding a lowercase letter
+///
+/// Lowercase letters are the only bytes of a name with bit 0x40 set, digits
+/// and '-' don't have it
+constexpr uint64_t letter_bits(uint64_t lower)
+{
+    return (lower & 0x4040404040404040) >> 1;
+}
+
+/// @brief Compares a name to a lowercase one, ignoring the case of the first
+///
+/// Setting bit 0x20 turns uppercase letters into lowercase ones, and it is
+/// only set where the lowercase name has a letter, so the other characters
+/// must match exactly. Compares 8 bytes at a time.
+bool equals_lower(std::string_view name, std::string_view lower)
+{
+    if (name.size() != lower.size()) {
+        return false;
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= name.size(); i += 8) {
+        uint64_t word, lower_word;
+        std::memcpy(&word, name.data() + i, 8);
+        std::memcpy(&lower_word, lower.data() + i, 8);
+        if ((word | letter_bits(lower_word)) != lower_word) {
+            return false;
+        }
+    }
+    for (; i < name.size(); ++i) {
+        auto c       = static_cast<unsigned char>(name[i]);
+        auto lower_c = static_cast<unsigned char>(lower[i]);
+        if ((c | letter_bits(lower_c)) != lower_c) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Removes the spaces and tabs around a string
+std::string_view trim(std::string_view str)
+{
+    size_t start = str.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return str.substr(str.size());
+    }
+    return str.substr(start, str.find_last_not_of(" \t") - start + 1);
+}
+}  // namespace
+
+Headers::Headers(std::pmr::memory_resource* resource) : _overflow(resource)
+{
+}
+
+void Headers::parse(std::string_view block)
+{
+    if (block.size() > std::numeric_limits<uint16_t>::max()) {
+        throw StatusCode::REQUEST_ENTITY_TOO_LARGE;
+    }
+    _base    = block.data();
+    _size    = 0;
+    _present = 0;
+    _overflow.clear();
+
+    while (!block.empty()) {
+        size_t           line_end = std::min(block.find('\n'), block.size());
+        std::string_view line     = block.substr(0, line_end);
+        block.remove_prefix(std::min(line_end + 1, block.size()));
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            break;
+        }
+
+        size_t colon_pos = line.find(':');
+        if (colon_pos == std::string_view::npos) {
+            throw StatusCode::BAD_REQUEST;
+        }
+        this->add(line.substr(0, colon_pos), trim(line.substr(colon_pos + 1)));
+    }
+}
+
+std::optional<std::string_view> Headers::find(Header id) const
+{
+    if (!this->contains(id)) {
+        return std::nullopt;
+    }
+    for (size_t i = _size; i-- > 0;) {
+        const Slot& slot = this->slot(i);
+        if (slot.id == id) {
+            return std::string_view(_base + slot.value_offset, slot.value_size);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string_view> Headers::find(std::string_view name) const
+{
+    Header id = lookup(name);
+    if (id != Header::OTHER) {
+        return this->find(id);
+    }
+    for (size_t i = _size; i-- > 0;) {
+        const Slot& slot = this->slot(i);
+        if (slot.id == Header::OTHER &&
+            equals_lower(std::string_view(_base + slot.name_offset, slot.name_size), name)) {
+            return std::string_view(_base + slot.value_offset, slot.value_size);
+        }
+    }
+    return std::nullopt;
+}
+
+Headers::Field Headers::operator[](size_t index) const
+{
+    const Slot& slot = this->slot(index);
+    return {
+        slot.id,
+        slot.id != Header::OTHER ? name(slot.id)
+                                 : std::string_view(_base + slot.name_offset, slot.name_size),
+        std::string_view(_base + slot.value_offset, slot.value_size),
+    };
+}
+
+Header Headers::lookup(std::string_view name)
+{
+    for (size_t id = 0; id < std::size(NAMES); ++id) {
+        if (equals_lower(name, NAMES[id])) {
+            return static_cast<Header>(id);
+        }
+    }
+    return Header::OTHER;
+}
+
+std::string_view Headers::name(Header id)
+{
+    return NAMES[static_cast<size_t>(id)];
+}
+
+const Headers::Slot& Headers::slot(size_t index) const
+{
+    return index < INLINE_FIELDS ? _inline[index] : _overflow[index - INLINE_FIELDS];
+}
+
+void Headers::add(std::string_view name, std::string_view value)
+{
+    Header id = lookup(name);
+    Slot   slot{
+        static_cast<uint16_t>(name.data() - _base),
+        static_cast<uint16_t>(name.size()),
+        static_cast<uint16_t>(value.data() - _base),
+        static_cast<uint16_t>(value.size()),
+        id,
+    };
+
+    if (_size < INLINE_FIELDS) {
+        _inline[_size] = slot;
+    } else {
+        _overflow.push_back(slot);
+    }
+    ++_size;
+    if (id != Header::OTHER) {
+        _present |= 1u << static_cast<int>(id);
+    }
+}
+}  // namespace webserv::http
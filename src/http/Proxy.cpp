@@ -0,0 +1,366 @@
+#include "http/Proxy.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "async/Poller.hpp"
+#include "utils/Format.hpp"
+
+#ifndef BUFFER_SIZE
+#define BUFFER_SIZE 4096
+#endif
+
+namespace webserv::http
+{
+using async::Poller;
+
+namespace
+{
+/// Replaces all occurrences of `variable` in `str` with `value`
+void expand(std::string& str, std::string_view variable, std::string_view value)
+{
+    size_t pos = 0;
+    while ((pos = str.find(variable, pos)) != std::string::npos) {
+        str.replace(pos, variable.size(), value);
+        pos += value.size();
+    }
+}
+}  // namespace
+
+Proxy::Proxy(const Request& request, const std::string& target)
+    : _state(State::IDLE),
+      _request(request),
+      _upstream(Upstream::find(upstream_name(target))),
+      _peer(nullptr),
+      _fd(-1),
+      _reused(false),
+      _tries(0),
+      _bytes_written(0),
+      _header_end(std::string::npos),
+      _framing(Framing::CLOSE),
+      _content_length(0),
+      _chunk_pos(0),
+      _keep_alive(false)
+{
+    _request_str = this->serialize();
+}
+
+Proxy::~Proxy()
+{
+    if (_fd != -1) {
+        this->release(false);
+    }
+}
+
+Proxy::State Proxy::state() const
+{
+    return _state;
+}
+
+std::string Proxy::upstream_name(const std::string& target)
+{
+    std::string name = target;
+
+    if (name.starts_with("http://")) {
+        name = name.substr(7);
+    }
+    return name.substr(0, name.find('/'));
+}
+
+Promise<std::string> Proxy::get_output()
+{
+    this->connect();
+
+    return Promise<std::string>([this]() -> std::optional<std::string> {
+        if (_state == State::CONNECT) {
+            this->connected().then([this](int error) {
+                if (error != 0) {
+                    this->fail();
+                    return;
+                }
+                _state = State::WRITE;
+            });
+        }
+        if (_state == State::WRITE) {
+            this->write().then([this](ssize_t bytes_written) {
+                if (bytes_written <= 0) {
+                    this->fail();
+                    return;
+                }
+                _bytes_written += bytes_written;
+                if (_bytes_written == _request_str.size()) {
+                    _state = State::READ;
+                }
+            });
+        }
+        if (_state == State::READ) {
+            this->read().then([this](ssize_t bytes_read) {
+                if (bytes_read <= 0) {
+                    // Without a length the upstream marks the end by closing
+                    if (bytes_read == 0 && _header_end != std::string::npos &&
+                        _framing == Framing::CLOSE) {
+                        this->finish(false);
+                    } else {
+                        this->fail();
+                    }
+                    return;
+                }
+
+                if (_output.size() > MAX_RESPONSE_SIZE) {
+                    this->abort();
+                } else if (this->complete()) {
+                    this->finish(_keep_alive);
+                }
+            });
+        }
+        if (_state == State::DONE || _state == State::FAILED) {
+            return std::move(_output);
+        }
+        return std::nullopt;
+    });
+}
+
+void Proxy::connect()
+{
+    size_t max_tries = _upstream ? _upstream->get_peers().size() + 1 : 0;
+
+    while (_tries++ < max_tries) {
+        _peer = _upstream->select(this->hash_key());
+        if (_peer == nullptr) {
+            break;
+        }
+
+        _fd = _upstream->connect(*_peer, _reused);
+        if (_fd != -1) {
+            _bytes_written = 0;
+            _output.clear();
+            _header_end = std::string::npos;
+            _state      = _reused ? State::WRITE : State::CONNECT;
+            return;
+        }
+        _upstream->failure(*_peer);
+    }
+
+    _output.clear();
+    _state = State::FAILED;
+}
+
+void Proxy::fail()
+{
+    // An idle connection closed by the upstream is not the peer's fault
+    bool stale = _reused && _output.empty();
+
+    if (!stale) {
+        _upstream->failure(*_peer);
+    }
+    this->release(false);
+
+    // Only retry if the upstream can't have acted on the request yet
+    if (stale || _bytes_written == 0) {
+        this->connect();
+    } else {
+        _output.clear();
+        _state = State::FAILED;
+    }
+}
+
+void Proxy::abort()
+{
+    this->release(false);
+    _output.clear();
+    _state = State::FAILED;
+}
+
+void Proxy::finish(bool keep_alive)
+{
+    _upstream->success(*_peer);
+    this->release(keep_alive);
+    _state = State::DONE;
+}
+
+void Proxy::release(bool keep_alive)
+{
+    Poller::instance().remove(_fd);
+    _upstream->release(*_peer, _fd, keep_alive);
+    _fd = -1;
+}
+
+std::string Proxy::serialize() const
+{
+    std::string str = utils::format("{} {}", _request.method_str(), _request.get_uri());
+    if (!_request.get_query().empty()) {
+        utils::format_to(str, "?{}", _request.get_query());
+    }
+    str += " HTTP/1.1\r\n";
+
+    for (const auto& [id, key, value] : _request.get_headers()) {
+        // Hop-by-hop headers and framing are set by the proxy
+        if (id == Header::CONNECTION || id == Header::KEEP_ALIVE ||
+            id == Header::TRANSFER_ENCODING || id == Header::CONTENT_LENGTH ||
+            id == Header::PROXY_CONNECTION) {
+            continue;
+        }
+        utils::format_to(str, "{}: {}\r\n", key, value);
+    }
+
+    // The body is already unchunked
+    if (!_request.body().empty() || _request.get_method() == Request::Method::POST) {
+        str += "content-length: " + std::to_string(_request.body().size()) + "\r\n";
+    }
+    str += "connection: keep-alive\r\n\r\n";
+    str += _request.body();
+
+    return str;
+}
+
+std::string Proxy::hash_key() const
+{
+    std::string key = _upstream->get_hash_key();
+
+    std::string request_uri(_request.get_uri());
+    if (!_request.get_query().empty()) {
+        utils::format_to(request_uri, "?{}", _request.get_query());
+    }
+
+    expand(key, "$request_uri", request_uri);
+    expand(key, "$uri", _request.get_uri());
+    expand(key, "$args", _request.get_query());
+    expand(key, "$host", _request.host());
+
+    return key;
+}
+
+void Proxy::parse_head()
+{
+    std::string head = _output.substr(0, _header_end);
+    std::transform(head.begin(), head.end(), head.begin(), ::tolower);
+
+    // Responses without a body
+    std::string status = head.substr(head.find(' ') + 1, 3);
+    if (status == "204" || status == "304" || status.starts_with('1')) {
+        _framing        = Framing::LENGTH;
+        _content_length = 0;
+    } else if (head.find("\r\ntransfer-encoding: chunked") != std::string::npos) {
+        _framing   = Framing::CHUNKED;
+        _chunk_pos = _header_end + 4;
+    } else if (size_t pos = head.find("\r\ncontent-length:"); pos != std::string::npos) {
+        _framing        = Framing::LENGTH;
+        _content_length = std::strtoul(head.c_str() + pos + 17, nullptr, 10);
+    } else {
+        _framing = Framing::CLOSE;
+    }
+
+    _keep_alive = _framing != Framing::CLOSE && head.starts_with("http/1.1") &&
+                  head.find("\r\nconnection: close") == std::string::npos;
+}
+
+bool Proxy::complete()
+{
+    if (_header_end == std::string::npos) {
+        _header_end = _output.find("\r\n\r\n");
+        if (_header_end == std::string::npos) {
+            return false;
+        }
+        this->parse_head();
+    }
+
+    switch (_framing) {
+    case Framing::LENGTH:
+        return _output.size() >= _header_end + 4 + _content_length;
+    case Framing::CHUNKED:
+        // Skip over the complete chunks read so far
+        while (true) {
+            size_t line_end = _output.find("\r\n", _chunk_pos);
+            if (line_end == std::string::npos) {
+                return false;
+            }
+
+            size_t chunk_size = std::strtoul(_output.c_str() + _chunk_pos, nullptr, 16);
+            if (chunk_size == 0) {
+                // The last chunk is followed by optional trailers and an empty line
+                return _output.compare(line_end + 2, 2, "\r\n") == 0 ||
+                       _output.find("\r\n\r\n", line_end) != std::string::npos;
+            }
+            if (_output.size() < line_end + 2 + chunk_size + 2) {
+                return false;
+            }
+            _chunk_pos = line_end + 2 + chunk_size + 2;
+        }
+    default:
+        return false;
+    }
+}
+
+Promise<int> Proxy::connected()
+{
+    return Promise<int>(
+        [this]() -> std::optional<int> {
+            int       error = 0;
+            socklen_t len   = sizeof(error);
+            if (getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &len) == -1) {
+                return errno;
+            }
+            if (error != 0) {
+                return error;
+            }
+
+            // Still connecting until the socket has a peer
+            sockaddr_in addr;
+            socklen_t   addr_len = sizeof(addr);
+            if (getpeername(_fd, (sockaddr*)&addr, &addr_len) == -1) {
+                return std::nullopt;
+            }
+            return 0;
+        },
+        _fd,
+        async::Event::WRITABLE);
+}
+
+Promise<ssize_t> Proxy::read()
+{
+    return Promise<ssize_t>(
+        [this]() -> std::optional<ssize_t> {
+            // Drained into the output, the loop only gets back to the socket after a wait
+            size_t  start      = _output.size();
+            ssize_t bytes_read = 0;
+            while (_output.size() <= MAX_RESPONSE_SIZE) {
+                size_t size = _output.size();
+                _output.resize(size + BUFFER_SIZE);
+                bytes_read = ::recv(_fd, _output.data() + size, BUFFER_SIZE, 0);
+                _output.resize(size + std::max<ssize_t>(bytes_read, 0));
+                if (bytes_read <= 0) {
+                    break;
+                }
+            }
+            if (_output.size() > start) {
+                return _output.size() - start;
+            }
+            if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return std::nullopt;
+            }
+            return bytes_read;
+        },
+        _fd,
+        async::Event::READABLE);
+}
+
+Promise<ssize_t> Proxy::write()
+{
+    return Promise<ssize_t>(
+        [this]() -> std::optional<ssize_t> {
+            ssize_t bytes_written = ::send(_fd,
+                                           _request_str.data() + _bytes_written,
+                                           _request_str.size() - _bytes_written,
+                                           MSG_NOSIGNAL);
+            if (bytes_written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return std::nullopt;
+            }
+            return bytes_written;
+        },
+        _fd,
+        async::Event::WRITABLE);
+}
+}  // namespace webserv::http
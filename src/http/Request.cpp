@@ -1,39 +1,96 @@
 #include "http/Request.hpp"
 
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 
 #include "http/Response.hpp"
+#include "utils/StaticMap.hpp"
 
 namespace webserv::http
 {
 using StatusCode = Response::StatusCode;
 
+namespace
+{
 // clang-format off
-const Request::MethodMap Request::METHOD_MAP = {
-    {"GET",    Method::GET},
-    {"POST",   Method::POST},
-    {"DELETE", Method::DELETE},
-};
+constexpr auto METHOD_MAP = utils::make_static_map<Request::Method>({
+    {"GET",    Request::Method::GET},
+    {"POST",   Request::Method::POST},
+    {"DELETE", Request::Method::DELETE},
+});
 // clang-format on
 
-Request::Request(const std::string& input) : _content_length(0), _chunked(false)
+/// @brief Removes the next token, separated by spaces, from the start of a string
+std::string_view next_token(std::string_view& str)
+{
+    size_t start = std::min(str.find_first_not_of(' '), str.size());
+    size_t end   = std::min(str.find(' ', start), str.size());
+
+    std::string_view token = str.substr(start, end - start);
+    str.remove_prefix(end);
+    return token;
+}
+
+/// @brief Decodes the percent-encoded octets of a URI path
+///
+/// The path is appended to a root, so it may not leave it through a `..`
+/// segment. An encoded `/` would turn one segment into several and change
+/// the location the path matches.
+///
+/// @throw StatusCode 400 if an octet is malformed or decodes to NUL or `/`,
+///        or a segment is `..`
+void decode_path(std::pmr::string& out, std::string_view uri)
+{
+    out.reserve(uri.size());
+    for (size_t i = 0; i < uri.size(); ++i) {
+        if (uri[i] != '%') {
+            out += uri[i];
+            continue;
+        }
+        unsigned char c = 0;
+        if (i + 2 >= uri.size() ||
+            std::from_chars(uri.data() + i + 1, uri.data() + i + 3, c, 16).ptr !=
+                uri.data() + i + 3 ||
+            c == '\0' || c == '/') {
+            throw StatusCode::BAD_REQUEST;
+        }
+        out += static_cast<char>(c);
+        i += 2;
+    }
+
+    std::string_view path = out;
+    while (!path.empty()) {
+        size_t end = std::min(path.find('/'), path.size());
+        if (path.substr(0, end) == "..") {
+            throw StatusCode::BAD_REQUEST;
+        }
+        path.remove_prefix(std::min(end + 1, path.size()));
+    }
+}
+}  // namespace
+
+Request::Request(std::string_view input, std::pmr::memory_resource* resource)
+    : _uri(resource),
+      _path(resource),
+      _query(resource),
+      _headers(resource),
+      _content_length(0),
+      _chunked(false)
 {
     size_t headers_start = input.find("\r\n");
     size_t headers_end   = input.find("\r\n\r\n");
-    if (headers_start == std::string::npos || headers_end == std::string::npos) {
+    if (headers_start == std::string_view::npos || headers_end == std::string_view::npos) {
         throw StatusCode::BAD_REQUEST;
     }
 
-    std::string line = input.substr(0, headers_start);
-    parse_line(line);
-
-    std::string headers = input.substr(headers_start + 2, headers_end - headers_start);
-    parse_headers(headers);
+    parse_line(input.substr(0, headers_start));
+    parse_headers(input.substr(headers_start + 2, headers_end - headers_start));
 
     // Add remaining data as the body
+    _body.reserve(std::min(_content_length, BODY_RESERVE_LIMIT));
     if (this->chunked() || _content_length > 0 && input.size() > headers_end + 4) {
-        _body = input.substr(headers_end + 4);
+        _body.append(input.substr(headers_end + 4));
     }
 }
 
@@ -42,38 +99,45 @@ Request::Method Request::get_method() const
     return _method;
 }
 
-const std::string& Request::method_str() const
+std::string_view Request::method_str() const
 {
-    static const std::map<Method, std::string> METHOD_STR = {
-        {Method::GET, "GET"},
-        {Method::POST, "POST"},
-        {Method::DELETE, "DELETE"},
-    };
-
-    return METHOD_STR.at(_method);
+    switch (_method) {
+        case Method::GET:
+            return "GET";
+        case Method::POST:
+            return "POST";
+        case Method::DELETE:
+            return "DELETE";
+    }
+    return "";
 }
 
-const Request::Headers& Request::get_headers() const
+const Headers& Request::get_headers() const
 {
     return _headers;
 }
 
-const std::string& Request::get_uri() const
+std::string_view Request::get_uri() const
 {
     return _uri;
 }
 
-const std::string& Request::get_query() const
+std::string_view Request::get_path() const
+{
+    return _path;
+}
+
+std::string_view Request::get_query() const
 {
     return _query;
 }
 
-const std::string& Request::host() const
+std::string_view Request::host() const
 {
-    return _headers.at("host");
+    return *_headers.find(Header::HOST);
 }
 
-const std::string& Request::body() const
+std::string_view Request::body() const
 {
     return _body;
 }
@@ -88,115 +152,98 @@ bool Request::chunked() const
     return _chunked;
 }
 
-void Request::append_body(const std::string& body)
+void Request::append_body(std::string_view body)
 {
     _body += body;
 }
 
 void Request::unchunk_body()
 {
-    std::istringstream stream(_body);
-    std::string        line;
-
-    _body.clear();
-    while (std::getline(stream, line)) {
-        // Remove any '\r' at the end of the line if present
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+    // The data never moves forward, so it is compacted in place
+    char*            out    = _body.data();
+    std::string_view chunks = _body;
+    while (!chunks.empty()) {
+        // Parse the chunk size in hexadecimal, followed by optional extensions
+        size_t line_end = std::min(chunks.find('\n'), chunks.size());
+        size_t chunk_size;
+        if (std::from_chars(chunks.data(), chunks.data() + line_end, chunk_size, 16).ec !=
+            std::errc()) {
+            break;
         }
-
-        // Parse the chunk size in hexadecimal
-        std::istringstream size_stream(line);
-        size_t             chunk_size;
-        size_stream >> std::hex >> chunk_size;
+        chunks.remove_prefix(std::min(line_end + 1, chunks.size()));
 
         // If chunk size is zero, it's the end of the chunks
-        if (chunk_size == 0)
+        if (chunk_size == 0) {
             break;
+        }
 
-        // Read the actual chunk data based on the parsed chunk size
-        std::string chunk_data(chunk_size, '\0');
-        stream.read(&chunk_data[0], chunk_size);
-
-        // Append the chunk data to the unchunked body
-        _body += chunk_data;
-
-        // Consume the trailing \r\n after each chunk data
-        stream.ignore(2);
+        // Append the chunk data, then skip the trailing \r\n
+        std::string_view chunk = chunks.substr(0, chunk_size);
+        std::memmove(out, chunk.data(), chunk.size());
+        out += chunk.size();
+        chunks.remove_prefix(std::min(chunk_size + 2, chunks.size()));
     }
+
+    _body.resize(out - _body.data());
 }
 
-void Request::parse_line(const std::string& line)
+void Request::parse_line(std::string_view line)
 {
-    std::stringstream line_stream(line);
-
-    std::string method, version;
-    line_stream >> method >> _uri >> version;
-    if (line_stream.fail()) {
+    std::string_view method  = next_token(line);
+    std::string_view uri     = next_token(line);
+    std::string_view version = next_token(line);
+    if (version.empty()) {
         throw StatusCode::BAD_REQUEST;
     }
 
     // Throws 501 (not implemented) if the method is not supported
-    auto it = METHOD_MAP.find(method);
-    if (it == METHOD_MAP.end()) {
+    const Method* found = METHOD_MAP.find(method);
+    if (found == nullptr) {
         throw StatusCode::NOT_IMPLEMENTED;
     }
-    _method = it->second;
+    _method = *found;
 
     if (version != "HTTP/1.1") {
         throw StatusCode::HTTP_VERSION_NOT_SUPPORTED;
     }
 
-    size_t query_pos = _uri.find('?');
-    if (query_pos != std::string::npos) {
-        _query = _uri.substr(query_pos + 1);
-        _uri   = _uri.substr(0, query_pos);
+    size_t query_pos = uri.find('?');
+    if (query_pos != std::string_view::npos) {
+        _query = uri.substr(query_pos + 1);
+        uri    = uri.substr(0, query_pos);
     } else {
         _query.clear();
     }
+    _uri = uri;
+    decode_path(_path, uri);
 }
 
-void Request::parse_headers(const std::string& headers)
+void Request::parse_headers(std::string_view headers)
 {
     if (headers.size() > HEADER_LIMIT) {
         throw StatusCode::REQUEST_ENTITY_TOO_LARGE;
     }
 
-    std::stringstream headers_stream(headers);
-    std::string       header;
-
-    while (std::getline(headers_stream, header, '\n')) {
-        if (header == "\r") {
-            break;
-        }
-
-        size_t colon_pos = header.find(':');
-        if (colon_pos == std::string::npos) {
-            throw StatusCode::BAD_REQUEST;
-        }
-
-        std::string key   = header.substr(0, colon_pos);
-        std::string value = header.substr(colon_pos + 2, header.size() - colon_pos - 3);
-        // field-name (key) is case-insensitive
-        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-
-        _headers[key] = value;
-    }
+    _headers.parse(headers);
 
     // Host header is mandatory
-    if (_headers.find("host") == _headers.end()) {
+    if (!_headers.contains(Header::HOST)) {
         throw StatusCode::BAD_REQUEST;
     }
 
-    try {
-        _chunked = _headers.at("transfer-encoding") == "chunked";
-    } catch (const std::exception& e) {
-        _chunked = false;
-        try {
-            _content_length = std::stoul(_headers.at("content-length"));
-        } catch (const std::exception& e) {
-            _content_length = 0;
-        }
+    if (std::optional<std::string_view> transfer_encoding =
+            _headers.find(Header::TRANSFER_ENCODING)) {
+        _chunked = *transfer_encoding == "chunked";
+        return;
+    }
+
+    std::optional<std::string_view> content_length = _headers.find(Header::CONTENT_LENGTH);
+    if (!content_length ||
+        std::from_chars(content_length->data(),
+                        content_length->data() + content_length->size(),
+                        _content_length)
+                .ec != std::errc()) {
+        _content_length = 0;
     }
 }
 }  // namespace webserv::http
@@ -5,24 +5,33 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <array>
+#include <cerrno>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 #include "http/CGI.hpp"
 #include "http/Request.hpp"
+#include "utils/Format.hpp"
+#include "utils/StaticMap.hpp"
 
 namespace webserv::http
 {
+
+namespace
+{
 // clang-format off
-const std::unordered_map<std::string, std::string> Response::CONTENT_TYPES = {
+constexpr auto CONTENT_TYPES = utils::make_static_map<std::string_view>({
     {"html",      "text/html"},
     {"css",        "text/css"},
     {"js",  "text/javascript"},
     {"txt",      "text/plain"},
 
     {"xml", "application/xml"},
+    {"json", "application/json"},
     {"x-www-form-urlencoded", "application/x-www-form-urlencoded"},
 
     {"jpeg",     "image/jpeg"},
@@ -38,30 +47,158 @@ const std::unordered_map<std::string, std::string> Response::CONTENT_TYPES = {
     {"webm",     "video/webm"},
 
     {"form-data", "multipart/form-data"},
-};
+});
 // clang-format on
 
+/// The codes of `STATUS_LINES` start at 100
+constexpr int MIN_STATUS_CODE = 100;
+
+/// Status lines indexed by code, the codes without a line are left empty
+constexpr auto STATUS_LINES = [] {
+    using StatusCode = Response::StatusCode;
+
+    // clang-format off
+    constexpr std::pair<StatusCode, std::string_view> LINES[] = {
+        { StatusCode::OK, "HTTP/1.1 200 OK\r\n" },
+        { StatusCode::CREATED, "HTTP/1.1 201 Created\r\n" },
+        { StatusCode::MOVED_PERMANENTLY, "HTTP/1.1 301 Moved Permanently\r\n" },
+        { StatusCode::BAD_REQUEST, "HTTP/1.1 400 Bad Request\r\n" },
+        { StatusCode::FORBIDDEN, "HTTP/1.1 403 Forbidden\r\n" },
+        { StatusCode::NOT_FOUND, "HTTP/1.1 404 Not Found\r\n" },
+        { StatusCode::METHOD_NOT_ALLOWED, "HTTP/1.1 405 Method Not Allowed\r\n" },
+        { StatusCode::REQUEST_ENTITY_TOO_LARGE, "HTTP/1.1 413 Request Entity Too Large\r\n" },
+        { StatusCode::INTERNAL_SERVER_ERROR, "HTTP/1.1 500 Internal Server Error\r\n" },
+        { StatusCode::NOT_IMPLEMENTED, "HTTP/1.1 501 Not Implemented\r\n" },
+        { StatusCode::BAD_GATEWAY, "HTTP/1.1 502 Bad Gateway\r\n" },
+        { StatusCode::HTTP_VERSION_NOT_SUPPORTED, "HTTP/1.1 505 HTTP Version Not Supported\r\n" },
+    };
+    // clang-format on
+
+    std::array<std::string_view, 500> lines{};
+    for (const auto& [code, line] : LINES) {
+        lines[static_cast<int>(code) - MIN_STATUS_CODE] = line;
+    }
+    return lines;
+}();
+
+/// Adds the X-Cache-Status header after the status line of a raw response
+std::string with_cache_status(std::string response, const std::string& status)
+{
+    response.insert(response.find("\r\n") + 2, "X-Cache-Status: " + status + "\r\n");
+    return response;
+}
+
+/// Reads a whole file, "" if it can't be opened
+std::string read_file(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return "";
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+}  // namespace
+
+struct Response::Job
+{
+    /// Set to what the work threw
+    StatusCode status = StatusCode::OK;
+
+    /// The opened file, closed unless it is sent
+    int   fd   = -1;
+    off_t size = 0;
+
+    /// The directory checked by the work
+    struct stat dir_stat = {};
+
+    /// A page read from a template, or a response read from the cache
+    std::string page;
+
+    Job() = default;
+    Job(Job&& other) noexcept
+        : status(other.status),
+          fd(std::exchange(other.fd, -1)),
+          size(other.size),
+          dir_stat(other.dir_stat),
+          page(std::move(other.page))
+    {
+    }
+    Job& operator=(Job&&) = delete;
+
+    ~Job()
+    {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    /// @brief Opens a regular file to be sent
+    ///
+    /// @throw StatusCode 403 if it can't be read, 404 if there is none
+    void open(const std::string& path)
+    {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw errno == EACCES ? StatusCode::FORBIDDEN : StatusCode::NOT_FOUND;
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+            close(std::exchange(fd, -1));
+            throw StatusCode::NOT_FOUND;
+        }
+        size = file_stat.st_size;
+    }
+};
+
 Response::Response(const Request& request, const Config& config, ErrorLogger& elog)
-    : _config(config), _content_length(0), _elog(elog), _cgi(nullptr)
+    : _config(config),
+      _location(nullptr),
+      _request(&request),
+      _content_length(0),
+      _cgi(nullptr),
+      _cache(nullptr),
+      _cache_locked(false),
+      _elog(elog)
 {
-    const Config& location = config.location(request.get_uri());
-    std::string   path     = location.root() + request.get_uri();
+    const ResolvedLocation& location = config.location(request.get_path()).resolved();
+    _location                        = &location;
+    std::string             path     = location.root + std::string(request.get_path());
 
-    if (request.body().size() > location.client_max_body_size()) {
+    if (request.body().size() > location.client_max_body_size) {
         throw StatusCode::REQUEST_ENTITY_TOO_LARGE;
     }
-    if (location.limit_except(request.method_str()) == false) {
+    if (!location.allows(static_cast<int>(request.get_method()))) {
         throw StatusCode::METHOD_NOT_ALLOWED;
     }
 
+    if (location.metrics_endpoint) {
+        this->code(StatusCode::OK);
+        this->header("Content-Type", "text/plain; version=0.0.4");
+        this->body(utils::Metrics::instance().str());
+        return;
+    }
+
     // Redirect if return directive is set
-    if (location.return_uri() != "") {
-        this->code(static_cast<StatusCode>(location.return_code()));
-        this->header("Location", location.return_uri());
+    if (location.return_uri != "") {
+        this->code(static_cast<StatusCode>(location.return_code));
+        this->header("Location", location.return_uri);
         this->body("");
         return;
     }
 
+    if (location.proxy_pass != "") {
+        if (location.proxy_cache != "" && request.get_method() == Request::Method::GET) {
+            _cache     = &Cache::get(location.proxy_cache, location.proxy_cache_max_size);
+            _cache_key = Cache::key(request);
+            this->from_cache();
+            return;
+        }
+        _proxy.reset(new Proxy(request, location.proxy_pass));
+        return;
+    }
+
     std::string interpreter;
     if (CGI::is_cgi_request(path, interpreter)) {
         try {
@@ -75,128 +212,89 @@ Response::Response(const Request& request, const Config& config, ErrorLogger& el
     switch (request.get_method()) {
     case Request::Method::GET:
         if (path.ends_with("/")) {
-            try {
-                this->code(StatusCode::OK);
-                this->file(path + location.index());
-            } catch (StatusCode status_code) {
-                if (location.autoindex()) {
-                    // this->code(StatusCode::OK);
-                    this->autoindex(path, request.get_uri());
-                } else {
-                    throw status_code;
-                }
-            }
+            std::string index = path + location.index;
+            this->code(StatusCode::OK);
+            this->run([index](Job& job) { job.open(index); },
+                      [this, path, index, uri = std::string(request.get_path())](Job& job) {
+                          if (job.status != StatusCode::OK && _location->autoindex) {
+                              this->autoindex(path, uri);
+                              return;
+                          }
+                          this->send(job, index);
+                      });
             break;
         }
         this->code(StatusCode::OK);
         this->file(path);
         break;
     case Request::Method::POST:
-        this->upload_file(request.get_uri(), request.body());
+        this->upload_file(request.get_path(), request.body());
         break;
     case Request::Method::DELETE:
-        this->delete_file(request.get_uri());
+        this->delete_file(std::string(request.get_path()));
         break;
     default:
         throw StatusCode::NOT_IMPLEMENTED;
     }
 }
 
-Response::Response(StatusCode code, const Config& config, ErrorLogger& elog)
-    : _config(config), _content_length(0), _elog(elog)
+Response::Response(StatusCode code, const Config& config, ErrorLogger& elog, const Request* request)
+    : _config(config),
+      _location(nullptr),
+      _request(request),
+      _content_length(0),
+      _cache(nullptr),
+      _cache_locked(false),
+      _elog(elog)
 {
-    try {
-        std::string error_page_path = config.error_page(static_cast<int>(code));
-        this->code(code);
-        const Config& location = config.location(error_page_path);
-        this->file(location.root() + error_page_path);
-    } catch (...) {
-        const std::string& code_str = code_to_string(code);
-
-        std::ifstream template_file("www/default/error.html");
-        if (!template_file.is_open()) {
-            // clang-format off
-			std::string error_page =
-			"<!DOCTYPE html>\n"
-			"<html lang=\"en-US\"><head><meta charset=\"utf-8\" />\n"
-			"    <head>\n"
-			"        <title>" + code_str + "</title>\n"
-			"    </head>\n"
-			"    <body>\n"
-			"        <h1 align=\"center\">" + code_str + "</h1>\n"
-			"        <p align=\"center\">webserv</p>\n"
-			"    </body>\n"
-			"</html>\n";
-            // clang-format on
+    _location = request != nullptr ? &config.location(request->get_path()).resolved()
+                                    : &config.resolved();
 
-            this->code(code_str);
-            this->content_type("html");
-            this->body(error_page);
-            return;
-        }
-        std::stringstream buffer;
-        buffer << template_file.rdbuf();
-
-        template_file.close();
-
-        std::string html = buffer.str();
-        size_t      pos  = html.find("{{STATUS_CODE}}");
-        html.replace(pos, 15, code_str);
+    this->error(code);
+}
 
-        this->code(code_str);
-        this->content_type("html");
-        this->body(html);
+Response::~Response()
+{
+    if (_cache_locked) {
+        _cache->unlock(_cache_key);
     }
 }
 
 Response& Response::code(StatusCode code)
 {
-    return this->code(code_to_string(code));
+    _builder.status_line(status_line(code));
+    return *this;
 }
 
 Response& Response::code(const std::string& code)
 {
-    *this << ("HTTP/1.1 ") << code << "\r\n";
+    _builder.status(code);
     return *this;
 }
 
 Response& Response::header(const std::string& key, const std::string& value)
 {
-    *this << (key.c_str()) << ": " << value << "\r\n";
+    _builder.header(key, value);
     return *this;
 }
 
 Response& Response::body(const std::string& body)
 {
     _content_length = body.size();
-    *this << ("Content-Length: ") << _content_length << "\r\n\r\n" << body;
+    _builder.body(body);
     return *this;
 }
 
 Response& Response::file(const std::string& path)
 {
-    this->file_exist(path);
-    this->file_readable(path);
-
-    std::fstream file(path);
-    if (!file.is_open()) {
-        throw StatusCode::NOT_FOUND;
-        // TODO: Throw Forbidden if no read permission
-        // This already checks in the file_exists and is_readable right?
-    }
-    std::stringstream ss;
-    ss << file.rdbuf();
-    file.close();
-
-    this->content_type(path.substr(path.find_last_of('.') + 1));
-    this->body(ss.str());
-
+    this->run([path](Job& job) { job.open(path); },
+              [this, path](Job& job) { this->send(job, path); });
     return *this;
 }
 
-Response& Response::content_type(const std::string& extension)
+Response& Response::content_type(std::string_view extension)
 {
-    this->header("Content-Type", get_content_type(extension));
+    _builder.header("Content-Type", get_content_type(extension));
 
     return *this;
 }
@@ -213,86 +311,81 @@ bool Response::is_cgi(const std::string& uri)
     return false;
 }
 
-void Response::generate_response_page(const std::string& path)
+Response& Response::upload_file(std::string_view uri, std::string_view body)
 {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        throw StatusCode::INTERNAL_SERVER_ERROR;
-    }
+    std::string_view boundary = body.substr(0, body.find("\r\n"));
+    size_t           pos      = body.find("filename=\"") + 10;
+    std::string_view filename = body.substr(pos, body.find("\"", pos) - pos);
+    std::string_view data     = body.substr(body.find("\r\n\r\n") + 4);
+    data                      = data.substr(0, data.find(boundary) - 2);
 
-    std::string html_content((std::istreambuf_iterator<char>(file)),
-                             std::istreambuf_iterator<char>());
-    file.close();
-
-    this->content_type("html");
-    this->body(html_content);
-}
-
-Response& Response::upload_file(const std::string& uri, const std::string& body)
-{
-    std::string boundary = body.substr(0, body.find("\r\n"));
-    size_t      pos      = body.find("filename=\"") + 10;
-    std::string filename = body.substr(pos, body.find("\"", pos) - pos);
-    std::string data     = body.substr(body.find("\r\n\r\n") + 4);
-    data                 = data.substr(0, data.find(boundary) - 2);
-
-    const Config& location = _config.location(uri);
+    const ResolvedLocation& location = _config.location(uri).resolved();
 
     // Check if their is an upload directory
-    std::string path = "";
-    try {
-        path = location.upload_dir() + filename;
-    } catch (...) {
+    if (location.upload_dir.empty()) {
         throw StatusCode::FORBIDDEN;
     }
+    std::string path = location.upload_dir + std::string(filename);
 
     int permissions = is_cgi(path) ? 0755 : 0644;
 
-    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, permissions);
-    if (fd == -1) {
-        throw StatusCode::INTERNAL_SERVER_ERROR;
-    }
-
-    if (::write(fd, data.c_str(), data.size()) == -1) {
-        close(fd);
-        throw StatusCode::INTERNAL_SERVER_ERROR;
-    }
-    close(fd);
-    this->code(StatusCode::CREATED);
-    try {
-        generate_response_page("www/default/upload_success.html");
-    } catch (...) {
-        this->content_type("html");
-        this->body("File uploaded successfully");
-    }
-    // TODO: after creation, status code should be 201
+    // The data is copied, the request may be gone before it is written
+    this->run(
+        [path, permissions, data = std::string(data)](Job& job) {
+            int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, permissions);
+            if (fd == -1) {
+                throw StatusCode::INTERNAL_SERVER_ERROR;
+            }
+            for (size_t written = 0; written < data.size();) {
+                ssize_t bytes = ::write(fd, data.data() + written, data.size() - written);
+                if (bytes == -1 && errno != EINTR) {
+                    close(fd);
+                    throw StatusCode::INTERNAL_SERVER_ERROR;
+                }
+                written += std::max<ssize_t>(bytes, 0);
+            }
+            close(fd);
+            job.page = read_file("www/default/upload_success.html");
+        },
+        [this](Job& job) {
+            if (job.status != StatusCode::OK) {
+                throw job.status;
+            }
+            this->code(StatusCode::CREATED);
+            this->content_type("html");
+            this->body(job.page.empty() ? "File uploaded successfully" : job.page);
+        });
     return *this;
 }
 
 Response& Response::delete_file(const std::string& uri)
 {
-    const Config& location = _config.location(uri);
-    std::string   path     = location.root() + uri;
-
-    file_exist(path);
-    file_readable(path);
+    const ResolvedLocation& location = _config.location(uri).resolved();
+    std::string             path     = location.root + uri;
 
-    if (path == location.root() + location.upload_dir()) {
+    if (path == location.root + location.upload_dir) {
         throw StatusCode::FORBIDDEN;
     }
 
-    if (std::filesystem::remove(path) == false) {
-        throw StatusCode::INTERNAL_SERVER_ERROR;
-    }
-
-    this->code(StatusCode::OK);
+    this->run(
+        [path](Job& job) {
+            file_exist(path);
+            file_readable(path);
 
-    try {
-        generate_response_page("www/default/deletion_success.html");
-    } catch (...) {
-        this->content_type("html");
-        this->body("File deleted successfully");
-    }
+            std::error_code error;
+            if (std::filesystem::remove(path, error) == false) {
+                throw StatusCode::INTERNAL_SERVER_ERROR;
+            }
+            job.page = read_file("www/default/deletion_success.html");
+        },
+        [this](Job& job) {
+            if (job.status != StatusCode::OK) {
+                throw job.status;
+            }
+            this->code(StatusCode::OK);
+            this->content_type("html");
+            this->body(job.page.empty() ? "File deleted successfully" : job.page);
+        });
     return *this;
 }
 
@@ -301,37 +394,26 @@ ssize_t Response::get_content_length() const
     return _content_length;
 }
 
-const std::string& Response::get_content_type(const std::string& extension)
+std::string_view Response::get_content_type(std::string_view extension)
 {
-    static const std::string DEFAULT_CONTENT_TYPE = "text/plain";
-
-    auto it = CONTENT_TYPES.find(extension);
-    if (it != CONTENT_TYPES.end()) {
-        return it->second;
-    } else {
-        return DEFAULT_CONTENT_TYPE;
-    }
+    const std::string_view* type = CONTENT_TYPES.find(extension);
+    return type != nullptr ? *type : "text/plain";
 }
 
-const std::string& Response::code_to_string(StatusCode code)
+std::string_view Response::code_to_string(StatusCode code)
 {
-    // clang-format off
-    static const std::unordered_map<StatusCode, std::string>  STATUS_CODES = {
-        { StatusCode::OK, "200 OK" },
-		{ StatusCode::CREATED, "201 Created" },
-        { StatusCode::MOVED_PERMANENTLY, "301 Moved Permanently" },
-        { StatusCode::BAD_REQUEST, "400 Bad Request" },
-		{ StatusCode::FORBIDDEN, "403 Forbidden" },
-        { StatusCode::NOT_FOUND, "404 Not Found" },
-        { StatusCode::METHOD_NOT_ALLOWED, "405 Method Not Allowed" },
-        { StatusCode::REQUEST_ENTITY_TOO_LARGE, "413 Request Entity Too Large" },
-        { StatusCode::INTERNAL_SERVER_ERROR, "500 Internal Server Error" },
-        { StatusCode::NOT_IMPLEMENTED, "501 Not Implemented" },
-        { StatusCode::HTTP_VERSION_NOT_SUPPORTED, "505 HTTP Version Not Supported" },
-    };
-    // clang-format on
+    // Between "HTTP/1.1 " and "\r\n"
+    std::string_view line = status_line(code);
+    return line.substr(9, line.size() - 11);
+}
 
-    return STATUS_CODES.at(code);
+std::string_view Response::status_line(StatusCode code)
+{
+    size_t index = static_cast<size_t>(static_cast<int>(code) - MIN_STATUS_CODE);
+    if (index >= STATUS_LINES.size() || STATUS_LINES[index].empty()) {
+        return status_line(StatusCode::INTERNAL_SERVER_ERROR);
+    }
+    return STATUS_LINES[index];
 }
 
 void Response::file_exist(const std::string& path)
@@ -359,9 +441,55 @@ void Response::replace_placeholder(std::string&       html,
     }
 }
 
-Promise<std::string> Response::get_output()
+Promise<ResponseBuilder*> Response::get_output()
 {
-    return Promise<std::string>([this]() -> std::optional<std::string> {
+    return Promise<ResponseBuilder*>([this]() -> std::optional<ResponseBuilder*> {
+        if (_proxy && _proxy->state() == Proxy::State::IDLE && _cache && !_cache_locked) {
+            // Another request is fetching the same response
+            this->from_cache();
+        }
+        if (_proxy) {
+            if (_proxy->state() == Proxy::State::IDLE) {
+                if (_cache && !_cache_locked) {
+                    return std::nullopt;
+                }
+
+                _proxy->get_output().then([this](const std::string& output) {
+                    if (_proxy->state() == Proxy::State::FAILED) {
+                        if (_cache_locked) {
+                            _cache->unlock(_cache_key);
+                        }
+                        this->error(StatusCode::BAD_GATEWAY);
+                    } else if (_cache_locked) {
+                        _cache->store(_cache_key, output, _location->proxy_cache_valid);
+                        _builder.raw(with_cache_status(output, "MISS"));
+                    } else {
+                        _builder.raw(output);
+                    }
+                    _cache_locked = false;
+                });
+            }
+            if (_proxy->state() != Proxy::State::DONE && _proxy->state() != Proxy::State::FAILED) {
+                return std::nullopt;
+            }
+        }
+        if (_job) {
+            if (!_job->ready()) {
+                return std::nullopt;
+            }
+            this->resume();
+        }
+        if (_autoindex) {
+            if (!_autoindex->ready()) {
+                return std::nullopt;
+            }
+            this->render_autoindex();
+        }
+        // Either may have started the next job, listing a directory or
+        // opening an error page, or found the cached response gone
+        if (_job || (_proxy && _proxy->state() == Proxy::State::IDLE)) {
+            return std::nullopt;
+        }
         if (_cgi && _cgi->state() != CGI::State::DONE) {
             if (_cgi->state() == CGI::State::IDLE) {
                 _cgi->get_output().then([this](const std::string& output) {
@@ -373,99 +501,219 @@ Promise<std::string> Response::get_output()
                 return std::nullopt;
             }
         }
-        return this->str();
+        return &_builder;
     });
 }
 
-Response& Response::autoindex_buildin(const std::string& path, const std::string& uri)
-{
-    std::string html =
-        "<!DOCTYPE html>\n"
-        "<html lang=\"en-US\"><head><meta charset=\"utf-8\" />\n"
-        "    <head>\n"
-        "		<title>Index of " +
-        uri +
-        "</title>\n"
-        "    </head>\n"
-        "    <body>\n"
-        "		<h1>Index of " +
-        uri +
-        "</h1>\n"
-        "    <ul>\n";
-
-    DIR* dir = opendir(path.c_str());
-    if (!dir) {
-        throw StatusCode::FORBIDDEN;
-    }
+std::string Response::str() const
+{
+    return _builder.str();
+}
 
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        std::string name = entry->d_name;
-        if (name == "." || name == ".." || name == ".gitignore")
-            continue;
+int Response::status() const
+{
+    return _builder.status_code();
+}
 
-        std::string entry_path = uri + name;
-        struct stat file_stat;
-        if (stat((path + "/" + name).c_str(), &file_stat) == 0) {
-            html += "<li><a href=\"" + entry_path + (S_ISDIR(file_stat.st_mode) ? "/" : "") +
-                    "\">" + name + "</a></li>\n";
+utils::AccessLog* Response::access_log() const
+{
+    return _location != nullptr ? _location->access_log : nullptr;
+}
+
+utils::Metrics::Location* Response::metrics() const
+{
+    return _location != nullptr ? &_location->metrics : nullptr;
+}
+
+void Response::from_cache()
+{
+    std::string   path;
+    Cache::Lookup lookup = _cache->lookup(_cache_key, path);
+
+    if (lookup == Cache::Lookup::MISS || lookup == Cache::Lookup::WAIT) {
+        _cache_locked = lookup == Cache::Lookup::MISS;
+        if (!_proxy) {
+            _proxy.reset(new Proxy(*_request, _location->proxy_pass));
         }
+        return;
+    }
+    if (lookup == Cache::Lookup::STALE) {
+        _cache->revalidate(
+            _cache_key, *_request, _location->proxy_pass, _location->proxy_cache_valid);
     }
-    closedir(dir);
-
-    html +=
-        "        </ul>\n"
-        "    </body>\n"
-        "</html>\n";
 
-    this->content_type("html");
-    this->body(html);
+    _proxy.reset();
+    const char* status = lookup == Cache::Lookup::HIT ? "HIT" : "STALE";
+    this->run(
+        [path, key = _cache_key](Job& job) {
+            if (!Cache::read(path, key, job.page)) {
+                throw StatusCode::NOT_FOUND;
+            }
+        },
+        [this, status](Job& job) {
+            if (job.status != StatusCode::OK) {
+                _cache->forget(_cache_key);
+                this->from_cache();
+                return;
+            }
+            _builder.raw(with_cache_status(std::move(job.page), status));
+        });
+}
 
+Response& Response::autoindex(const std::string& path, const std::string& uri)
+{
+    bool html      = Autoindex::format_of(_location->autoindex_format) == Autoindex::Format::HTML;
+    _autoindex_uri = uri;
+    this->run(
+        [path, html](Job& job) {
+            if (stat(path.c_str(), &job.dir_stat) == -1 || !S_ISDIR(job.dir_stat.st_mode)) {
+                throw StatusCode::FORBIDDEN;
+            }
+            if (html) {
+                job.page = read_file("www/default/autoindex.html");
+            }
+        },
+        [this, path](Job& job) {
+            if (job.status != StatusCode::OK) {
+                throw job.status;
+            }
+            _autoindex          = Autoindex::list(path, job.dir_stat);
+            _autoindex_template = std::move(job.page);
+        });
     return *this;
 }
 
-Response& Response::autoindex(const std::string& path, const std::string& uri)
+void Response::render_autoindex()
 {
-    // generate_response_page("www/default/autoindex.html"); (body access?)
-    std::ifstream template_file("www/default/autoindex.html");
-    if (!template_file.is_open()) {
-        return (autoindex_buildin(path, uri));
+    std::shared_ptr<const Autoindex::Scan> scan = std::move(_autoindex);
+    if (scan->listing() == nullptr) {
+        this->error(StatusCode::FORBIDDEN);
+        return;
     }
 
-    std::stringstream buffer;
-    buffer << template_file.rdbuf();
-    template_file.close();
-    std::string html = buffer.str();
+    const Autoindex::Listing& listing = *scan->listing();
+    Autoindex::Format         format  = Autoindex::format_of(_location->autoindex_format);
+    Autoindex::Page           page    = Autoindex::page_of(
+        _request != nullptr ? _request->get_query() : "", _location->autoindex_page_size);
+
+    std::string html_template = std::move(_autoindex_template);
+    this->content_type(Autoindex::extension(format));
+    if (page.size > 0) {
+        // The links reuse the URI as it was sent, still percent-encoded
+        std::string_view uri  = _request != nullptr ? _request->get_uri() : _autoindex_uri;
+        const char*      link = "<{}?page={}>; rel=\"{}\"";
+        if (page.number > 1) {
+            _builder.header("Link", utils::format(link, uri, page.number - 1, "prev"));
+        }
+        if (page.number < (listing.size() + page.size - 1) / page.size) {
+            _builder.header("Link", utils::format(link, uri, page.number + 1, "next"));
+        }
+    }
+    this->body(Autoindex::render(listing, format, _autoindex_uri, page, html_template));
+}
 
-    replace_placeholder(html, "{{URI}}", uri);
+void Response::run(JobFn work, JobFn then)
+{
+    auto job = [work = std::move(work)] {
+        Job job;
+        try {
+            work(job);
+        } catch (StatusCode status) {
+            job.status = status;
+        }
+        return job;
+    };
 
-    DIR* dir = opendir(path.c_str());
-    if (!dir) {
-        throw StatusCode::FORBIDDEN;
+    // Files in the page cache are faster to open here than to hand off
+    if (!_location->aio_threads) {
+        Job done = job();
+        try {
+            then(done);
+        } catch (StatusCode status) {
+            this->error(status);
+        }
+        return;
     }
+    _job  = async::ThreadPool::instance().run<Job>(job);
+    _then = std::move(then);
+}
 
-    std::string    entries;
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        std::string name = entry->d_name;
-        if (name == "." || name == ".." || name == ".gitignore")
-            continue;
+void Response::resume()
+{
+    std::shared_ptr<async::Task<Job>> job  = std::move(_job);
+    JobFn                             then = std::move(_then);
 
-        std::string entry_path = uri + name;
-        struct stat file_stat;
-        if (stat((path + "/" + name).c_str(), &file_stat) == 0) {
-            entries += "<li><a href=\"" + entry_path + (S_ISDIR(file_stat.st_mode) ? "/" : "") +
-                       "\">" + name + "</a></li>\n";
+    try {
+        if (job->value() == nullptr) {
+            throw StatusCode::INTERNAL_SERVER_ERROR;
         }
+        then(*job->value());
+    } catch (StatusCode status) {
+        this->error(status);
     }
-    closedir(dir);
-
-    replace_placeholder(html, "{{DIRECTORY_ENTRIES}}", entries);
+}
 
-    this->content_type("html");
-    this->body(html);
+void Response::send(Job& job, std::string_view path)
+{
+    if (job.status != StatusCode::OK) {
+        throw job.status;
+    }
 
-    return *this;
+    // The file is sent from the descriptor, without being read here
+    this->content_type(path.substr(path.find_last_of('.') + 1));
+    _content_length = job.size;
+    _builder.file(std::exchange(job.fd, -1), job.size);
 }
 
+void Response::error(StatusCode code)
+{
+    _content_length = 0;
+    this->code(code);
+
+    std::string path;
+    try {
+        std::string error_page_path = _config.error_page(static_cast<int>(code));
+        path = _config.location(error_page_path).resolved().root + error_page_path;
+    } catch (const std::exception&) {
+    }
+
+    this->run(
+        [path](Job& job) {
+            if (!path.empty()) {
+                try {
+                    job.open(path);
+                    return;
+                } catch (StatusCode) {
+                }
+            }
+            job.page = read_file("www/default/error.html");
+        },
+        [this, code, path](Job& job) {
+            if (job.fd != -1) {
+                this->send(job, path);
+                return;
+            }
+
+            std::string code_str(code_to_string(code));
+            if (job.page.empty()) {
+                // clang-format off
+			job.page =
+			"<!DOCTYPE html>\n"
+			"<html lang=\"en-US\"><head><meta charset=\"utf-8\" />\n"
+			"    <head>\n"
+			"        <title>" + code_str + "</title>\n"
+			"    </head>\n"
+			"    <body>\n"
+			"        <h1 align=\"center\">" + code_str + "</h1>\n"
+			"        <p align=\"center\">webserv</p>\n"
+			"    </body>\n"
+			"</html>\n";
+                // clang-format on
+            } else if (size_t pos = job.page.find("{{STATUS_CODE}}"); pos != std::string::npos) {
+                job.page.replace(pos, 15, code_str);
+            }
+            this->content_type("html");
+            this->body(job.page);
+        });
+}
 }  // namespace webserv::http
@@ -0,0 +1,171 @@
+#include "http/ResponseBuilder.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace webserv::http
+{
+ResponseBuilder::ResponseBuilder() : _file{-1, 0, 0}, _sent(0)
+{
+    _head.reserve(HEAD_SIZE);
+}
+
+ResponseBuilder::~ResponseBuilder()
+{
+    this->close_file();
+}
+
+ResponseBuilder::ResponseBuilder(ResponseBuilder&& other) noexcept
+    : _head(std::move(other._head)),
+      _body(std::move(other._body)),
+      _file(std::exchange(other._file, {-1, 0, 0})),
+      _sent(std::exchange(other._sent, 0))
+{
+}
+
+ResponseBuilder& ResponseBuilder::operator=(ResponseBuilder&& other) noexcept
+{
+    if (this != &other) {
+        this->close_file();
+        _head = std::move(other._head);
+        _body = std::move(other._body);
+        _file = std::exchange(other._file, {-1, 0, 0});
+        _sent = std::exchange(other._sent, 0);
+    }
+    return *this;
+}
+
+ResponseBuilder& ResponseBuilder::status_line(std::string_view line)
+{
+    this->close_file();
+    _head.assign(line);
+    _body.clear();
+    _sent = 0;
+    return *this;
+}
+
+ResponseBuilder& ResponseBuilder::status(std::string_view code)
+{
+    this->status_line("HTTP/1.1 ");
+    _head.append(code);
+    _head.append("\r\n");
+    return *this;
+}
+
+ResponseBuilder& ResponseBuilder::header(std::string_view key, std::string_view value)
+{
+    _head.append(key);
+    _head.append(": ");
+    _head.append(value);
+    _head.append("\r\n");
+    return *this;
+}
+
+ResponseBuilder& ResponseBuilder::header(std::string_view key, size_t value)
+{
+    char buffer[20];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return this->header(key, std::string_view(buffer, result.ptr));
+}
+
+ResponseBuilder& ResponseBuilder::body(std::string body)
+{
+    this->header("Content-Length", body.size());
+    _head.append("\r\n");
+    _body = std::move(body);
+    return *this;
+}
+
+ResponseBuilder& ResponseBuilder::file(int fd, size_t size)
+{
+    this->header("Content-Length", size);
+    _head.append("\r\n");
+    _body.clear();
+    this->close_file();
+    _file = {fd, 0, size};
+    return *this;
+}
+
+ResponseBuilder& ResponseBuilder::raw(std::string response)
+{
+    this->status_line("");
+    _head = std::move(response);
+    return *this;
+}
+
+int ResponseBuilder::status_code() const
+{
+    // The status code follows "HTTP/1.1 "
+    int code = 0;
+    if (_head.size() > 12) {
+        std::from_chars(_head.data() + 9, _head.data() + 12, code);
+    }
+    return code;
+}
+
+std::string ResponseBuilder::str() const
+{
+    std::string str = _head + _body;
+    if (_file.fd != -1) {
+        size_t size = str.size();
+        str.resize(size + _file.length);
+        ssize_t n = pread(_file.fd, str.data() + size, _file.length, _file.offset);
+        str.resize(size + std::max<ssize_t>(n, 0));
+    }
+    return str;
+}
+
+size_t ResponseBuilder::iovecs(iovec (&iov)[2]) const
+{
+    size_t count  = 0;
+    size_t offset = _sent;
+    for (const std::string* segment : {&_head, &_body}) {
+        if (offset < segment->size()) {
+            iov[count].iov_base = const_cast<char*>(segment->data()) + offset;
+            iov[count].iov_len  = segment->size() - offset;
+            ++count;
+        }
+        offset -= std::min(offset, segment->size());
+    }
+    return count;
+}
+
+const ResponseBuilder::FileRange* ResponseBuilder::file_range() const
+{
+    if (!this->has_file() || _sent < _head.size()) {
+        return nullptr;
+    }
+    return &_file;
+}
+
+void ResponseBuilder::advance(size_t bytes)
+{
+    size_t memory = _head.size() + _body.size();
+    if (_sent < memory) {
+        size_t from_memory = std::min(bytes, memory - _sent);
+        _sent += from_memory;
+        bytes -= from_memory;
+    }
+    // The rest was sent from the file
+    bytes = std::min(bytes, _file.length);
+    _file.offset += bytes;
+    _file.length -= bytes;
+    _sent += bytes;
+}
+
+bool ResponseBuilder::done() const
+{
+    return _sent >= _head.size() + _body.size() && !this->has_file();
+}
+
+void ResponseBuilder::close_file()
+{
+    if (_file.fd != -1) {
+        ::close(_file.fd);
+    }
+    _file = {-1, 0, 0};
+}
+}  // namespace webserv::http
@@ -1,8 +1,6 @@
-#include "config/Config.hpp"
 #include "net/Server.hpp"
 #include "utils/Logger.hpp"
 
-using webserv::config::Config;
 using webserv::net::Server;
 using webserv::utils::ErrorLogger;
 
@@ -13,13 +11,9 @@ int main(int argc, char** argv)
     const std::string& config_path = argc > 1 ? argv[1] : "conf/default.conf";
 
     try {
-        Config config(config_path);
-
-        elog.set_level(config.log_level());
-
         elog.log(ErrorLogger::INFO, "Starting webserv...");
 
-        Server server(config[Config::HTTP], elog);
+        Server server(config_path, elog);
 
         server.run();
     } catch (const std::exception& e) {
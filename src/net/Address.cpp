@@ -34,6 +34,24 @@ int Address::get_port() const
     return _port;
 }
 
+bool Address::is_any() const
+{
+    return _addr.sin_addr.s_addr == INADDR_ANY;
+}
+
+bool Address::operator==(const Address& other) const
+{
+    return _addr.sin_addr.s_addr == other._addr.sin_addr.s_addr && _port == other._port;
+}
+
+bool Address::operator<(const Address& other) const
+{
+    if (_port != other._port) {
+        return _port < other._port;
+    }
+    return ntohl(_addr.sin_addr.s_addr) < ntohl(other._addr.sin_addr.s_addr);
+}
+
 std::string Address::to_string() const
 {
     char buffer[INET_ADDRSTRLEN];
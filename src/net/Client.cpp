@@ -2,58 +2,67 @@
 
 #include <iostream>
 
+#include "async/Poller.hpp"
 #include "http/Response.hpp"
 #include "net/Server.hpp"
 #include "net/VirtualServer.hpp"
+#include "utils/Metrics.hpp"
 
 namespace webserv::net
 {
+using async::Event;
 using http::Response;
 
 Client::Client(Socket&& socket, VirtualServer& server, ErrorLogger& elog)
-    : Socket(std::move(socket)), _server(server), _elog(elog)
+    : Socket(std::move(socket)), _server(server), _elog(elog), _request_str(&_arena)
 {
 }
 
 Client::~Client()
 {
-    _elog.log(ErrorLogger::INFO, "Client disconnected from: " + _address.to_string());
+    ELOG_INFO(_elog, "Client disconnected from: {}", _address);
 }
 
 void Client::handle_connection()
 {
-    _request.reset();
+    // Everything allocated from the arena goes before it is rewound,
+    // assigning an empty string would keep the buffer
     _response.reset();
-    _request_str.clear();
-    _response_str.clear();
+    _request.reset();
+    std::pmr::string(&_arena).swap(_request_str);
+    _arena.reset();
 
     this->read_request().then([this](StatusCode status_code) {
         if (_is_connected == false) {
             return;
         }
-        _elog.log("Received request from " + get_address().to_string());
+        ELOG_DEBUG(_elog, "Received request from {}", get_address());
 
         // Create a response and send it back to the client
-        std::string host_name = "";
+        std::string_view host_name = "";
+        _generation                = _server.get_generation();
         try {
             if (status_code != StatusCode::OK) {
                 throw status_code;
             }
-            host_name = _request->host().substr(0, _request->host().find(':'));
-            _response.reset(new Response(*_request, _server.get_config(host_name), _elog));
+            host_name = _request->host();
+            host_name = host_name.substr(0, host_name.find(':'));
+            _response.reset(new Response(*_request, _server.get_config(*this, host_name), _elog));
         } catch (StatusCode status_code) {
-            _response.reset(new Response(status_code, _server.get_config(host_name), _elog));
+            _response.reset(new Response(status_code,
+                                         _server.get_config(*this, host_name),
+                                         _elog,
+                                         _request ? &*_request : nullptr));
         }
 
-        _response->get_output().then([this](const std::string& response_str) {
-            this->write(std::vector<char>(response_str.begin(), response_str.end()))
-                .then([this](ssize_t bytes_written) {
-                    _elog.log("Sent response to " + get_address().to_string() + ": " +
-                              std::to_string(bytes_written) + " bytes");
+        _response->get_output().then([this](http::ResponseBuilder* response) {
+            this->write(*response).then([this](ssize_t bytes_written) {
+                ELOG_DEBUG(_elog, "Sent response to {}: {} bytes", get_address(), bytes_written);
+                this->record(bytes_written);
 
-                    // Handle the next request and response
-                    this->handle_connection();
-                });
+                // Handle the next request and response
+                this->handle_connection();
+            });
         });
     });
 }
@@ -63,62 +72,129 @@ bool Client::is_connected() const
     return _is_connected;
 }
 
-Promise<StatusCode> Client::read_request()
+bool Client::is_idle() const
 {
-    return Promise<StatusCode>([this]() -> std::optional<StatusCode> {
-        if (this->_fd == -1) {
-            this->_is_connected = false;
-            return StatusCode::OK;
-        }
-
-        // Read data from the client's socket and append it to the request
-        this->read(_buffer).then([this](ssize_t bytes_read) {
-            if (bytes_read == 0) {
-                this->close();
-                return;
-            }
+    return !_request && _request_str.empty();
+}
 
-            if (_request) {
-                _request->append_body(std::string(_buffer.begin(), _buffer.begin() + bytes_read));
-            } else {
-                _request_str += std::string(_buffer.begin(), _buffer.begin() + bytes_read);
-            }
-            _buffer.clear();
+bool Client::is_writing() const
+{
+    return _response != nullptr;
+}
 
-            _elog.log("Received data from " + get_address().to_string() + ": " +
-                      std::to_string(bytes_read) + " bytes");
-        });
+void Client::record(ssize_t bytes_sent)
+{
+    int  status  = _response->status();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - _start);
+
+    utils::Metrics& metrics = utils::Metrics::instance();
+    metrics.add_sent(std::max<ssize_t>(bytes_sent, 0));
+    if (utils::Metrics::Location* location = _response->metrics()) {
+        metrics.record(*location, status, elapsed.count());
+    }
+
+    utils::AccessLog* access_log = _response->access_log();
+    if (access_log == nullptr) {
+        return;
+    }
+
+    // The writer thread formats the request line
+    std::string_view method, uri, query, referer, user_agent;
+    if (_request) {
+        method = _request->method_str();
+        uri    = _request->get_uri();
+        query  = _request->get_query();
+
+        const http::Headers& headers = _request->get_headers();
+        referer    = headers.find(http::Header::REFERER).value_or(std::string_view());
+        user_agent = headers.find(http::Header::USER_AGENT).value_or(std::string_view());
+    }
+
+    access_log->log(_address.get_sockaddr(),
+                    status,
+                    std::max<ssize_t>(bytes_sent, 0),
+                    elapsed.count(),
+                    method,
+                    uri,
+                    query,
+                    referer,
+                    user_agent);
+}
 
-        // Check if the request body is complete
-        if (_request) {
-            if (_request->chunked() &&
-                _request->body().find("\r\n0\r\n\r\n") != std::string::npos) {
-                _request->unchunk_body();
-                return StatusCode::OK;
-            } else {
-                if (_request->content_length() == _request->body().size()) {
+Promise<StatusCode> Client::read_request()
+{
+    return Promise<StatusCode>(
+        [this]() -> std::optional<StatusCode> {
+            // Events are edge-triggered, read until the socket is drained or the request is
+            // complete. What follows the request is left for the next one
+            while (true) {
+                std::optional<utils::BufferPool::Buffer> buffer = this->read();
+                if (!buffer) {
+                    return std::nullopt;
+                }
+                if (buffer->size() == 0) {
+                    this->disconnect();
                     return StatusCode::OK;
-                } else if (_request->content_length() < _request->body().size()) {
-                    return StatusCode::BAD_REQUEST;
+                }
+                if (this->is_idle()) {
+                    _start = std::chrono::steady_clock::now();
+                }
+                utils::Metrics::instance().add_received(buffer->size());
+
+                if (_request) {
+                    _request->append_body(buffer->view());
+                } else {
+                    _request_str.append(buffer->view());
+                }
+                ELOG_DEBUG(
+                    _elog, "Received data from {}: {} bytes", get_address(), buffer->size());
+
+                if (std::optional<StatusCode> status_code = this->parse_request()) {
+                    return status_code;
                 }
             }
+        },
+        _fd,
+        Event::RECEIVE);
+}
+
+std::optional<StatusCode> Client::parse_request()
+{
+    // Check if the request-line and headers are complete
+    if (!_request) {
+        if (_request_str.find("\r\n\r\n") == std::string::npos) {
             return std::nullopt;
         }
+        try {
+            _request.emplace(_request_str, &_arena);
+        } catch (StatusCode status_code) {
+            return status_code;
+        }
+        if (!_request->chunked() && _request->content_length() == 0) {
+            return StatusCode::OK;
+        }
+    }
 
-        // Check if the request-line and headers are complete
-        if (_request_str.find("\r\n\r\n") != std::string::npos) {
-            try {
-                _request.reset(new Request(_request_str));
-                if (_request->chunked() || _request->content_length() > 0) {
-                    return std::nullopt;
-                }
-                return StatusCode::OK;
-            } catch (StatusCode status_code) {
-                return status_code;
-            }
+    // Check if the request body is complete
+    if (_request->chunked()) {
+        if (_request->body().find("\r\n0\r\n\r\n") != std::string::npos) {
+            _request->unchunk_body();
+            return StatusCode::OK;
         }
+    } else if (_request->content_length() == _request->body().size()) {
+        return StatusCode::OK;
+    } else if (_request->content_length() < _request->body().size()) {
+        return StatusCode::BAD_REQUEST;
+    }
+    return std::nullopt;
+}
 
-        return std::nullopt;
-    });
+void Client::disconnect()
+{
+    async::Poller::instance().remove(_fd);
+    this->close();
+    _is_connected = false;
+    _server.disconnect(*this);
 }
 }  // namespace webserv::net
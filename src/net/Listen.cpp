@@ -5,37 +5,43 @@
 
 #include <stdexcept>
 
+#include "async/Poller.hpp"
+
 namespace webserv::net
 {
 using async::Event;
 
 Listen::Listen(Address address) : Socket(address)
 {
-    if (listen(_fd, 16) == -1) {
+    if (listen(_fd, SOMAXCONN) == -1) {
         throw std::runtime_error("Failed to listen on socket");
     }
 }
 
+Listen::Listen(Address address, int fd) : Socket(address, fd)
+{
+    if (fcntl(_fd, F_SETFL, O_NONBLOCK) == -1) {
+        throw std::runtime_error("Failed to set O_NONBLOCK on inherited socket");
+    }
+}
+
 Promise<Socket> Listen::accept()
 {
     return Promise<Socket>(
         [this]() -> std::optional<Socket> {
             sockaddr_in accepted_addr;
-            socklen_t   addr_len = sizeof(accepted_addr);
 
-            int fd = ::accept(_fd, (sockaddr*)&accepted_addr, &addr_len);
+            // Connections must not leak into CGI scripts or an upgraded binary
+            int fd = async::Poller::instance().accept(_fd, accepted_addr);
             if (fd == -1) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
                     return std::nullopt;
                 }
                 throw std::runtime_error("Failed to accept connection");
             }
-            if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1) {
-                throw std::runtime_error("Failed to set O_NONBLOCK on accepted socket");
-            }
             return Socket(Socket(Address(accepted_addr), fd));
         },
         _fd,
-        Event::READABLE);
+        Event::ACCEPT);
 }
 }  // namespace webserv::net
@@ -1,42 +1,472 @@
 #include "net/Server.hpp"
 
 #include <fcntl.h>
+#include <signal.h>
 #include <sys/epoll.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <set>
+#include <sstream>
 
 #include "async/Poller.hpp"
+#include "http/Proxy.hpp"
+#include "utils/std_utils.hpp"
 
 namespace webserv::net
 {
+using async::Event;
 using async::Poller;
 
-Server::Server(const Config& config, ErrorLogger& elog) : _config(config), _elog(elog)
+namespace
 {
-    for (auto it = config.begin(Config::Type::SERVER); it != config.end();
-         it      = it.next(Config::Type::SERVER)) {
-        if (_virtual_servers.find(it->port()) == _virtual_servers.end()) {
-            _virtual_servers[it->port()] = std::make_unique<VirtualServer>(
-                Address(it->host(), it->port()), it->server_name(), elog);
+/// Reads the arguments this process was started with
+std::vector<std::string> command_line()
+{
+    std::ifstream            file("/proc/self/cmdline", std::ios::binary);
+    std::vector<std::string> args;
+    std::string              arg;
+    while (std::getline(file, arg, '\0')) {
+        args.push_back(arg);
+    }
+    return args;
+}
+
+/// Finds the file `execvp` would run for a command
+std::string executable_path(const std::string& command)
+{
+    if (command.find('/') != std::string::npos) {
+        return command;
+    }
+
+    const char*       path = getenv("PATH");
+    std::stringstream dirs(path != nullptr ? path : "/usr/local/bin:/usr/bin:/bin");
+    std::string       dir;
+    while (std::getline(dirs, dir, ':')) {
+        std::string file = (dir.empty() ? "." : dir) + "/" + command;
+        if (access(file.c_str(), X_OK) == 0) {
+            return file;
+        }
+    }
+    return command;
+}
+
+/// Returns the environment of this process without the given variables
+std::vector<std::string> environment_without(const std::vector<std::string_view>& names)
+{
+    std::vector<std::string> env;
+    for (char** var = environ; *var != nullptr; ++var) {
+        std::string_view entry(*var);
+        if (!utils::contains(names, entry.substr(0, entry.find('=')))) {
+            env.emplace_back(entry);
+        }
+    }
+    return env;
+}
+
+/// Closes every file descriptor above stderr except the ones to keep
+void close_other_fds(std::vector<int> keep)
+{
+    std::sort(keep.begin(), keep.end());
+
+    unsigned int from = STDERR_FILENO + 1;
+    for (int fd : keep) {
+        if (static_cast<unsigned int>(fd) > from) {
+            close_range(from, fd - 1, 0);
         }
-        _virtual_servers[it->port()]->add_config(*it);
+        from = std::max(from, static_cast<unsigned int>(fd) + 1);
     }
+    close_range(from, ~0U, 0);
+}
+}  // namespace
+
+Server::Server(const std::string& config_path, ErrorLogger& elog)
+    : _config_path(config_path),
+      _elog(elog),
+      _reload(SIGHUP),
+      _upgrade(SIGUSR2),
+      _terminate(SIGTERM),
+      _upgrading(false),
+      _terminating(false)
+{
+    // Unlike send, sendfile can't be told not to raise it on a closed connection
+    signal(SIGPIPE, SIG_IGN);
+
+    auto config = std::make_shared<const Config>(config_path);
+
+    _elog.set_level(config->log_level());
+    this->inherit();
+    this->apply(config);
+    this->notify_ready();
+
+    this->wait_reload();
+    this->wait_upgrade();
+    this->wait_terminate();
+
+    utils::Metrics::instance().set_connections([this] {
+        utils::Metrics::Connections connections;
+        for (const auto& server : _virtual_servers) {
+            server.second->count_connections(connections);
+        }
+        for (const auto& server : _draining) {
+            server->count_connections(connections);
+        }
+        return connections;
+    });
+}
+
+Server::~Server()
+{
+    utils::Metrics::instance().set_connections(nullptr);
+    Poller::instance().set_slow_callback(std::chrono::microseconds(0), nullptr);
 }
 
 void Server::run()
 {
-    while (true) {
+    while (!_terminating && (!_virtual_servers.empty() || !_draining.empty())) {
         for (const auto& server : _virtual_servers) {
             server.second->listen();
         }
 
+        // Let the clients of removed addresses finish
+        for (auto it = _draining.begin(); it != _draining.end();) {
+            (*it)->listen();
+            if ((*it)->is_drained()) {
+                it = _draining.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        _elog.flush();
         Poller::instance().poll();
     }
 }
 
 const Config& Server::get_config() const
 {
-    return _config;
+    return (*_config)[Config::HTTP];
+}
+
+void Server::reload()
+{
+    if (_upgrading) {
+        _elog.log(ErrorLogger::WARNING, "Ignoring reload during an upgrade");
+        return;
+    }
+    ELOG_INFO(_elog, "Reloading configuration from {}", _config_path);
+
+    try {
+        this->apply(std::make_shared<const Config>(_config_path));
+    } catch (const std::exception& e) {
+        ELOG_ERROR(_elog, "Keeping the running configuration: {}", e.what());
+        return;
+    }
+
+    _elog.log(ErrorLogger::INFO, "Configuration reloaded");
+}
+
+void Server::apply(std::shared_ptr<const Config> config)
+{
+    const Config&      http      = (*config)[Config::HTTP];
+    Upstream::Registry upstreams = Server::upstreams(http);
+    Bindings           bindings  = Server::bindings(http);
+    Poller::Engine     engine    = Poller::engine_of(config->event_engine());
+
+    // Bind the new addresses first, so a failure leaves the running config untouched
+    VirtualServers added;
+    for (const auto& [socket, _] : bindings) {
+        if (_virtual_servers.find(socket) != _virtual_servers.end()) {
+            continue;
+        }
+
+        auto inherited = _inherited.find(socket);
+        if (inherited != _inherited.end()) {
+            added.emplace(socket,
+                          std::make_unique<VirtualServer>(socket, inherited->second, _elog));
+            _inherited.erase(inherited);
+        } else {
+            added.emplace(socket, std::make_unique<VirtualServer>(socket, _elog));
+        }
+    }
+
+    // The last step that can fail, the running config is left as is until here
+    _elog.set_file(config->error_log());
+
+    for (auto it = _virtual_servers.begin(); it != _virtual_servers.end();) {
+        if (bindings.find(it->first) == bindings.end()) {
+            it->second->stop();
+            _draining.push_back(std::move(it->second));
+            it = _virtual_servers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _virtual_servers.merge(added);
+
+    for (const auto& [socket, socket_bindings] : bindings) {
+        VirtualServer& virtual_server = *_virtual_servers.at(socket);
+
+        virtual_server.set_generation(config);
+        for (const auto& binding : socket_bindings) {
+            virtual_server.add_config(binding.address, *binding.server, binding.default_server);
+        }
+    }
+
+    // Requests in flight keep the upstreams they picked
+    Upstream::registry() = std::move(upstreams);
+
+    _elog.set_level(config->log_level());
+    Poller::instance().set_slow_callback(
+        std::chrono::milliseconds(config->slow_callback_threshold()),
+        [this](int fd, const sockaddr_in* peer, std::chrono::microseconds duration) {
+            this->log_slow_callback(fd, peer, duration);
+        });
+    Poller::Engine previous = Poller::instance().get_engine();
+    Poller::Engine used     = Poller::instance().set_engine(engine);
+    if (used != engine) {
+        ELOG_WARNING(_elog,
+                     "{} isn't supported by the kernel, using {}",
+                     Poller::name(engine),
+                     Poller::name(used));
+    } else if (used != previous) {
+        ELOG_INFO(_elog, "Using the {} event engine", Poller::name(used));
+    }
+    _config = std::move(config);
+}
+
+Upstream::Registry Server::upstreams(const Config& http)
+{
+    Upstream::Registry registry;
+
+    for (auto it = http.begin(Config::Type::UPSTREAM); it != http.end();
+         it      = it.next(Config::Type::UPSTREAM)) {
+        auto upstream                  = std::make_shared<Upstream>(*it);
+        registry[upstream->get_name()] = std::move(upstream);
+    }
+
+    // `proxy_pass` targets that don't name an upstream are addresses
+    for (auto server = http.begin(Config::Type::SERVER); server != http.end();
+         server      = server.next(Config::Type::SERVER)) {
+        for (auto location = server->begin(Config::Type::LOCATION); location != server->end();
+             location      = location.next(Config::Type::LOCATION)) {
+            if (location->proxy_pass() == "") {
+                continue;
+            }
+
+            std::string name = http::Proxy::upstream_name(location->proxy_pass());
+            if (registry.find(name) == registry.end()) {
+                registry[name] =
+                    std::make_shared<Upstream>(name, Upstream::parse_address(name));
+            }
+        }
+    }
+
+    return registry;
+}
+
+Server::Bindings Server::bindings(const Config& http)
+{
+    std::set<Address> wildcards;
+    for (auto it = http.begin(Config::Type::SERVER); it != http.end();
+         it      = it.next(Config::Type::SERVER)) {
+        for (const auto& listen : it->listens()) {
+            Address address(listen.host, listen.port);
+            if (address.is_any()) {
+                wildcards.insert(address);
+            }
+        }
+    }
+
+    Bindings bindings;
+    for (auto it = http.begin(Config::Type::SERVER); it != http.end();
+         it      = it.next(Config::Type::SERVER)) {
+        for (const auto& listen : it->listens()) {
+            Address address(listen.host, listen.port);
+
+            // A socket bound to the wildcard address of a port takes all its connections
+            Address socket(INADDR_ANY, listen.port);
+            if (wildcards.find(socket) == wildcards.end()) {
+                socket = address;
+            }
+            bindings[socket].push_back({address, &*it, listen.default_server});
+        }
+    }
+
+    return bindings;
+}
+
+void Server::upgrade()
+{
+    if (_upgrading) {
+        _elog.log(ErrorLogger::WARNING, "An upgrade is already running");
+        return;
+    }
+
+    std::vector<std::string> args = command_line();
+    if (args.empty()) {
+        _elog.log(ErrorLogger::ERROR, "Failed to read the command line");
+        return;
+    }
+
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC | O_NONBLOCK) == -1) {
+        _elog.log(ErrorLogger::ERROR, "Failed to create the upgrade pipe");
+        return;
+    }
+
+    std::string      listen_fds;
+    std::vector<int> keep = {ready[1]};
+    for (const auto& [address, virtual_server] : _virtual_servers) {
+        listen_fds += address.to_string() + "=" + std::to_string(virtual_server->get_fd()) + ";";
+        keep.push_back(virtual_server->get_fd());
+    }
+
+    // The child of a multithreaded process may only make async-signal-safe calls,
+    // so its environment and arguments are built here
+    std::vector<std::string> env = environment_without({LISTEN_FDS_ENV, READY_FD_ENV});
+    env.push_back(utils::format("{}={}", LISTEN_FDS_ENV, listen_fds));
+    env.push_back(utils::format("{}={}", READY_FD_ENV, ready[1]));
+    std::string        path = executable_path(args[0]);
+    std::vector<char*> argv = utils::c_str_array(args);
+    std::vector<char*> envp = utils::c_str_array(env);
+
+    ELOG_INFO(_elog, "Upgrading to {}", path);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        _elog.log(ErrorLogger::ERROR, "Failed to fork the upgraded binary");
+        ::close(ready[0]);
+        ::close(ready[1]);
+        return;
+    }
+
+    if (pid == 0) {
+        // Only the listening sockets and the pipe make it to the new binary
+        close_other_fds(keep);
+        fcntl(ready[1], F_SETFD, 0);
+        execve(path.c_str(), argv.data(), envp.data());
+        _exit(EXIT_FAILURE);
+    }
+
+    ::close(ready[1]);
+    _upgrading = true;
+
+    int fd = ready[0];
+    Promise<bool>(
+        [fd]() -> std::optional<bool> {
+            char    byte;
+            ssize_t n = ::read(fd, &byte, 1);
+            if (n == -1 && errno == EAGAIN) {
+                return std::nullopt;
+            }
+            return n == 1;
+        },
+        fd,
+        Event::READABLE)
+        .then([this, fd, pid](bool ready) {
+            Poller::instance().remove(fd);
+            ::close(fd);
+
+            if (!ready) {
+                // The pipe was closed without a word, the new binary failed to start and exits
+                _elog.log(ErrorLogger::ERROR, "Upgraded binary failed to start");
+                waitpid(pid, nullptr, 0);
+                _upgrading = false;
+                return;
+            }
+
+            _elog.log(ErrorLogger::INFO, "Upgraded binary is running, draining connections");
+            for (auto& [_, virtual_server] : _virtual_servers) {
+                virtual_server->stop();
+                _draining.push_back(std::move(virtual_server));
+            }
+            _virtual_servers.clear();
+        });
+}
+
+void Server::inherit()
+{
+    const char* listen_fds = getenv(LISTEN_FDS_ENV);
+    if (listen_fds == nullptr) {
+        return;
+    }
+
+    std::stringstream stream(listen_fds);
+    std::string       entry;
+    while (std::getline(stream, entry, ';')) {
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            continue;
+        }
+        Address address = Upstream::parse_address(entry.substr(0, equals));
+        _inherited[address] = std::stoi(entry.substr(equals + 1));
+    }
+
+    unsetenv(LISTEN_FDS_ENV);
+}
+
+void Server::notify_ready()
+{
+    for (const auto& [_, fd] : _inherited) {
+        ::close(fd);
+    }
+    _inherited.clear();
+
+    const char* ready_fd = getenv(READY_FD_ENV);
+    if (ready_fd == nullptr) {
+        return;
+    }
+
+    int fd = std::atoi(ready_fd);
+    if (::write(fd, "1", 1) != 1) {
+        _elog.log(ErrorLogger::WARNING, "Failed to notify the previous binary");
+    }
+    ::close(fd);
+    unsetenv(READY_FD_ENV);
+}
+
+void Server::wait_reload()
+{
+    _reload.wait().then([this](int) {
+        this->reload();
+        this->wait_reload();
+    });
+}
+
+void Server::wait_upgrade()
+{
+    _upgrade.wait().then([this](int) {
+        this->upgrade();
+        this->wait_upgrade();
+    });
+}
+
+void Server::wait_terminate()
+{
+    _terminate.wait().then([this](int) {
+        _elog.log(ErrorLogger::INFO, "Received SIGTERM, shutting down");
+        _terminating = true;
+    });
+}
+
+void Server::log_slow_callback(int fd, const sockaddr_in* peer, std::chrono::microseconds duration)
+{
+    double milliseconds = duration.count() / 1000.0;
+    if (fd == -1) {
+        ELOG_WARNING(_elog, "Slow callback of a blocking promise: {} ms", milliseconds);
+        return;
+    }
+
+    if (peer != nullptr) {
+        ELOG_WARNING(
+            _elog, "Slow callback on fd {} ({}): {} ms", fd, Address(*peer), milliseconds);
+    } else {
+        ELOG_WARNING(_elog, "Slow callback on fd {}: {} ms", fd, milliseconds);
+    }
 }
 }  // namespace webserv::net
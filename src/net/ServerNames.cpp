@@ -0,0 +1,88 @@
+#include "net/ServerNames.hpp"
+
+#include <cctype>
+
+namespace webserv::net
+{
+ServerNames::ServerNames() : _default(nullptr), _explicit_default(false) {}
+
+void ServerNames::add(const Config& server, bool default_server)
+{
+    if (_default == nullptr || (default_server && !_explicit_default)) {
+        _default          = &server;
+        _explicit_default = default_server;
+    }
+
+    for (auto it = server.begin(Config::SERVER_NAME); it != server.end();
+         it      = it.next(Config::SERVER_NAME)) {
+        for (const auto& param : it->get_parameters()) {
+            std::string_view name = std::get<std::string>(param);
+
+            if (name.starts_with("*.")) {
+                _leading.emplace(name.substr(1), &server);
+            } else if (name.ends_with(".*")) {
+                _trailing.emplace(name.substr(0, name.size() - 1), &server);
+            } else {
+                _exact.emplace(name, &server);
+            }
+        }
+    }
+}
+
+const Config& ServerNames::find(std::string_view host) const
+{
+    auto exact = _exact.find(host);
+    if (exact != _exact.end()) {
+        return *exact->second;
+    }
+
+    // The first dot from the left gives the longest suffix
+    if (!_leading.empty()) {
+        for (size_t dot = host.find('.'); dot != std::string_view::npos;
+             dot        = host.find('.', dot + 1)) {
+            auto leading = _leading.find(host.substr(dot));
+            if (leading != _leading.end()) {
+                return *leading->second;
+            }
+        }
+    }
+
+    // The last dot gives the longest prefix
+    if (!_trailing.empty()) {
+        for (size_t dot = host.rfind('.'); dot != std::string_view::npos && dot != 0;
+             dot        = host.rfind('.', dot - 1)) {
+            auto trailing = _trailing.find(host.substr(0, dot + 1));
+            if (trailing != _trailing.end()) {
+                return *trailing->second;
+            }
+        }
+    }
+
+    return *_default;
+}
+
+size_t ServerNames::Hash::operator()(std::string_view name) const
+{
+    // FNV-1a over the lowercased name
+    size_t hash = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+        hash ^= std::tolower(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool ServerNames::Equal::operator()(std::string_view lhs, std::string_view rhs) const
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(lhs[i])) !=
+            std::tolower(static_cast<unsigned char>(rhs[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace webserv::net
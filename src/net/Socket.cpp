@@ -1,10 +1,14 @@
 #include "net/Socket.hpp"
 
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <stdexcept>
 
+#include "async/Poller.hpp"
+
 #ifndef BUFFER_SIZE
 #define BUFFER_SIZE 4096
 #endif
@@ -12,6 +16,17 @@
 namespace webserv::net
 {
 using async::Event;
+using utils::BufferPool;
+
+namespace
+{
+/// The read buffers of the event loop
+BufferPool& read_buffers()
+{
+    static BufferPool buffers(BUFFER_SIZE);
+    return buffers;
+}
+}  // namespace
 
 Socket::Socket(Address address)
 {
@@ -63,30 +78,52 @@ void Socket::bind(Address address)
     _address = address;
 }
 
-Promise<ssize_t> Socket::read(std::vector<char>& buffer)
+std::optional<BufferPool::Buffer> Socket::read()
 {
-    return Promise<ssize_t>(
-        [this, &buffer]() -> std::optional<ssize_t> {
-            buffer.resize(BUFFER_SIZE);
-            ssize_t bytes_read = ::read(_fd, buffer.data(), BUFFER_SIZE);
-            if (bytes_read == -1) {
-                return std::nullopt;
-            }
-            return bytes_read;
-        },
-        _fd,
-        Event::READABLE);
+    BufferPool::Buffer buffer     = read_buffers().acquire();
+    ssize_t            bytes_read = async::Poller::instance().receive(
+        _fd, buffer.data(), buffer.capacity());
+    if (bytes_read == -1) {
+        if (errno == EAGAIN || errno == EINTR) {
+            return std::nullopt;
+        }
+        bytes_read = 0;
+    }
+    buffer.resize(bytes_read);
+    return buffer;
 }
 
-Promise<ssize_t> Socket::write(const std::vector<char>& buffer)
+Promise<ssize_t> Socket::write(http::ResponseBuilder& response)
 {
     return Promise<ssize_t>(
-        [this, &buffer]() -> std::optional<ssize_t> {
-            ssize_t bytes_written = ::write(_fd, buffer.data(), buffer.size());
-            if (bytes_written == -1) {
-                return std::nullopt;
+        [this, &response]() -> std::optional<ssize_t> {
+            while (!response.done()) {
+                iovec   iov[2];
+                size_t  count = response.iovecs(iov);
+                ssize_t bytes_written;
+                if (count > 0) {
+                    msghdr message     = {};
+                    message.msg_iov    = iov;
+                    message.msg_iovlen = count;
+                    // The head goes out in the same packet as the start of a file
+                    int flags     = MSG_NOSIGNAL | (response.has_file() ? MSG_MORE : 0);
+                    bytes_written = ::sendmsg(_fd, &message, flags);
+                } else {
+                    const auto* range  = response.file_range();
+                    off_t       offset = range->offset;
+                    bytes_written      = ::sendfile(_fd, range->fd, &offset, range->length);
+                }
+
+                if (bytes_written == -1 && (errno == EAGAIN || errno == EINTR)) {
+                    return std::nullopt;
+                }
+                // A file that shrank since it was opened can't be sent either
+                if (bytes_written <= 0) {
+                    return -1;
+                }
+                response.advance(bytes_written);
             }
-            return bytes_written;
+            return response.sent();
         },
         _fd,
         Event::WRITABLE);
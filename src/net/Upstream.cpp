@@ -0,0 +1,328 @@
+#include "net/Upstream.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace webserv::net
+{
+using Type = Config::Type;
+using Peer = Upstream::Peer;
+
+namespace
+{
+/// FNV-1a, used to place peers and keys on the hash ring
+uint32_t hash(const std::string& str)
+{
+    uint32_t hash = 2166136261u;
+    for (char c : str) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/// Parses the value of a `name=value` server parameter
+int parse_option(const std::string& param, const std::string& name)
+{
+    try {
+        return std::stoi(param.substr(name.size() + 1));
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Invalid upstream server parameter: " + param);
+    }
+}
+}  // namespace
+
+bool Peer::is_up(Clock::time_point now) const
+{
+    return max_fails == 0 || fails < max_fails || now >= down_until;
+}
+
+Upstream::Upstream(const Config& config)
+    : _name(std::get<std::string>(config.get_parameters()[0])),
+      _balance(Balance::ROUND_ROBIN),
+      _keepalive(config.value<int>(Type::KEEPALIVE, 0))
+{
+    for (const auto& child : config.get_children()) {
+        switch (child->get_type()) {
+        case Type::LEAST_CONN:
+            _balance = Balance::LEAST_CONN;
+            break;
+        case Type::HASH:
+            _balance  = Balance::HASH;
+            _hash_key = std::get<std::string>(child->get_parameters()[0]);
+            break;
+        case Type::UPSTREAM_SERVER: {
+            const auto& params = child->get_parameters();
+            if (!std::holds_alternative<std::string>(params[0])) {
+                throw std::runtime_error("Invalid upstream server address");
+            }
+
+            Peer peer;
+            peer.address = parse_address(std::get<std::string>(params[0]));
+            for (auto param = params.begin() + 1; param != params.end(); ++param) {
+                const std::string& option = std::get<std::string>(*param);
+                if (option.starts_with("weight=")) {
+                    peer.weight = std::max(1, parse_option(option, "weight"));
+                } else if (option.starts_with("max_fails=")) {
+                    peer.max_fails = parse_option(option, "max_fails");
+                } else if (option.starts_with("fail_timeout=")) {
+                    peer.fail_timeout = parse_option(option, "fail_timeout");
+                } else {
+                    throw std::runtime_error("Unknown upstream server parameter: " + option);
+                }
+            }
+            _peers.push_back(std::move(peer));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (_peers.empty()) {
+        throw std::runtime_error("Upstream '" + _name + "' has no servers");
+    }
+    this->build_ring();
+}
+
+Upstream::Upstream(const std::string& name, Address address)
+    : _name(name),
+      _balance(Balance::ROUND_ROBIN),
+      _keepalive(std::get<int>(Config::get_default_params(Type::KEEPALIVE)[0]))
+{
+    Peer peer;
+    peer.address = address;
+    _peers.push_back(std::move(peer));
+    this->build_ring();
+}
+
+Upstream::~Upstream()
+{
+    for (auto& peer : _peers) {
+        for (int fd : peer.idle) {
+            ::close(fd);
+        }
+    }
+}
+
+Peer* Upstream::select(const std::string& key)
+{
+    Clock::time_point now = Clock::now();
+
+    switch (_balance) {
+    case Balance::LEAST_CONN:
+        return this->select_least_conn(now);
+    case Balance::HASH:
+        return this->select_hash(key, now);
+    default:
+        return this->select_round_robin(now);
+    }
+}
+
+int Upstream::connect(Peer& peer, bool& reused)
+{
+    // Reuse an idle connection, unless the peer closed it in the meantime
+    while (!peer.idle.empty()) {
+        int fd = peer.idle.back();
+        peer.idle.pop_back();
+
+        char    c;
+        ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            reused = true;
+            ++peer.active;
+            return fd;
+        }
+        ::close(fd);
+    }
+
+    reused = false;
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (::connect(fd, (sockaddr*)&peer.address.get_sockaddr(), sizeof(sockaddr_in)) == -1 &&
+        errno != EINPROGRESS) {
+        ::close(fd);
+        return -1;
+    }
+
+    ++peer.active;
+    return fd;
+}
+
+void Upstream::release(Peer& peer, int fd, bool keep_alive)
+{
+    --peer.active;
+
+    if (keep_alive && peer.idle.size() < _keepalive) {
+        peer.idle.push_back(fd);
+    } else {
+        ::close(fd);
+    }
+}
+
+void Upstream::success(Peer& peer)
+{
+    peer.fails = 0;
+}
+
+void Upstream::failure(Peer& peer)
+{
+    // Like nginx, max_fails=0 turns failure accounting off
+    if (peer.max_fails == 0) {
+        return;
+    }
+    if (++peer.fails >= peer.max_fails) {
+        peer.down_until = Clock::now() + std::chrono::seconds(peer.fail_timeout);
+    }
+}
+
+const std::string& Upstream::get_name() const
+{
+    return _name;
+}
+
+Upstream::Balance Upstream::get_balance() const
+{
+    return _balance;
+}
+
+const std::string& Upstream::get_hash_key() const
+{
+    return _hash_key;
+}
+
+const std::vector<Peer>& Upstream::get_peers() const
+{
+    return _peers;
+}
+
+Upstream::Registry& Upstream::registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+std::shared_ptr<Upstream> Upstream::find(const std::string& name)
+{
+    auto it = registry().find(name);
+    if (it == registry().end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+Address Upstream::parse_address(const std::string& address)
+{
+    size_t      colon = address.find(':');
+    std::string host  = address.substr(0, colon);
+    int         port  = 80;
+
+    if (colon != std::string::npos) {
+        const char* first = address.data() + colon + 1;
+        const char* last  = address.data() + address.size();
+        auto [end, ec]    = std::from_chars(first, last, port);
+        if (ec != std::errc() || end != last || port < 1 || port > 65535) {
+            throw std::runtime_error("Invalid upstream address: " + address);
+        }
+    }
+
+    // Names are resolved once, when the configuration is loaded
+    addrinfo hints    = {};
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* result = nullptr;
+    int       error  = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+    if (error != 0) {
+        throw std::runtime_error("Unknown upstream host '" + host + "': " + gai_strerror(error));
+    }
+
+    sockaddr_in addr = *reinterpret_cast<sockaddr_in*>(result->ai_addr);
+    freeaddrinfo(result);
+    addr.sin_port = htons(port);
+    return Address(addr);
+}
+
+Peer* Upstream::select_round_robin(Clock::time_point now)
+{
+    // Smooth weighted round-robin: every pick raises each peer by its weight
+    // and lowers the chosen one by the total, spreading heavy peers evenly.
+    Peer* best  = nullptr;
+    int   total = 0;
+
+    for (auto& peer : _peers) {
+        if (!peer.is_up(now)) {
+            continue;
+        }
+        peer.current_weight += peer.weight;
+        total += peer.weight;
+        if (best == nullptr || peer.current_weight > best->current_weight) {
+            best = &peer;
+        }
+    }
+
+    if (best != nullptr) {
+        best->current_weight -= total;
+    }
+    return best;
+}
+
+Peer* Upstream::select_least_conn(Clock::time_point now)
+{
+    Peer* best = nullptr;
+
+    for (auto& peer : _peers) {
+        if (!peer.is_up(now)) {
+            continue;
+        }
+        // Compare active / weight without dividing
+        if (best == nullptr || peer.active * best->weight < best->active * peer.weight) {
+            best = &peer;
+        }
+    }
+
+    return best;
+}
+
+Peer* Upstream::select_hash(const std::string& key, Clock::time_point now)
+{
+    auto start = std::lower_bound(
+        _ring.begin(), _ring.end(), std::make_pair(hash(key), size_t(0)));
+
+    // Walk the ring clockwise until a live peer is found
+    for (size_t i = 0; i < _ring.size(); ++i) {
+        auto it = start + i;
+        if (it >= _ring.end()) {
+            it -= _ring.size();
+        }
+        Peer& peer = _peers[it->second];
+        if (peer.is_up(now)) {
+            return &peer;
+        }
+    }
+
+    return nullptr;
+}
+
+void Upstream::build_ring()
+{
+    _ring.clear();
+
+    for (size_t i = 0; i < _peers.size(); ++i) {
+        std::string address = _peers[i].address.to_string();
+        for (int point = 0; point < RING_POINTS * _peers[i].weight; ++point) {
+            _ring.emplace_back(hash(address + "-" + std::to_string(point)), i);
+        }
+    }
+    std::sort(_ring.begin(), _ring.end());
+}
+}  // namespace webserv::net
@@ -1,44 +1,111 @@
 #include "net/VirtualServer.hpp"
 
+#include <sys/socket.h>
+
+#include "async/Poller.hpp"
+
 namespace webserv::net
 {
-VirtualServer::VirtualServer(Address address, const std::string& default_name, ErrorLogger& elog)
-    : Listen(address), _elog(elog), _default_name(default_name)
+VirtualServer::VirtualServer(Address address, ErrorLogger& elog)
+    : Listen(address), _elog(elog), _stopped(false)
 {
-    _elog.log(ErrorLogger::INFO, "Listening on " + this->get_address().to_string());
+    ELOG_INFO(_elog, "Listening on {}", this->get_address());
+}
+
+VirtualServer::VirtualServer(Address address, int fd, ErrorLogger& elog)
+    : Listen(address, fd), _elog(elog), _stopped(false)
+{
+    ELOG_INFO(_elog, "Listening on inherited {}", this->get_address());
 }
 
 void VirtualServer::listen()
 {
-    this->accept().then([this](Socket socket) {
-        _clients.emplace_back(std::make_unique<Client>(std::move(socket), *this, _elog));
+    if (!_stopped) {
+        this->accept().then([this](Socket socket) {
+            Client& client = *_clients.create(std::move(socket), *this, _elog);
+            utils::Metrics::instance().add_accepted();
+            ELOG_INFO(_elog, "Accepted connection from {}", client.get_address());
+            client.handle_connection();
+        });
+    } else {
+        // Keep-alive connections waiting for a request won't get another one
+        for (Client* client : _clients) {
+            if (client->is_connected() && client->is_idle()) {
+                client->disconnect();
+            }
+        }
+    }
+
+    for (Client* client : _disconnected) {
+        _clients.destroy(client);
+    }
+    _disconnected.clear();
+}
+
+void VirtualServer::disconnect(Client& client)
+{
+    _disconnected.push_back(&client);
+}
+
+void VirtualServer::set_generation(std::shared_ptr<const Config> config)
+{
+    _generation = std::move(config);
+    _names.clear();
+}
+
+std::shared_ptr<const Config> VirtualServer::get_generation() const
+{
+    return _generation;
+}
+
+void VirtualServer::stop()
+{
+    ELOG_INFO(_elog, "Stopped listening on {}", this->get_address());
+
+    async::Poller::instance().remove(_fd);
+    this->close();
+    _stopped = true;
+}
 
-        Client& client = *(_clients.back());
-        _elog.log(ErrorLogger::INFO,
-                  "Accepted connection from " + client.get_address().to_string());
-        client.handle_connection();
-    });
+bool VirtualServer::is_drained() const
+{
+    return _stopped && _clients.empty();
+}
 
-    // Remove disconnected clients
-    _clients.erase(std::remove_if(_clients.begin(),
-                                  _clients.end(),
-                                  [](const std::unique_ptr<Client>& client) {
-                                      return client->is_connected() == false;
-                                  }),
-                   _clients.end());
+void VirtualServer::count_connections(utils::Metrics::Connections& connections) const
+{
+    for (const Client* client : _clients) {
+        if (client->is_idle()) {
+            ++connections.idle;
+        } else if (client->is_writing()) {
+            ++connections.writing;
+        } else {
+            ++connections.reading;
+        }
+    }
 }
 
-void VirtualServer::add_config(const Config& config)
+void VirtualServer::add_config(const Address& address, const Config& config, bool default_server)
 {
-    _configs[config.server_name()] = &config;
+    _names[address].add(config, default_server);
 }
 
-const Config& VirtualServer::get_config(const std::string& host) const
+const Config& VirtualServer::get_config(const Socket& client, std::string_view host) const
 {
-    if (_configs.find(host) == _configs.end()) {
-        return *_configs.at(_default_name);
+    if (_names.size() == 1) {
+        return _names.begin()->second.find(host);
+    }
+
+    // Only look up the local address when the socket serves several
+    sockaddr_in local;
+    socklen_t   length = sizeof(local);
+    if (getsockname(client.get_fd(), (sockaddr*)&local, &length) == 0) {
+        auto names = _names.find(Address(local));
+        if (names != _names.end()) {
+            return names->second.find(host);
+        }
     }
 
-    return *_configs.at(host);
+    return _names.at(this->get_address()).find(host);
 }
 }  // namespace webserv::net
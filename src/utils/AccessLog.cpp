@@ -0,0 +1,267 @@
+#include "utils/AccessLog.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "utils/Format.hpp"
+
+namespace webserv::utils
+{
+namespace
+{
+/// Copies a string into a fixed-size field, truncating it
+template <size_t N>
+void copy_field(char (&field)[N], std::string_view value)
+{
+    size_t size = std::min(value.size(), N - 1);
+    std::memcpy(field, value.data(), size);
+    field[size] = '\0';
+}
+
+/// Appends the request line of a record, or "-" without a request
+template <typename Append>
+void append_request(std::string& line, const AccessLog::Record& record, Append append)
+{
+    if (*record.method == '\0') {
+        line += '-';
+        return;
+    }
+    append(line, record.method);
+    line += ' ';
+    append(line, record.uri);
+    if (*record.query != '\0') {
+        line += '?';
+        append(line, record.query);
+    }
+    line += " HTTP/1.1";
+}
+
+/// Appends a string as is
+void append_raw(std::string& line, std::string_view value)
+{
+    line += value;
+}
+
+void write_all(int fd, const std::string& buffer)
+{
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (n <= 0) {
+            return;
+        }
+        written += n;
+    }
+}
+}  // namespace
+
+AccessLog::AccessLog(const std::string& path, Format format)
+    : _format(format),
+      _dropped(0),
+      _running(true),
+      _sleeping(false),
+      _timestamp_time(-1),
+      _timestamp()
+{
+    _fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to open access log: " + path);
+    }
+
+    _writer = std::thread(&AccessLog::write_loop, this);
+}
+
+AccessLog::~AccessLog()
+{
+    _running.store(false, std::memory_order_release);
+    this->wake();
+    _writer.join();
+    close(_fd);
+}
+
+void AccessLog::log(const sockaddr_in& address,
+                    int                status,
+                    size_t             bytes_sent,
+                    uint32_t           request_time_us,
+                    std::string_view   method,
+                    std::string_view   uri,
+                    std::string_view   query,
+                    std::string_view   referer,
+                    std::string_view   user_agent)
+{
+    Record* record = _records.acquire();
+    if (record == nullptr) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    record->time            = std::time(nullptr);
+    record->address         = address.sin_addr.s_addr;
+    record->status          = status;
+    record->bytes_sent      = bytes_sent;
+    record->request_time_us = request_time_us;
+    copy_field(record->method, method);
+    copy_field(record->uri, uri);
+    copy_field(record->query, query);
+    copy_field(record->referer, referer);
+    copy_field(record->user_agent, user_agent);
+
+    _records.publish();
+
+    // Pairs with the fence in `wait`: either the writer sees the record or this sees it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed)) {
+        this->wake();
+    }
+}
+
+size_t AccessLog::dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+AccessLog& AccessLog::get(const std::string& path, const std::string& format)
+{
+    auto key = std::make_pair(path, format_of(format));
+    auto it  = registry().find(key);
+    if (it == registry().end()) {
+        it = registry().emplace(key, std::make_unique<AccessLog>(path, key.second)).first;
+    }
+    return *it->second;
+}
+
+AccessLog::Format AccessLog::format_of(const std::string& name)
+{
+    if (name == "combined") {
+        return Format::COMBINED;
+    }
+    if (name == "json") {
+        return Format::JSON;
+    }
+    throw std::runtime_error("Unknown access log format: " + name);
+}
+
+void AccessLog::format(const Record&    record,
+                       Format           format,
+                       std::string_view timestamp,
+                       std::string&     line)
+{
+    char address[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &record.address, address, sizeof(address));
+
+    if (format == Format::JSON) {
+        char request_time[32];
+        snprintf(request_time, sizeof(request_time), "%.6f", record.request_time_us / 1e6);
+
+        line += "{\"time\":\"";
+        line += timestamp;
+        line += "\",\"remote_addr\":\"";
+        line += address;
+        line += "\",\"request\":\"";
+        append_request(line, record, append_json);
+        line += "\",\"status\":";
+        line += std::to_string(record.status);
+        line += ",\"bytes_sent\":";
+        line += std::to_string(record.bytes_sent);
+        line += ",\"request_time\":";
+        line += request_time;
+        line += ",\"referer\":\"";
+        append_json(line, record.referer);
+        line += "\",\"user_agent\":\"";
+        append_json(line, record.user_agent);
+        line += "\"}\n";
+        return;
+    }
+
+    // $remote_addr - - [$time_local] "$request" $status $bytes_sent "$referer" "$user_agent"
+    line += address;
+    line += " - - [";
+    line += timestamp;
+    line += "] \"";
+    append_request(line, record, append_raw);
+    line += "\" ";
+    line += std::to_string(record.status);
+    line += ' ';
+    line += std::to_string(record.bytes_sent);
+    line += " \"";
+    line += *record.referer ? record.referer : "-";
+    line += "\" \"";
+    line += *record.user_agent ? record.user_agent : "-";
+    line += "\"\n";
+}
+
+void AccessLog::write_loop()
+{
+    std::string batch;
+    batch.reserve(BATCH_SIZE + 2048);
+
+    while (true) {
+        bool running = _running.load(std::memory_order_acquire);
+
+        Record* record;
+        while ((record = _records.front()) != nullptr) {
+            format(*record, _format, this->timestamp(record->time), batch);
+            _records.pop();
+
+            if (batch.size() >= BATCH_SIZE) {
+                write_all(_fd, batch);
+                batch.clear();
+            }
+        }
+
+        if (!batch.empty()) {
+            write_all(_fd, batch);
+            batch.clear();
+        }
+
+        // Records pushed before `_running` was cleared have been written
+        if (!running) {
+            break;
+        }
+        this->wait();
+    }
+}
+
+void AccessLog::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _wakeup.wait(lock, [this] {
+        return _records.front() != nullptr || !_running.load(std::memory_order_acquire);
+    });
+    _sleeping.store(false, std::memory_order_relaxed);
+}
+
+void AccessLog::wake()
+{
+    // Under the lock, so the writer is either before its check or waiting
+    std::lock_guard<std::mutex> lock(_mutex);
+    _wakeup.notify_one();
+}
+
+std::string_view AccessLog::timestamp(time_t time)
+{
+    if (time != _timestamp_time) {
+        std::tm tm;
+        localtime_r(&time, &tm);
+        strftime(_timestamp,
+                 sizeof(_timestamp),
+                 _format == Format::JSON ? "%Y-%m-%dT%H:%M:%S%z" : "%d/%b/%Y:%H:%M:%S %z",
+                 &tm);
+        _timestamp_time = time;
+    }
+    return _timestamp;
+}
+
+AccessLog::Registry& AccessLog::registry()
+{
+    static Registry registry;
+    return registry;
+}
+}  // namespace webserv::utils
@@ -0,0 +1,39 @@
+#include "utils/Arena.hpp"
+
+namespace webserv::utils
+{
+Arena::Arena(BufferPool& pool) : _pool(pool) {}
+
+void Arena::reset()
+{
+    // Only walks the blocks taken from the heap, usually none
+    _resource.reset();
+    _block       = BufferPool::Buffer();
+    _allocations = 0;
+    _allocated   = 0;
+}
+
+BufferPool& Arena::blocks()
+{
+    static BufferPool blocks(BLOCK_SIZE);
+    return blocks;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+    if (!_resource) {
+        _block = _pool.acquire();
+        _resource.emplace(_block.data(), _block.capacity(), std::pmr::new_delete_resource());
+    }
+    ++_allocations;
+    _allocated += bytes;
+    return _resource->allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void*, size_t, size_t) {}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+}  // namespace webserv::utils
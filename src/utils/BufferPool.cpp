@@ -0,0 +1,67 @@
+#include "utils/BufferPool.hpp"
+
+#include <utility>
+
+namespace webserv::utils
+{
+BufferPool::Buffer::Buffer(BufferPool& pool, std::unique_ptr<char[]> data)
+    : _pool(&pool), _data(std::move(data))
+{
+}
+
+BufferPool::Buffer::~Buffer()
+{
+    if (_data) {
+        _pool->release(std::move(_data));
+    }
+}
+
+BufferPool::Buffer::Buffer(Buffer&& other) noexcept
+    : _pool(other._pool), _data(std::move(other._data)), _size(std::exchange(other._size, 0))
+{
+}
+
+BufferPool::Buffer& BufferPool::Buffer::operator=(Buffer&& other) noexcept
+{
+    if (this != &other) {
+        if (_data) {
+            _pool->release(std::move(_data));
+        }
+        _pool = other._pool;
+        _data = std::move(other._data);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+size_t BufferPool::Buffer::capacity() const
+{
+    return _data ? _pool->buffer_size() : 0;
+}
+
+BufferPool::BufferPool(size_t buffer_size, size_t max_free)
+    : _buffer_size(buffer_size), _max_free(max_free)
+{
+}
+
+BufferPool::Buffer BufferPool::acquire()
+{
+    std::unique_ptr<char[]> data;
+    if (!_free.empty()) {
+        data = std::move(_free.back());
+        _free.pop_back();
+    } else {
+        data = std::make_unique_for_overwrite<char[]>(_buffer_size);
+    }
+    ++_in_use;
+    return Buffer(*this, std::move(data));
+}
+
+void BufferPool::release(std::unique_ptr<char[]> data)
+{
+    --_in_use;
+    if (_free.size() < _max_free) {
+        _free.push_back(std::move(data));
+    }
+}
+}  // namespace webserv::utils
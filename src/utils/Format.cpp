@@ -0,0 +1,65 @@
+#include "utils/Format.hpp"
+
+namespace webserv::utils
+{
+void append_json(std::string& out, std::string_view value)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += HEX[c >> 4];
+            out += HEX[c & 0xf];
+        } else {
+            out += c;
+        }
+    }
+}
+}  // namespace webserv::utils
+
+namespace webserv::utils::detail
+{
+void format_to(std::string&      out,
+               std::string_view  format,
+               const void* const values[],
+               const Appender    appenders[],
+               size_t            count)
+{
+    size_t arg = 0;
+    size_t pos = 0;
+
+    while (pos < format.size()) {
+        size_t brace = format.find_first_of("{}", pos);
+        if (brace == std::string_view::npos) {
+            break;
+        }
+        out.append(format.substr(pos, brace - pos));
+
+        // `{{` and `}}` are escaped braces
+        if (brace + 1 < format.size() && format[brace + 1] == format[brace]) {
+            out.push_back(format[brace]);
+            pos = brace + 2;
+            continue;
+        }
+
+        if (format[brace] == '{' && brace + 1 < format.size() && format[brace + 1] == '}' &&
+            arg < count) {
+            appenders[arg](out, values[arg]);
+            ++arg;
+            pos = brace + 2;
+            continue;
+        }
+
+        out.push_back(format[brace]);
+        pos = brace + 1;
+    }
+
+    if (pos < format.size()) {
+        out.append(format.substr(pos));
+    }
+}
+}  // namespace webserv::utils::detail
@@ -1,58 +1,93 @@
 #include "utils/Logger.hpp"
 
-#include <chrono>
-#include <iostream>
-#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdexcept>
 
 #include "utils/Color.hpp"
 
 namespace webserv::utils
 {
-Logger::Logger() : _stream(std::cerr) {}
+namespace
+{
+void write_all(int fd, std::string_view buffer)
+{
+    while (!buffer.empty()) {
+        ssize_t n = ::write(fd, buffer.data(), buffer.size());
+        if (n <= 0) {
+            return;
+        }
+        buffer.remove_prefix(n);
+    }
+}
+}  // namespace
 
-std::string Logger::get_timestamp()
+Logger::Logger() : _fd(STDERR_FILENO) {}
+
+std::string_view Logger::get_timestamp()
 {
-    auto        now  = std::chrono::system_clock::now();
-    std::time_t time = std::chrono::system_clock::to_time_t(now);
-    char        buffer[20];
+    thread_local time_t last = -1;
+    thread_local char   buffer[20];
 
-    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&time));
-    return std::string(buffer);
+    time_t now = std::time(nullptr);
+    if (now != last) {
+        std::tm tm;
+        localtime_r(&now, &tm);
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+        last = now;
+    }
+    return buffer;
 }
 
 ErrorLogger::ErrorLogger(Level level) : _level(level) {}
 
-void ErrorLogger::log(ErrorLogger::Level level, const std::string& message)
+ErrorLogger::~ErrorLogger()
+{
+    this->set_file("");
+}
+
+void ErrorLogger::log(ErrorLogger::Level level, std::string_view message)
 {
     if (level < _level) {
         return;
     }
 
-    std::stringstream buffer;
-    buffer << "[" << get_timestamp() << "]";
-    switch (level) {
-    case Level::DEBUG:
-        buffer << Color::CYAN << "[DEBUG]";
-        break;
-    case Level::INFO:
-        buffer << Color::GREEN << "[INFO]";
-        break;
-    case Level::WARNING:
-        buffer << Color::YELLOW << "[WARNING]";
-        break;
-    case Level::ERROR:
-        buffer << Color::RED << "[ERROR]";
-        break;
-    case Level::CRITICAL:
-        buffer << Color::MAGENTA << "[CRITICAL]";
-        break;
+    static const char* const NAMES[]  = {"[DEBUG]", "[INFO]", "[WARNING]", "[ERROR]", "[CRITICAL]"};
+    static const char* const COLORS[] = {
+        Color::CYAN, Color::GREEN, Color::YELLOW, Color::RED, Color::MAGENTA};
+
+    // `message` may live in `message_buffer()`, so stderr lines use their own
+    thread_local std::string stderr_line;
+
+    bool         to_file = !_path.empty();
+    std::string& line    = to_file ? _buffer : stderr_line;
+    if (!to_file) {
+        line.clear();
+    }
+
+    line += '[';
+    line += get_timestamp();
+    line += ']';
+    if (!to_file) {
+        line += COLORS[level];
+    }
+    line += NAMES[level];
+    if (!to_file) {
+        line += Color::RESET;
     }
+    line += ": ";
+    line += message;
+    line += '\n';
 
-    buffer << Color::RESET << ": " << message << std::endl;
-    _stream << buffer.str();
+    if (!to_file) {
+        write_all(_fd, line);
+    } else if (_buffer.size() >= BUFFER_SIZE || level >= Level::ERROR) {
+        this->flush();
+    }
 }
 
-void ErrorLogger::log(const std::string& message)
+void ErrorLogger::log(std::string_view message)
 {
     log(Level::DEBUG, message);
 }
@@ -76,4 +111,43 @@ void ErrorLogger::set_level(const std::string& level)
         _level = Level::CRITICAL;
     }
 }
+
+void ErrorLogger::set_file(const std::string& path)
+{
+    if (path == _path) {
+        return;
+    }
+
+    int fd = STDERR_FILENO;
+    if (!path.empty()) {
+        fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            throw std::runtime_error("Failed to open error log: " + path);
+        }
+    }
+
+    this->flush();
+    if (_fd != STDERR_FILENO) {
+        close(_fd);
+    }
+    _fd   = fd;
+    _path = path;
+    if (!_path.empty()) {
+        _buffer.reserve(BUFFER_SIZE + 1024);
+    }
+}
+
+void ErrorLogger::flush()
+{
+    if (!_buffer.empty()) {
+        write_all(_fd, _buffer);
+        _buffer.clear();
+    }
+}
+
+std::string& ErrorLogger::message_buffer()
+{
+    thread_local std::string buffer;
+    return buffer;
+}
 }  // namespace webserv::utils
@@ -0,0 +1,250 @@
+#include "utils/Metrics.hpp"
+
+#include <bit>
+
+#include "utils/Format.hpp"
+
+namespace webserv::utils
+{
+namespace
+{
+/// Escapes a Prometheus label value
+std::string label(std::string_view value)
+{
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+uint64_t load(const std::atomic<uint64_t>& counter)
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+void header(std::string& out, std::string_view name, std::string_view type, std::string_view help)
+{
+    utils::format_to(out, "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+
+/// Writes the series of a histogram, dividing its values by `scale`
+///
+/// The values are integers, so a bucket below `upper_bound` holds the ones `le` its bound - 1.
+void histogram(std::string&              out,
+               std::string_view          name,
+               std::string_view          labels,
+               const Metrics::Histogram& histogram,
+               double                    scale)
+{
+    std::string prefix = labels.empty() ? "" : std::string(labels) + ",";
+    std::string suffix = labels.empty() ? "" : "{" + std::string(labels) + "}";
+
+    uint64_t count = 0;
+    for (size_t i = 0; i < Metrics::BUCKETS; ++i) {
+        count += load(histogram.buckets[i]);
+        utils::format_to(out,
+                         "{}_bucket{{{}le=\"{}\"}} {}\n",
+                         name,
+                         prefix,
+                         (Metrics::Histogram::upper_bound(i) - 1) / scale,
+                         count);
+    }
+    count += load(histogram.buckets[Metrics::BUCKETS]);
+    utils::format_to(out, "{}_bucket{{{}le=\"+Inf\"}} {}\n", name, prefix, count);
+    utils::format_to(out, "{}_sum{} {}\n", name, suffix, load(histogram.sum) / scale);
+    utils::format_to(out, "{}_count{} {}\n", name, suffix, count);
+}
+}  // namespace
+
+void Metrics::Histogram::record(uint64_t us)
+{
+    buckets[bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(us, std::memory_order_relaxed);
+}
+
+size_t Metrics::Histogram::bucket(uint64_t us)
+{
+    if (us < 2) {
+        return us;
+    }
+    // Two buckets per power of two, split by the bit after the highest one
+    size_t exponent = std::bit_width(us) - 1;
+    size_t bucket   = 2 + (exponent - 1) * 2 + ((us >> (exponent - 1)) & 1);
+    return std::min(bucket, BUCKETS);
+}
+
+uint64_t Metrics::Histogram::upper_bound(size_t bucket)
+{
+    if (bucket < 2) {
+        return bucket + 1;
+    }
+    size_t   exponent = (bucket - 2) / 2 + 1;
+    uint64_t half     = uint64_t(1) << (exponent - 1);
+    return (uint64_t(1) << exponent) + ((bucket - 2) % 2 + 1) * half;
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics instance;
+    return instance;
+}
+
+Metrics::Location& Metrics::location(const std::string& server, const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto& location = _locations[{server, path}];
+    if (!location) {
+        location         = std::make_unique<Location>();
+        location->server = server;
+        location->path   = path;
+    }
+    return *location;
+}
+
+void Metrics::record(Location& location, int status, uint64_t us)
+{
+    if (status >= 100 && status < 600) {
+        _responses[status].fetch_add(1, std::memory_order_relaxed);
+        location.responses[status / 100 - 1].fetch_add(1, std::memory_order_relaxed);
+    }
+    location.latency.record(us);
+}
+
+void Metrics::record_iteration(uint64_t us, size_t ready_events, size_t blocking_promises)
+{
+    _loop.iteration.record(us);
+    _loop.ready_events.record(ready_events);
+    _loop.blocking_promises.store(blocking_promises, std::memory_order_relaxed);
+}
+
+void Metrics::record_callback(uint64_t us, bool slow)
+{
+    _loop.callback.record(us);
+    if (slow) {
+        _loop.slow_callbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::set_connections(std::function<Connections()> connections)
+{
+    _connections = std::move(connections);
+}
+
+std::string Metrics::str() const
+{
+    std::string out;
+
+    Connections connections = _connections ? _connections() : Connections();
+    header(out, "webserv_connections", "gauge", "Client connections by state.");
+    for (auto [state, count] : {std::pair{"reading", connections.reading},
+                                std::pair{"writing", connections.writing},
+                                std::pair{"idle", connections.idle}}) {
+        utils::format_to(out, "webserv_connections{{state=\"{}\"}} {}\n", state, count);
+    }
+
+    header(out, "webserv_connections_accepted_total", "counter", "Accepted client connections.");
+    utils::format_to(out, "webserv_connections_accepted_total {}\n", load(_accepted));
+
+    header(out, "webserv_received_bytes_total", "counter", "Bytes read from clients.");
+    utils::format_to(out, "webserv_received_bytes_total {}\n", load(_received));
+
+    header(out, "webserv_sent_bytes_total", "counter", "Bytes sent to clients.");
+    utils::format_to(out, "webserv_sent_bytes_total {}\n", load(_sent));
+
+    header(out, "webserv_cgi_spawns_total", "counter", "CGI processes started.");
+    utils::format_to(out, "webserv_cgi_spawns_total {}\n", load(_cgi_spawns));
+
+    header(out,
+           "webserv_loop_iteration_seconds",
+           "histogram",
+           "Time the event loop spent handling the events of one iteration.");
+    histogram(out, "webserv_loop_iteration_seconds", "", _loop.iteration, 1e6);
+
+    header(out,
+           "webserv_loop_callback_seconds",
+           "histogram",
+           "Time the event loop spent in one callback.");
+    histogram(out, "webserv_loop_callback_seconds", "", _loop.callback, 1e6);
+
+    header(out, "webserv_loop_ready_events", "histogram", "Events returned by one wait.");
+    histogram(out, "webserv_loop_ready_events", "", _loop.ready_events, 1);
+
+    header(out, "webserv_loop_blocking_promises", "gauge", "Promises polled every iteration.");
+    utils::format_to(out, "webserv_loop_blocking_promises {}\n", load(_loop.blocking_promises));
+
+    header(out,
+           "webserv_loop_slow_callbacks_total",
+           "counter",
+           "Callbacks slower than slow_callback_threshold.");
+    utils::format_to(out, "webserv_loop_slow_callbacks_total {}\n", load(_loop.slow_callbacks));
+
+    header(out,
+           "webserv_loop_syscalls_total",
+           "counter",
+           "System calls the event loop made to wait for and watch file descriptors.");
+    utils::format_to(out, "webserv_loop_syscalls_total {}\n", load(_loop.syscalls));
+
+    header(out,
+           "webserv_pool_wait_seconds",
+           "histogram",
+           "Time a job of the thread pool waited for a worker.");
+    histogram(out, "webserv_pool_wait_seconds", "", _pool.wait, 1e6);
+
+    header(out, "webserv_pool_queued_jobs", "gauge", "Jobs waiting for a worker of the thread pool.");
+    utils::format_to(out, "webserv_pool_queued_jobs {}\n", load(_pool.queued));
+
+    header(out,
+           "webserv_pool_overflows_total",
+           "counter",
+           "Jobs run on the event loop as the queue of the thread pool was full.");
+    utils::format_to(out, "webserv_pool_overflows_total {}\n", load(_pool.overflows));
+
+    header(out, "webserv_responses_total", "counter", "Responses by status code.");
+    for (size_t code = 0; code < _responses.size(); ++code) {
+        if (uint64_t count = load(_responses[code])) {
+            utils::format_to(out, "webserv_responses_total{{code=\"{}\"}} {}\n", code, count);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    header(out,
+           "webserv_location_responses_total",
+           "counter",
+           "Responses by location and status class.");
+    for (const auto& [_, location] : _locations) {
+        std::string labels = utils::format(
+            "server=\"{}\",location=\"{}\"", label(location->server), label(location->path));
+        for (size_t i = 0; i < location->responses.size(); ++i) {
+            if (uint64_t count = load(location->responses[i])) {
+                utils::format_to(out,
+                                 "webserv_location_responses_total{{{},class=\"{}xx\"}} {}\n",
+                                 labels,
+                                 i + 1,
+                                 count);
+            }
+        }
+    }
+
+    header(out,
+           "webserv_request_duration_seconds",
+           "histogram",
+           "Time from the first byte of a request to its response being sent.");
+    for (const auto& [_, location] : _locations) {
+        std::string labels = utils::format(
+            "server=\"{}\",location=\"{}\"", label(location->server), label(location->path));
+        histogram(out, "webserv_request_duration_seconds", labels, location->latency, 1e6);
+    }
+
+    return out;
+}
+}  // namespace webserv::utils
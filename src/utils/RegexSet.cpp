@@ -0,0 +1,416 @@
+#include "utils/RegexSet.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <stdexcept>
+
+namespace webserv::utils
+{
+RegexSet::RegexSet() : _count(0) {}
+
+size_t RegexSet::add(const std::string& pattern, bool icase)
+{
+    std::string_view rest     = pattern;
+    bool             anchored = rest.starts_with('^');
+    if (anchored) {
+        rest.remove_prefix(1);
+    }
+
+    Fragment fragment = this->parse_alternation(rest, icase);
+    if (!rest.empty()) {
+        throw std::runtime_error("Invalid regex '" + pattern + "': unmatched ')'");
+    }
+
+    State match;
+    match.kind    = State::MATCH;
+    match.pattern = static_cast<int>(_count);
+    this->patch(fragment, this->add_state(match));
+
+    // Unanchored patterns may start at any position
+    int start = fragment.start;
+    if (!anchored) {
+        State any;
+        any.kind  = State::CHAR;
+        any.chars = CharSet().set();
+
+        State loop;
+        loop.kind = State::SPLIT;
+        loop.out  = fragment.start;
+
+        int any_index          = this->add_state(any);
+        loop.out1              = any_index;
+        start                  = this->add_state(loop);
+        _states[any_index].out = start;
+    }
+    _starts.push_back(start);
+
+    _dstates.clear();
+    _dindex.clear();
+
+    return _count++;
+}
+
+int RegexSet::match(std::string_view input) const
+{
+    if (_starts.empty()) {
+        return -1;
+    }
+
+    if (_dstates.empty()) {
+        std::vector<int>  start;
+        std::vector<bool> seen(_states.size());
+        for (int state : _starts) {
+            this->add_closure(start, state, false, seen);
+        }
+        this->dstate(start);
+    }
+
+    int best    = INT_MAX;
+    int current = 0;
+    for (unsigned char c : input) {
+        best = std::min(best, _dstates[current].accept);
+        if (best == 0) {
+            return 0;
+        }
+
+        // Start over when the cache is full, keeping the current state
+        if (_dstates.size() >= MAX_DSTATES) {
+            std::vector<int> states = _dstates[current].states;
+            std::vector<int> start  = _dstates[0].states;
+            _dstates.clear();
+            _dindex.clear();
+            this->dstate(start);
+            current = this->dstate(states);
+        }
+        current = this->step(current, c);
+    }
+    best = std::min(best, _dstates[current].accept_end);
+
+    return best == INT_MAX ? -1 : best;
+}
+
+size_t RegexSet::size() const
+{
+    return _count;
+}
+
+RegexSet::Fragment RegexSet::parse_alternation(std::string_view& pattern, bool icase)
+{
+    Fragment fragment = this->parse_concatenation(pattern, icase);
+
+    while (pattern.starts_with('|')) {
+        pattern.remove_prefix(1);
+        Fragment other = this->parse_concatenation(pattern, icase);
+
+        State split;
+        split.kind = State::SPLIT;
+        split.out  = fragment.start;
+        split.out1 = other.start;
+
+        fragment.start = this->add_state(split);
+        fragment.outs.insert(fragment.outs.end(), other.outs.begin(), other.outs.end());
+    }
+
+    return fragment;
+}
+
+RegexSet::Fragment RegexSet::parse_concatenation(std::string_view& pattern, bool icase)
+{
+    // An empty expression is a split with a single out
+    State empty;
+    empty.kind = State::SPLIT;
+    int start  = this->add_state(empty);
+
+    Fragment fragment = {start, {{start, 0}}};
+    while (!pattern.empty() && pattern[0] != '|' && pattern[0] != ')') {
+        Fragment next = this->parse_repetition(pattern, icase);
+        this->patch(fragment, next.start);
+        fragment.outs = std::move(next.outs);
+    }
+
+    return fragment;
+}
+
+RegexSet::Fragment RegexSet::parse_repetition(std::string_view& pattern, bool icase)
+{
+    Fragment fragment = this->parse_atom(pattern, icase);
+
+    while (!pattern.empty() && (pattern[0] == '*' || pattern[0] == '+' || pattern[0] == '?')) {
+        char op = pattern[0];
+        pattern.remove_prefix(1);
+        // Lazy quantifiers match the same inputs
+        if (pattern.starts_with('?')) {
+            pattern.remove_prefix(1);
+        }
+
+        State split;
+        split.kind = State::SPLIT;
+        split.out  = fragment.start;
+        int index  = this->add_state(split);
+
+        switch (op) {
+        case '*':
+            this->patch(fragment, index);
+            fragment = {index, {{index, 1}}};
+            break;
+        case '+':
+            this->patch(fragment, index);
+            fragment = {fragment.start, {{index, 1}}};
+            break;
+        default:
+            fragment.start = index;
+            fragment.outs.emplace_back(index, 1);
+            break;
+        }
+    }
+
+    return fragment;
+}
+
+RegexSet::Fragment RegexSet::parse_atom(std::string_view& pattern, bool icase)
+{
+    char c = pattern[0];
+    pattern.remove_prefix(1);
+
+    switch (c) {
+    case '(': {
+        if (pattern.starts_with("?:")) {
+            pattern.remove_prefix(2);
+        }
+        Fragment fragment = this->parse_alternation(pattern, icase);
+        if (!pattern.starts_with(')')) {
+            throw std::runtime_error("Invalid regex: missing ')'");
+        }
+        pattern.remove_prefix(1);
+        return fragment;
+    }
+    case '.':
+        return this->char_fragment(CharSet().set(), false);
+    case '[':
+        return this->char_fragment(this->parse_class(pattern), icase);
+    case '\\':
+        return this->char_fragment(this->parse_escape(pattern), icase);
+    case '$': {
+        State end;
+        end.kind  = State::END;
+        int index = this->add_state(end);
+        return {index, {{index, 0}}};
+    }
+    case '^':
+        throw std::runtime_error("Invalid regex: '^' is only supported at the start");
+    case '*':
+    case '+':
+    case '?':
+        throw std::runtime_error(std::string("Invalid regex: nothing to repeat before '") + c +
+                                 "'");
+    default: {
+        CharSet chars;
+        chars.set(static_cast<unsigned char>(c));
+        return this->char_fragment(chars, icase);
+    }
+    }
+}
+
+RegexSet::CharSet RegexSet::parse_class(std::string_view& pattern)
+{
+    CharSet chars;
+    bool    negate = pattern.starts_with('^');
+    if (negate) {
+        pattern.remove_prefix(1);
+    }
+
+    // A ']' right after the opening bracket is a literal
+    bool first = true;
+    while (!pattern.empty() && (pattern[0] != ']' || first)) {
+        first = false;
+
+        if (pattern[0] == '\\') {
+            pattern.remove_prefix(1);
+            chars |= this->parse_escape(pattern);
+            continue;
+        }
+
+        unsigned char from = pattern[0];
+        pattern.remove_prefix(1);
+        if (pattern.size() >= 2 && pattern[0] == '-' && pattern[1] != ']') {
+            unsigned char to = pattern[1];
+            pattern.remove_prefix(2);
+            for (int c = from; c <= to; ++c) {
+                chars.set(c);
+            }
+        } else {
+            chars.set(from);
+        }
+    }
+
+    if (pattern.empty()) {
+        throw std::runtime_error("Invalid regex: missing ']'");
+    }
+    pattern.remove_prefix(1);
+
+    return negate ? ~chars : chars;
+}
+
+RegexSet::CharSet RegexSet::parse_escape(std::string_view& pattern)
+{
+    if (pattern.empty()) {
+        throw std::runtime_error("Invalid regex: trailing '\\'");
+    }
+
+    char c = pattern[0];
+    pattern.remove_prefix(1);
+
+    // Shorthand classes, uppercase is the negation
+    CharSet chars;
+    for (int i = 0; i < 256; ++i) {
+        if (std::tolower(c) == 'd') {
+            chars[i] = std::isdigit(i);
+        } else if (std::tolower(c) == 'w') {
+            chars[i] = std::isalnum(i) || i == '_';
+        } else if (std::tolower(c) == 's') {
+            chars[i] = std::isspace(i);
+        }
+    }
+
+    switch (c) {
+    case 'd':
+    case 'w':
+    case 's':
+        return chars;
+    case 'D':
+    case 'W':
+    case 'S':
+        return ~chars;
+    case 'n':
+        return CharSet().set('\n');
+    case 'r':
+        return CharSet().set('\r');
+    case 't':
+        return CharSet().set('\t');
+    default:
+        return CharSet().set(static_cast<unsigned char>(c));
+    }
+}
+
+int RegexSet::add_state(State state)
+{
+    _states.push_back(state);
+    return static_cast<int>(_states.size() - 1);
+}
+
+RegexSet::Fragment RegexSet::char_fragment(CharSet chars, bool icase)
+{
+    if (icase) {
+        for (int c = 'a'; c <= 'z'; ++c) {
+            if (chars[c] || chars[std::toupper(c)]) {
+                chars.set(c);
+                chars.set(std::toupper(c));
+            }
+        }
+    }
+
+    State state;
+    state.kind  = State::CHAR;
+    state.chars = chars;
+    int index   = this->add_state(state);
+
+    return {index, {{index, 0}}};
+}
+
+void RegexSet::patch(const Fragment& fragment, int target)
+{
+    for (const auto& [state, which] : fragment.outs) {
+        if (which == 0) {
+            _states[state].out = target;
+        } else {
+            _states[state].out1 = target;
+        }
+    }
+}
+
+void RegexSet::add_closure(std::vector<int>&  set,
+                           int                state,
+                           bool               at_end,
+                           std::vector<bool>& seen) const
+{
+    if (state == -1 || seen[state]) {
+        return;
+    }
+    seen[state] = true;
+
+    switch (_states[state].kind) {
+    case State::SPLIT:
+        this->add_closure(set, _states[state].out, at_end, seen);
+        this->add_closure(set, _states[state].out1, at_end, seen);
+        break;
+    case State::END:
+        // `$` only holds at the end of the input, resolved in `accept_end`
+        if (at_end) {
+            this->add_closure(set, _states[state].out, at_end, seen);
+        } else {
+            set.push_back(state);
+        }
+        break;
+    default:
+        set.push_back(state);
+        break;
+    }
+}
+
+int RegexSet::dstate(std::vector<int> states) const
+{
+    std::sort(states.begin(), states.end());
+
+    auto it = _dindex.find(states);
+    if (it != _dindex.end()) {
+        return it->second;
+    }
+
+    DState dstate;
+    dstate.next.fill(-1);
+    dstate.accept     = INT_MAX;
+    dstate.accept_end = INT_MAX;
+
+    std::vector<int>  at_end;
+    std::vector<bool> seen(_states.size());
+    for (int state : states) {
+        if (_states[state].kind == State::MATCH) {
+            dstate.accept = std::min(dstate.accept, _states[state].pattern);
+        } else if (_states[state].kind == State::END) {
+            this->add_closure(at_end, _states[state].out, true, seen);
+        }
+    }
+    dstate.accept_end = dstate.accept;
+    for (int state : at_end) {
+        if (_states[state].kind == State::MATCH) {
+            dstate.accept_end = std::min(dstate.accept_end, _states[state].pattern);
+        }
+    }
+
+    dstate.states = states;
+    _dstates.push_back(std::move(dstate));
+    _dindex[std::move(states)] = static_cast<int>(_dstates.size() - 1);
+
+    return static_cast<int>(_dstates.size() - 1);
+}
+
+int RegexSet::step(int dstate, unsigned char c) const
+{
+    if (_dstates[dstate].next[c] != -1) {
+        return _dstates[dstate].next[c];
+    }
+
+    std::vector<int>  states;
+    std::vector<bool> seen(_states.size());
+    for (int state : _dstates[dstate].states) {
+        if (_states[state].kind == State::CHAR && _states[state].chars[c]) {
+            this->add_closure(states, _states[state].out, false, seen);
+        }
+    }
+
+    int next                 = this->dstate(std::move(states));
+    _dstates[dstate].next[c] = next;
+    return next;
+}
+}  // namespace webserv::utils
@@ -2,11 +2,14 @@
 
 namespace webserv::utils
 {
-void free_string_array(char** array)
+std::vector<char*> c_str_array(std::vector<std::string>& strings)
 {
-    for (size_t i = 0; array[i] != nullptr; ++i) {
-        delete[] array[i];
+    std::vector<char*> array;
+    array.reserve(strings.size() + 1);
+    for (auto& string : strings) {
+        array.push_back(string.data());
     }
-    delete[] array;
+    array.push_back(nullptr);
+    return array;
 }
 }  // namespace webserv::utils
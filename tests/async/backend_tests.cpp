@@ -0,0 +1,451 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "async/EpollBackend.hpp"
+#include "async/Event.hpp"
+#include "async/UringBackend.hpp"
+
+using webserv::async::Backend;
+using webserv::async::EpollBackend;
+using webserv::async::Event;
+using webserv::async::UringBackend;
+
+namespace
+{
+using Backends = std::vector<std::pair<std::string, std::unique_ptr<Backend>>>;
+
+/// The backends the kernel supports
+Backends backends()
+{
+    Backends backends;
+    backends.emplace_back("epoll", std::make_unique<EpollBackend>());
+    try {
+        backends.emplace_back("io_uring", std::make_unique<UringBackend>());
+    } catch (const std::runtime_error&) {
+    }
+    return backends;
+}
+
+/// Returns the io_uring backend, or nothing if the kernel doesn't support it
+std::unique_ptr<UringBackend> uring()
+{
+    try {
+        return std::make_unique<UringBackend>();
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
+}
+
+/// Waits a few times, true if the fd was reported
+bool reported(Backend& backend, int fd, int waits = 5)
+{
+    for (int i = 0; i < waits; ++i) {
+        int fds[16];
+        int count = backend.wait(fds, 16, 10);
+        if (std::find(fds, fds + count, fd) != fds + count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Submits what was queued without waiting, nothing being ready yet
+void submit(Backend& backend)
+{
+    int fds[16];
+    EXPECT_EQ(backend.wait(fds, 16, 0), 0);
+}
+
+/// A pair of file descriptors, a pipe or connected sockets, closed at the end of the test
+struct Pair
+{
+    int fds[2];
+
+    explicit Pair(bool sockets = false)
+    {
+        int type   = SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC;
+        int result = sockets ? socketpair(AF_UNIX, type, 0, fds) : pipe2(fds, O_NONBLOCK | O_CLOEXEC);
+        if (result == -1) {
+            throw std::runtime_error("pair");
+        }
+    }
+
+    ~Pair()
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void write(const char* data) { ASSERT_GT(::write(fds[1], data, strlen(data)), 0); }
+
+    void drain()
+    {
+        char buffer[64];
+        while (::read(fds[0], buffer, sizeof(buffer)) > 0) {
+        }
+    }
+};
+
+/// Takes what the backend received, as long as it has some, or nothing if it doesn't receive
+std::optional<std::string> receive(Backend& backend, int fd)
+{
+    std::string received;
+    char        buffer[64];
+    while (true) {
+        std::optional<ssize_t> bytes = backend.receive(fd, buffer, sizeof(buffer));
+        if (!bytes) {
+            return std::nullopt;
+        }
+        if (*bytes <= 0) {
+            return received;
+        }
+        received.append(buffer, *bytes);
+    }
+}
+
+/// Returns the io_uring backend if it receives on its own, nothing otherwise
+std::unique_ptr<UringBackend> receiver()
+{
+    std::unique_ptr<UringBackend> backend = uring();
+    if (backend == nullptr) {
+        return nullptr;
+    }
+    Pair sockets(true);
+    backend->watch(sockets.fds[0], Event::RECEIVE);
+    sockets.write("Hello");
+    bool received = reported(*backend, sockets.fds[0]) && receive(*backend, sockets.fds[0]);
+    backend->remove(sockets.fds[0]);
+    return received ? std::move(backend) : nullptr;
+}
+}  // namespace
+
+TEST(BackendTests, WatchRearmRemove)
+{
+    for (auto& [name, backend] : backends()) {
+        SCOPED_TRACE(name);
+
+        Pair pipe;
+        int  fd = pipe.fds[0];
+        backend->watch(fd, Event::READABLE);
+        EXPECT_FALSE(reported(*backend, fd, 2));
+
+        pipe.write("Hello");
+        EXPECT_TRUE(reported(*backend, fd));
+
+        // Watched again once it was handled
+        pipe.drain();
+        backend->rearm(fd);
+        pipe.write("Hello");
+        EXPECT_TRUE(reported(*backend, fd));
+
+        pipe.drain();
+        backend->remove(fd);
+        pipe.write("Hello");
+        EXPECT_FALSE(reported(*backend, fd, 3));
+
+        // And after it was removed, by a new watch
+        backend->watch(fd, Event::READABLE);
+        EXPECT_TRUE(reported(*backend, fd));
+        backend->remove(fd);
+    }
+}
+
+TEST(BackendTests, Writable)
+{
+    for (auto& [name, backend] : backends()) {
+        SCOPED_TRACE(name);
+
+        // Replacing what it is watched for
+        Pair pipe;
+        int  fd = pipe.fds[1];
+        backend->watch(fd, Event::READABLE);
+        EXPECT_FALSE(reported(*backend, fd, 2));
+        backend->watch(fd, Event::WRITABLE);
+        EXPECT_TRUE(reported(*backend, fd));
+        backend->remove(fd);
+    }
+}
+
+TEST(BackendTests, Reuse)
+{
+    for (auto& [name, backend] : backends()) {
+        SCOPED_TRACE(name);
+
+        // The old pipe gets ready after the wait submitted its watch, and is closed
+        auto old = std::make_unique<Pair>();
+        int  fd  = old->fds[0];
+        backend->watch(fd, Event::READABLE);
+        submit(*backend);
+        old->write("Hello");
+        backend->remove(fd);
+        old.reset();
+
+        // The lowest free fds are reused
+        Pair pipe;
+        ASSERT_EQ(pipe.fds[0], fd);
+        backend->watch(fd, Event::READABLE);
+        EXPECT_FALSE(reported(*backend, fd, 3));
+
+        pipe.write("Hello");
+        EXPECT_TRUE(reported(*backend, fd));
+        backend->remove(fd);
+    }
+}
+
+TEST(BackendTests, Unsupported)
+{
+    // Epoll leaves accepting and reading to the caller
+    EpollBackend backend;
+    Pair         sockets(true);
+    char         buffer[16];
+    backend.watch(sockets.fds[0], Event::RECEIVE);
+    EXPECT_FALSE(backend.accept(sockets.fds[0]).has_value());
+    EXPECT_FALSE(backend.receive(sockets.fds[0], buffer, sizeof(buffer)).has_value());
+    sockets.write("Hello");
+    EXPECT_TRUE(reported(backend, sockets.fds[0]));
+    backend.remove(sockets.fds[0]);
+}
+
+TEST(BackendTests, Receive)
+{
+    std::unique_ptr<UringBackend> backend = uring();
+    if (backend == nullptr) {
+        GTEST_SKIP() << "io_uring isn't supported";
+    }
+
+    Pair sockets(true);
+    int  fd = sockets.fds[0];
+    char buffer[16];
+    backend->watch(fd, Event::RECEIVE);
+    EXPECT_FALSE(reported(*backend, fd, 2));
+    // A multishot receive is in flight, the caller doesn't read itself
+    std::optional<ssize_t> bytes = backend->receive(fd, buffer, sizeof(buffer));
+    if (!bytes) {
+        // Before Linux 6.0, it is polled and the caller reads itself
+        sockets.write("Hello");
+        EXPECT_TRUE(reported(*backend, fd));
+        EXPECT_EQ(::read(fd, buffer, sizeof(buffer)), 5);
+        backend->remove(fd);
+        GTEST_SKIP() << "io_uring lacks multishot receive";
+    }
+    EXPECT_EQ(*bytes, -1);
+    EXPECT_EQ(errno, EAGAIN);
+
+    sockets.write("Hello");
+    EXPECT_TRUE(reported(*backend, fd));
+    EXPECT_EQ(receive(*backend, fd), "Hello");
+
+    // Taken in parts by a smaller buffer
+    sockets.write("Hello, World!");
+    EXPECT_TRUE(reported(*backend, fd));
+    EXPECT_EQ(backend->receive(fd, buffer, 5), 5);
+    EXPECT_EQ(std::string(buffer, 5), "Hello");
+    EXPECT_EQ(receive(*backend, fd), ", World!");
+
+    // Received while suspended, and reported when watched again
+    backend->suspend(fd);
+    sockets.write("Hello");
+    EXPECT_FALSE(reported(*backend, fd, 3));
+    backend->watch(fd, Event::WRITABLE);
+    EXPECT_TRUE(reported(*backend, fd));
+    backend->watch(fd, Event::RECEIVE);
+    EXPECT_TRUE(reported(*backend, fd, 1));
+    EXPECT_EQ(receive(*backend, fd), "Hello");
+
+    // The end of the stream
+    shutdown(sockets.fds[1], SHUT_WR);
+    EXPECT_TRUE(reported(*backend, fd));
+    EXPECT_EQ(backend->receive(fd, buffer, sizeof(buffer)), 0);
+    backend->remove(fd);
+    EXPECT_FALSE(backend->receive(fd, buffer, sizeof(buffer)).has_value());
+}
+
+TEST(BackendTests, ReceiveReuse)
+{
+    std::unique_ptr<UringBackend> backend = receiver();
+    if (backend == nullptr) {
+        GTEST_SKIP() << "io_uring lacks multishot receive";
+    }
+
+    // What the old connection received after it was removed isn't the new one's
+    auto old = std::make_unique<Pair>(true);
+    int  fd  = old->fds[0];
+    backend->watch(fd, Event::RECEIVE);
+    submit(*backend);
+    old->write("Old");
+    backend->remove(fd);
+    old.reset();
+
+    Pair sockets(true);
+    ASSERT_EQ(sockets.fds[0], fd);
+    backend->watch(fd, Event::RECEIVE);
+    EXPECT_FALSE(reported(*backend, fd, 3));
+    sockets.write("New");
+    EXPECT_TRUE(reported(*backend, fd));
+    EXPECT_EQ(receive(*backend, fd), "New");
+
+    // Every buffer is handed back, more than the ring holds go through
+    std::string sent(UringBackend::BUFFER_SIZE * 2, 'x');
+    std::string received;
+    for (unsigned i = 0; i < UringBackend::BUFFERS; ++i) {
+        ASSERT_EQ(::write(sockets.fds[1], sent.data(), sent.size()), ssize_t(sent.size()));
+        while (received.size() < sent.size() * (i + 1) && reported(*backend, fd)) {
+            received += receive(*backend, fd).value_or("");
+        }
+    }
+    EXPECT_EQ(received.size(), sent.size() * UringBackend::BUFFERS);
+    backend->remove(fd);
+}
+
+TEST(BackendTests, ReceiveLimit)
+{
+    std::unique_ptr<UringBackend> backend = receiver();
+    if (backend == nullptr) {
+        GTEST_SKIP() << "io_uring lacks multishot receive";
+    }
+
+    // A suspended connection keeps receiving, up to its share of the buffers
+    Pair        idle(true);
+    int         fd = idle.fds[0];
+    std::string sent;
+    backend->watch(fd, Event::RECEIVE);
+    submit(*backend);
+    backend->suspend(fd);
+    for (unsigned i = 0; i < UringBackend::BUFFERS * 2; ++i) {
+        std::string chunk(UringBackend::BUFFER_SIZE, char('a' + i % 26));
+        ssize_t     written = ::write(idle.fds[1], chunk.data(), chunk.size());
+        if (written > 0) {
+            sent.append(chunk, 0, written);
+        }
+        submit(*backend);
+    }
+
+    // So another one still gets buffers
+    Pair other(true);
+    backend->watch(other.fds[0], Event::RECEIVE);
+    other.write("Hello");
+    EXPECT_TRUE(reported(*backend, other.fds[0]));
+    EXPECT_EQ(receive(*backend, other.fds[0]), "Hello");
+    backend->remove(other.fds[0]);
+
+    // And the first one loses nothing of what it was sent, in order
+    std::string received;
+    backend->watch(fd, Event::RECEIVE);
+    for (int i = 0; i < 1000 && received.size() < sent.size(); ++i) {
+        reported(*backend, fd, 1);
+        // Once its receive ended, the caller reads itself until it is armed again
+        char    buffer[UringBackend::BUFFER_SIZE];
+        ssize_t bytes;
+        do {
+            std::optional<ssize_t> taken = backend->receive(fd, buffer, sizeof(buffer));
+            bytes = taken ? *taken : ::read(fd, buffer, sizeof(buffer));
+            received.append(buffer, std::max<ssize_t>(bytes, 0));
+        } while (bytes > 0);
+        backend->rearm(fd);
+    }
+    EXPECT_EQ(received.size(), sent.size());
+    EXPECT_TRUE(received == sent);
+    backend->remove(fd);
+}
+
+TEST(BackendTests, Accept)
+{
+    std::unique_ptr<UringBackend> backend = uring();
+    if (backend == nullptr) {
+        GTEST_SKIP() << "io_uring isn't supported";
+    }
+
+    int         listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in address  = {};
+    socklen_t   length   = sizeof(address);
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(listen(listener, 8), 0);
+    ASSERT_EQ(getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+
+    backend->watch(listener, Event::ACCEPT);
+    EXPECT_FALSE(reported(*backend, listener, 2));
+    if (!backend->accept(listener)) {
+        GTEST_SKIP() << "io_uring lacks multishot accept";
+    }
+
+    int clients[3];
+    for (int& client : clients) {
+        client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ASSERT_EQ(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    }
+    EXPECT_TRUE(reported(*backend, listener));
+
+    // The connections are accepted non-blocking, one at a time
+    std::vector<int> accepted;
+    for (int i = 0; i < 10 && accepted.size() < 2; ++i) {
+        std::optional<int> fd = backend->accept(listener);
+        ASSERT_TRUE(fd);
+        if (*fd == -1) {
+            EXPECT_EQ(errno, EAGAIN);
+            reported(*backend, listener, 1);
+            continue;
+        }
+        EXPECT_TRUE(fcntl(*fd, F_GETFL) & O_NONBLOCK);
+        EXPECT_TRUE(fcntl(*fd, F_GETFD) & FD_CLOEXEC);
+        accepted.push_back(*fd);
+    }
+    EXPECT_EQ(accepted.size(), 2);
+
+    // The last one is accepted while suspended too, and closed when it is removed
+    backend->suspend(listener);
+    reported(*backend, listener, 2);
+    backend->remove(listener);
+    submit(*backend);
+    close(listener);
+    char byte;
+    EXPECT_LE(::read(clients[2], &byte, 1), 0);
+
+    for (int fd : accepted) {
+        close(fd);
+    }
+    for (int client : clients) {
+        close(client);
+    }
+}
+
+TEST(BackendTests, Stop)
+{
+    std::unique_ptr<UringBackend> backend = receiver();
+    if (backend == nullptr) {
+        GTEST_SKIP() << "io_uring lacks multishot receive";
+    }
+
+    Pair sockets(true);
+    int  fd = sockets.fds[0];
+    backend->watch(fd, Event::RECEIVE);
+    sockets.write("Hello");
+    EXPECT_TRUE(reported(*backend, fd));
+    backend->suspend(fd);
+    sockets.write(", World!");
+    reported(*backend, fd, 2);
+
+    // What wasn't taken is handed over, in order
+    std::string leftover;
+    backend->stop([&leftover, fd](const Backend::Completion& completion) {
+        EXPECT_EQ(completion.fd, fd);
+        EXPECT_EQ(completion.type, uint32_t(Event::RECEIVE));
+        leftover.append(completion.data);
+    });
+    EXPECT_EQ(leftover, "Hello, World!");
+}
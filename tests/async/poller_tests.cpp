@@ -0,0 +1,374 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async/Poller.hpp"
+#include "async/Promise.hpp"
+
+using webserv::async::Event;
+using webserv::async::Poller;
+using webserv::async::Promise;
+using Engine = Poller::Engine;
+
+namespace
+{
+/// Runs the event loop until a condition holds, for at most a second
+template <typename Condition>
+bool poll_until(Condition condition)
+{
+    for (int i = 0; i < 100 && !condition(); ++i) {
+        Poller::instance().poll();
+    }
+    return condition();
+}
+
+/// The engines the kernel supports, epoll is left in use
+std::vector<Engine> engines()
+{
+    std::vector<Engine> engines = {Engine::EPOLL};
+    if (Poller::instance().set_engine(Engine::IO_URING) == Engine::IO_URING) {
+        engines.push_back(Engine::IO_URING);
+    }
+    Poller::instance().set_engine(Engine::EPOLL);
+    return engines;
+}
+
+/// A non-blocking pipe, closed at the end of the test
+struct Pipe
+{
+    int fds[2];
+
+    Pipe()
+    {
+        if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == -1) {
+            throw std::runtime_error("pipe2");
+        }
+    }
+
+    ~Pipe()
+    {
+        Poller::instance().remove(fds[0]);
+        Poller::instance().remove(fds[1]);
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    /// Reads what was written, until the pipe is drained
+    Promise<int> read()
+    {
+        int fd = fds[0];
+        return Promise<int>(
+            [fd]() -> std::optional<int> {
+                char    buffer[64];
+                ssize_t bytes = ::read(fd, buffer, sizeof(buffer));
+                if (bytes == -1) {
+                    return std::nullopt;
+                }
+                return int(bytes);
+            },
+            fd,
+            Event::READABLE);
+    }
+
+    void write(const char* data) { ASSERT_GT(::write(fds[1], data, strlen(data)), 0); }
+};
+}  // namespace
+
+TEST(PollerTests, EngineOf)
+{
+    EXPECT_EQ(Poller::engine_of("epoll"), Engine::EPOLL);
+    EXPECT_EQ(Poller::engine_of("io_uring"), Engine::IO_URING);
+    EXPECT_THROW(Poller::engine_of("kqueue"), std::runtime_error);
+    EXPECT_EQ(Poller::name(Engine::IO_URING), "io_uring");
+}
+
+TEST(PollerTests, Readable)
+{
+    for (Engine engine : engines()) {
+        SCOPED_TRACE(Poller::name(engine));
+        Poller::instance().set_engine(engine);
+
+        Pipe pipe;
+        int  read = 0;
+        pipe.read().then([&read](int bytes) { read += bytes; });
+        Poller::instance().poll();
+        EXPECT_EQ(read, 0);
+
+        pipe.write("Hello");
+        EXPECT_TRUE(poll_until([&read] { return read == 5; }));
+
+        // Each promise is resolved once
+        pipe.write("Hello");
+        for (int i = 0; i < 5; ++i) {
+            Poller::instance().poll();
+        }
+        EXPECT_EQ(read, 5);
+    }
+    Poller::instance().set_engine(Engine::EPOLL);
+}
+
+TEST(PollerTests, Pending)
+{
+    for (Engine engine : engines()) {
+        SCOPED_TRACE(Poller::name(engine));
+        Poller::instance().set_engine(engine);
+
+        // Resolved on the third message, waiting again after the first two
+        Pipe pipe;
+        int  fd       = pipe.fds[0];
+        int  messages = 0;
+        bool done     = false;
+        Promise<bool>(
+            [fd, &messages]() -> std::optional<bool> {
+                char buffer[64];
+                while (::read(fd, buffer, sizeof(buffer)) > 0) {
+                    ++messages;
+                }
+                return messages >= 3 ? std::optional<bool>(true) : std::nullopt;
+            },
+            fd,
+            Event::READABLE)
+            .then([&done](bool) { done = true; });
+
+        for (int i = 0; i < 3; ++i) {
+            pipe.write("Hello");
+            EXPECT_TRUE(poll_until([&messages, i] { return messages == i + 1; }));
+        }
+        EXPECT_TRUE(done);
+    }
+    Poller::instance().set_engine(Engine::EPOLL);
+}
+
+TEST(PollerTests, Remove)
+{
+    for (Engine engine : engines()) {
+        SCOPED_TRACE(Poller::name(engine));
+        Poller::instance().set_engine(engine);
+
+        Pipe pipe;
+        bool called = false;
+        pipe.read().then([&called](int) { called = true; });
+        Poller::instance().remove(pipe.fds[0]);
+
+        pipe.write("Hello");
+        for (int i = 0; i < 5; ++i) {
+            Poller::instance().poll();
+        }
+        EXPECT_FALSE(called);
+
+        // Watched again by a new promise
+        pipe.read().then([&called](int) { called = true; });
+        EXPECT_TRUE(poll_until([&called] { return called; }));
+    }
+    Poller::instance().set_engine(Engine::EPOLL);
+}
+
+TEST(PollerTests, Replace)
+{
+    for (Engine engine : engines()) {
+        SCOPED_TRACE(Poller::name(engine));
+        Poller::instance().set_engine(engine);
+
+        Pipe pipe;
+        int  first = 0, second = 0;
+        pipe.read().then([&first](int) { ++first; });
+        pipe.read().then([&second](int) { ++second; });
+
+        pipe.write("Hello");
+        EXPECT_TRUE(poll_until([&second] { return second == 1; }));
+        EXPECT_EQ(first, 0);
+    }
+    Poller::instance().set_engine(Engine::EPOLL);
+}
+
+TEST(PollerTests, SetEngine)
+{
+    std::vector<Engine> supported = engines();
+    if (supported.size() < 2) {
+        GTEST_SKIP() << "io_uring isn't supported";
+    }
+
+    // A promise waiting across switches is kept
+    Pipe pipe;
+    bool called = false;
+    pipe.read().then([&called](int) { called = true; });
+    EXPECT_EQ(Poller::instance().set_engine(Engine::IO_URING), Engine::IO_URING);
+    Poller::instance().poll();
+    EXPECT_EQ(Poller::instance().set_engine(Engine::EPOLL), Engine::EPOLL);
+    EXPECT_EQ(Poller::instance().set_engine(Engine::IO_URING), Engine::IO_URING);
+    EXPECT_FALSE(called);
+
+    pipe.write("Hello");
+    EXPECT_TRUE(poll_until([&called] { return called; }));
+
+    // Posted callbacks still wake the loop
+    bool posted = false;
+    Poller::instance().post([&posted] { posted = true; });
+    EXPECT_TRUE(poll_until([&posted] { return posted; }));
+    Poller::instance().set_engine(Engine::EPOLL);
+}
+
+TEST(PollerTests, SetEngineCarries)
+{
+    std::vector<Engine> supported = engines();
+    if (supported.size() < 2) {
+        GTEST_SKIP() << "io_uring isn't supported";
+    }
+
+    int         listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in address  = {};
+    socklen_t   length   = sizeof(address);
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(listen(listener, 8), 0);
+    ASSERT_EQ(getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+
+    std::vector<int> accepted;
+
+    auto accept = [listener, &accepted] {
+        Promise<int>(
+            [listener]() -> std::optional<int> {
+                sockaddr_in peer;
+                int         fd = Poller::instance().accept(listener, peer);
+                return fd == -1 ? std::nullopt : std::optional<int>(fd);
+            },
+            listener,
+            Event::ACCEPT)
+            .then([&accepted](int fd) { accepted.push_back(fd); });
+    };
+    int clients[3];
+
+    auto connect = [&address](int& client) {
+        client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ASSERT_EQ(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    };
+
+    Pipe        pipe;
+    int         sockets[2];
+    std::string received;
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sockets), 0);
+
+    auto receive = [fd = sockets[0], &received] {
+        Promise<int>(
+            [fd, &received]() -> std::optional<int> {
+                char    buffer[64];
+                ssize_t bytes = Poller::instance().receive(fd, buffer, sizeof(buffer));
+                if (bytes <= 0) {
+                    return std::nullopt;
+                }
+                received.append(buffer, bytes);
+                return int(bytes);
+            },
+            fd,
+            Event::RECEIVE)
+            .then([](int) {});
+    };
+
+    Poller::instance().set_engine(Engine::IO_URING);
+    bool called = false;
+    pipe.read().then([&called](int) { called = true; });
+    connect(clients[0]);
+    accept();
+    EXPECT_TRUE(poll_until([&accepted] { return accepted.size() == 1; }));
+    ASSERT_EQ(::write(sockets[1], "Hello", 5), 5);
+    receive();
+    EXPECT_TRUE(poll_until([&received] { return received == "Hello"; }));
+
+    // Accepted and received between promises, where the engine does it on its own
+    connect(clients[1]);
+    ASSERT_EQ(::write(sockets[1], ", World!", 8), 8);
+    for (int i = 0; i < 5; ++i) {
+        Poller::instance().poll();
+    }
+
+    // And taken after the switch, with the promises waiting all along
+    EXPECT_EQ(Poller::instance().set_engine(Engine::EPOLL), Engine::EPOLL);
+    accept();
+    receive();
+    EXPECT_TRUE(poll_until([&] { return accepted.size() == 2 && received == "Hello, World!"; }));
+    connect(clients[2]);
+    accept();
+    EXPECT_TRUE(poll_until([&accepted] { return accepted.size() == 3; }));
+    EXPECT_FALSE(called);
+    pipe.write("Hello");
+    EXPECT_TRUE(poll_until([&called] { return called; }));
+
+    Poller::instance().remove(listener);
+    Poller::instance().remove(sockets[0]);
+    for (int fd : accepted) {
+        close(fd);
+    }
+    for (int client : clients) {
+        close(client);
+    }
+    close(sockets[0]);
+    close(sockets[1]);
+    close(listener);
+}
+
+TEST(PollerTests, SlowCallback)
+{
+    // A loopback connection, whose accepted end is closed by its callback
+    int         listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address  = {};
+    socklen_t   length   = sizeof(address);
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(listen(listener, 1), 0);
+    ASSERT_EQ(getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+
+    int client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_EQ(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    int server = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    ASSERT_NE(server, -1);
+
+    std::optional<std::string> peer;
+    Poller::instance().set_slow_callback(
+        std::chrono::milliseconds(1),
+        [&peer, server](int fd, const sockaddr_in* address, std::chrono::microseconds) {
+            if (fd == server) {
+                char buffer[INET_ADDRSTRLEN] = "";
+                if (address != nullptr) {
+                    inet_ntop(AF_INET, &address->sin_addr, buffer, sizeof(buffer));
+                }
+                peer = buffer;
+            }
+        });
+
+    bool closed = false;
+    Promise<bool>(
+        [server]() -> std::optional<bool> {
+            char buffer[64];
+            if (::read(server, buffer, sizeof(buffer)) == -1) {
+                return std::nullopt;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            Poller::instance().remove(server);
+            close(server);
+            return true;
+        },
+        server,
+        Event::READABLE)
+        .then([&closed](bool) { closed = true; });
+
+    ASSERT_EQ(::write(client, "Hello", 5), 5);
+    EXPECT_TRUE(poll_until([&closed] { return closed; }));
+    EXPECT_EQ(peer, "127.0.0.1");
+
+    Poller::instance().set_slow_callback(std::chrono::microseconds(0), nullptr);
+    close(client);
+    close(listener);
+}
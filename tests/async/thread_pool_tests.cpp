@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async/Poller.hpp"
+#include "async/ThreadPool.hpp"
+
+using webserv::async::Poller;
+using webserv::async::ThreadPool;
+
+namespace
+{
+/// Runs the event loop until a condition holds, for at most a second
+template <typename Condition>
+bool poll_until(Condition condition)
+{
+    for (int i = 0; i < 100 && !condition(); ++i) {
+        Poller::instance().poll();
+    }
+    return condition();
+}
+}  // namespace
+
+TEST(ThreadPoolTests, Post)
+{
+    std::vector<int> order;
+    std::thread      thread([&order] {
+        for (int i = 0; i < 3; ++i) {
+            Poller::instance().post([&order, i] { order.push_back(i); });
+        }
+    });
+    thread.join();
+
+    EXPECT_TRUE(order.empty());
+    EXPECT_TRUE(poll_until([&order] { return order.size() == 3; }));
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(ThreadPoolTests, Submit)
+{
+    std::thread::id loop = std::this_thread::get_id();
+    std::thread::id worker;
+    bool            done = false;
+
+    ThreadPool::instance().submit([&worker] { worker = std::this_thread::get_id(); },
+                                  [&done, loop] {
+                                      EXPECT_EQ(std::this_thread::get_id(), loop);
+                                      done = true;
+                                  });
+    EXPECT_TRUE(poll_until([&done] { return done; }));
+    EXPECT_NE(worker, loop);
+}
+
+TEST(ThreadPoolTests, Run)
+{
+    auto task = ThreadPool::instance().run<std::string>([] { return std::string("done"); });
+    EXPECT_FALSE(task->ready());
+    ASSERT_TRUE(poll_until([&task] { return task->ready(); }));
+    ASSERT_NE(task->value(), nullptr);
+    EXPECT_EQ(*task->value(), "done");
+
+    auto failed = ThreadPool::instance().run<int>([]() -> int { throw std::runtime_error("x"); });
+    ASSERT_TRUE(poll_until([&failed] { return failed->ready(); }));
+    EXPECT_EQ(failed->value(), nullptr);
+}
+
+TEST(ThreadPoolTests, Overflow)
+{
+    // Blocks the workers so the queue fills up
+    std::atomic<bool> release = false;
+    std::atomic<int>  ran     = 0;
+    int               done    = 0;
+    size_t            jobs    = ThreadPool::THREADS + ThreadPool::MAX_QUEUED + 10;
+
+    for (size_t i = 0; i < jobs; ++i) {
+        ThreadPool::instance().submit(
+            [&release, &ran, i] {
+                while (i < ThreadPool::THREADS && !release) {
+                    std::this_thread::yield();
+                }
+                ++ran;
+            },
+            [&done] { ++done; });
+    }
+    EXPECT_LE(ThreadPool::instance().queued(), ThreadPool::MAX_QUEUED);
+    // The jobs that didn't fit ran right away
+    EXPECT_GE(ran, 10);
+
+    release = true;
+    EXPECT_TRUE(poll_until([&done, jobs] { return done == int(jobs); }));
+    EXPECT_EQ(ran, int(jobs));
+    EXPECT_EQ(ThreadPool::instance().queued(), 0);
+}
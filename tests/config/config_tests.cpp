@@ -131,3 +131,69 @@ TEST(ConfigTests, Location)
     EXPECT_EQ(location2.index(), "index.php");
     EXPECT_EQ(location2.autoindex(), false);
 }
+
+TEST(ConfigTests, ResolvedLocation)
+{
+    Config config("tests/conf/location.conf");
+
+    auto& server = *config.get_children()[0]->get_children()[0];
+
+    const auto& location = server.location("/1").resolved();
+    EXPECT_EQ(location.root, "/www");
+    EXPECT_EQ(location.index, "index.html");
+    EXPECT_EQ(location.upload_dir, "/www/upload/");
+    EXPECT_EQ(location.autoindex, true);
+    EXPECT_EQ(location.client_max_body_size, 1048576u);
+    EXPECT_TRUE(location.methods.all());
+
+    const auto& location2 = server.location("/2").resolved();
+    EXPECT_EQ(location2.root, "/www/2");
+    EXPECT_EQ(location2.index, "index.php");
+    EXPECT_EQ(location2.client_max_body_size, 10u);
+    EXPECT_TRUE(location2.allows(0));
+    EXPECT_FALSE(location2.allows(1));
+    EXPECT_TRUE(location2.allows(2));
+    EXPECT_EQ(location2.access_log, nullptr);
+
+    // Inherited values are shared, not copied
+    EXPECT_EQ(&location.upload_dir, &location2.upload_dir);
+    EXPECT_EQ(&server.location("/1").resolved(), &location);
+}
+
+TEST(ConfigTests, LongestPrefixLocation)
+{
+    Config config("tests/conf/prefix.conf");
+
+    auto& server = *config.get_children()[0]->get_children()[0];
+
+    EXPECT_EQ(server.location("/").root(), "/www");
+    EXPECT_EQ(server.location("/index.html").root(), "/www");
+    EXPECT_EQ(server.location("/a").root(), "/www");
+    EXPECT_EQ(server.location("/a/").root(), "/a");
+    EXPECT_EQ(server.location("/a/file").root(), "/a");
+    EXPECT_EQ(server.location("/a/b/").root(), "/ab");
+    EXPECT_EQ(server.location("/a/b/c").root(), "/abc");
+    EXPECT_EQ(server.location("/a/b/x").root(), "/ab");
+    EXPECT_EQ(server.location("/y/z/file").root(), "/xy");
+    EXPECT_EQ(server.location("/y/file").root(), "/www");
+
+    // No location matches
+    EXPECT_EQ(&server.location("*"), &server);
+}
+
+TEST(ConfigTests, RegexLocation)
+{
+    Config config("tests/conf/prefix.conf");
+
+    auto& server = *config.get_children()[0]->get_children()[0];
+
+    EXPECT_EQ(server.location("/a/script.py").root(), "/cgi");
+    EXPECT_EQ(server.location("/script.py.txt").root(), "/www");
+    EXPECT_EQ(server.location("/a/b/photo.JPG").root(), "/images");
+    EXPECT_EQ(server.location("/photo.png").root(), "/images");
+
+    // Exact locations win over regex locations, which win over prefixes
+    EXPECT_EQ(server.location("/a/b/c").root(), "/abc");
+    EXPECT_EQ(server.location("/a/b/cd").root(), "/regex");
+    EXPECT_EQ(server.location("/a/b/c/d.py").root(), "/cgi");
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "async/Poller.hpp"
+#include "http/Autoindex.hpp"
+#include "http/Response.hpp"
+
+using namespace webserv::http;
+using Format = Autoindex::Format;
+
+namespace
+{
+/// A directory with a file, a subdirectory and a hidden .gitignore
+std::string make_directory(const std::string& name)
+{
+    std::string path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path + "/sub");
+    std::ofstream(path + "/b.txt") << "Hello";
+    std::ofstream(path + "/.gitignore") << "*";
+    return path;
+}
+
+/// Sets the modification time of a directory, so its listing isn't considered
+/// as possibly changed within the same timestamp
+void set_mtime(const std::string& path, time_t mtime)
+{
+    timespec times[2] = {{mtime, 0}, {mtime, 0}};
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+/// Runs the event loop until the thread pool has read the directory
+std::shared_ptr<const Autoindex::Scan> wait(std::shared_ptr<const Autoindex::Scan> scan)
+{
+    for (int i = 0; i < 100 && !scan->ready(); ++i) {
+        webserv::async::Poller::instance().poll();
+    }
+    return scan;
+}
+}  // namespace
+
+TEST(AutoindexTests, Read)
+{
+    std::string path = make_directory("webserv_autoindex_read");
+
+    Autoindex::Listing listing;
+    ASSERT_TRUE(Autoindex::read(path, listing));
+    ASSERT_EQ(listing.size(), 2);
+    EXPECT_EQ(listing[0].name, "b.txt");
+    EXPECT_FALSE(listing[0].is_dir);
+    EXPECT_EQ(listing[0].size, 5);
+    EXPECT_EQ(listing[1].name, "sub");
+    EXPECT_TRUE(listing[1].is_dir);
+
+    EXPECT_FALSE(Autoindex::read(path + "/missing", listing));
+    std::filesystem::remove_all(path);
+}
+
+TEST(AutoindexTests, Render)
+{
+    Autoindex::Listing listing = {
+        {"a<b>.txt", false, 12, 0},
+        {"dir", true, 4096, 86400},
+    };
+    Autoindex::Page all = {1, 0};
+
+    std::string html = Autoindex::render(listing, Format::HTML, "/files/", all);
+    EXPECT_NE(html.find("<title>Index of /files/</title>"), std::string::npos);
+    EXPECT_NE(html.find("<li><a href=\"/files/a%3Cb%3E.txt\">a&lt;b&gt;.txt</a></li>"),
+              std::string::npos);
+    EXPECT_NE(html.find("<li><a href=\"/files/dir/\">dir</a></li>"), std::string::npos);
+
+    // The path segment is percent-encoded, the link text only escaped
+    Autoindex::Listing odd = {{"a #1?%.txt", false, 1, 0}};
+    EXPECT_NE(Autoindex::render(odd, Format::HTML, "/my files/", all)
+                  .find("<li><a href=\"/my%20files/a%20%231%3F%25.txt\">a #1?%.txt</a></li>"),
+              std::string::npos);
+
+    std::string html_template = "{{URI}}: {{DIRECTORY_ENTRIES}}{{X}}";
+    EXPECT_EQ(Autoindex::render(listing, Format::HTML, "/f/", all, html_template),
+              "/f/: <li><a href=\"/f/a%3Cb%3E.txt\">a&lt;b&gt;.txt</a></li>\n"
+              "<li><a href=\"/f/dir/\">dir</a></li>\n{{X}}");
+
+    EXPECT_EQ(Autoindex::render(listing, Format::JSON, "/", all),
+              "[\n"
+              "{ \"name\":\"a<b>.txt\", \"type\":\"file\", "
+              "\"mtime\":\"Thu, 01 Jan 1970 00:00:00 GMT\", \"size\":12 },\n"
+              "{ \"name\":\"dir\", \"type\":\"directory\", "
+              "\"mtime\":\"Fri, 02 Jan 1970 00:00:00 GMT\" }\n"
+              "]\n");
+
+    EXPECT_EQ(Autoindex::render(listing, Format::XML, "/", all),
+              "<?xml version=\"1.0\"?>\n<list>\n"
+              "<file mtime=\"1970-01-01T00:00:00Z\" size=\"12\">a&lt;b&gt;.txt</file>\n"
+              "<directory mtime=\"1970-01-02T00:00:00Z\">dir</directory>\n"
+              "</list>\n");
+}
+
+TEST(AutoindexTests, Pages)
+{
+    EXPECT_EQ(Autoindex::page_of("", 10).number, 1);
+    EXPECT_EQ(Autoindex::page_of("sort=name&page=3", 10).number, 3);
+    EXPECT_EQ(Autoindex::page_of("page=0", 10).number, 1);
+    EXPECT_EQ(Autoindex::page_of("page=x", 10).number, 1);
+
+    Autoindex::Listing listing;
+    for (char c = 'a'; c <= 'e'; ++c) {
+        listing.push_back({std::string(1, c), false, 0, 0});
+    }
+    EXPECT_EQ(Autoindex::render(listing, Format::XML, "/", {2, 2}),
+              "<?xml version=\"1.0\"?>\n<list>\n"
+              "<file mtime=\"1970-01-01T00:00:00Z\" size=\"0\">c</file>\n"
+              "<file mtime=\"1970-01-01T00:00:00Z\" size=\"0\">d</file>\n"
+              "</list>\n");
+    EXPECT_EQ(Autoindex::render(listing, Format::JSON, "/", {1000000, 2}), "[\n]\n");
+
+    std::string html = Autoindex::render(listing, Format::HTML, "/", {2, 2});
+    EXPECT_NE(html.find("<a href=\"?page=1\">Previous</a>"), std::string::npos);
+    EXPECT_NE(html.find("<a href=\"?page=3\">Next</a>"), std::string::npos);
+    html = Autoindex::render(listing, Format::HTML, "/", {3, 2});
+    EXPECT_EQ(html.find("Next"), std::string::npos);
+}
+
+TEST(AutoindexTests, Cache)
+{
+    std::string path = make_directory("webserv_autoindex_cache");
+    set_mtime(path, 1000000000);
+
+    auto first = wait(Autoindex::list(path));
+    ASSERT_TRUE(first->ready());
+    ASSERT_NE(first->listing(), nullptr);
+    EXPECT_EQ(first->listing()->size(), 2);
+
+    // Reused until the directory changes
+    EXPECT_EQ(Autoindex::list(path), first);
+
+    std::ofstream(path + "/c.txt") << "";
+    set_mtime(path, 1000000001);
+    auto second = wait(Autoindex::list(path));
+    EXPECT_NE(second, first);
+    ASSERT_TRUE(second->ready());
+    EXPECT_EQ(second->listing()->size(), 3);
+
+    // Modified just now, it may change again within the same timestamp
+    std::filesystem::remove(path + "/c.txt");
+    auto third = wait(Autoindex::list(path));
+    EXPECT_EQ(third->listing()->size(), 2);
+    EXPECT_NE(Autoindex::list(path), third);
+
+    EXPECT_THROW(Autoindex::list(path + "/b.txt"), Response::StatusCode);
+    std::filesystem::remove_all(path);
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "async/Poller.hpp"
+#include "http/Cache.hpp"
+#include "net/Upstream.hpp"
+
+using namespace webserv::http;
+using webserv::async::Poller;
+using webserv::net::Upstream;
+using Lookup = Cache::Lookup;
+
+static const std::string RESPONSE = "HTTP/1.1 200 OK\r\n"
+                                    "Cache-Control: max-age=60, stale-while-revalidate=30\r\n"
+                                    "Content-Length: 5\r\n"
+                                    "\r\n"
+                                    "Hello";
+
+TEST(CacheTests, Freshness)
+{
+    time_t stale = 0;
+
+    EXPECT_EQ(Cache::freshness(RESPONSE, 0, 0, stale), 60);
+    EXPECT_EQ(stale, 30);
+
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\n"
+                               "Cache-Control: max-age=60, s-maxage=120\r\n\r\n",
+                               0,
+                               0,
+                               stale),
+              120);
+    EXPECT_EQ(stale, 0);
+
+    // Not cacheable
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\nCache-Control: no-store\r\n\r\n", 0, 60, stale),
+              0);
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\nCache-Control: private\r\n\r\n", 0, 60, stale),
+              0);
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\nSet-Cookie: a=b\r\n\r\n", 0, 60, stale), 0);
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 500 Internal Server Error\r\n\r\n", 0, 60, stale), 0);
+
+    // proxy_cache_valid applies without freshness information
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\n\r\n", 0, 60, stale), 60);
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\n\r\n", 0, 0, stale), 0);
+
+    EXPECT_EQ(Cache::freshness("HTTP/1.1 200 OK\r\n"
+                               "Expires: Thu, 01 Jan 1970 00:01:40 GMT\r\n\r\n",
+                               40,
+                               0,
+                               stale),
+              60);
+}
+
+TEST(CacheTests, StoreAndCoalesce)
+{
+    std::string dir = std::filesystem::temp_directory_path() / "webserv_cache_tests";
+    std::filesystem::remove_all(dir);
+
+    Cache       cache(dir, 1024);
+    std::string path;
+    std::string response;
+
+    // Only the first miss fetches, the others wait
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::MISS);
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::WAIT);
+
+    cache.store("GET localhost/", RESPONSE, 0);
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::HIT);
+    EXPECT_TRUE(Cache::read(path, "GET localhost/", response));
+    EXPECT_EQ(response, RESPONSE);
+
+    // Uncacheable responses unlock the key
+    EXPECT_EQ(cache.lookup("GET localhost/other", path), Lookup::MISS);
+    cache.store("GET localhost/other", "HTTP/1.1 200 OK\r\n\r\n", 0);
+    EXPECT_EQ(cache.lookup("GET localhost/other", path), Lookup::MISS);
+    cache.unlock("GET localhost/other");
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CacheTests, Stale)
+{
+    std::string dir = std::filesystem::temp_directory_path() / "webserv_cache_tests";
+    std::filesystem::remove_all(dir);
+
+    Cache       cache(dir, 1024);
+    std::string path;
+    std::string response;
+    std::string stale = "HTTP/1.1 200 OK\r\n"
+                        "Cache-Control: max-age=1, stale-while-revalidate=60\r\n"
+                        "\r\n";
+
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::MISS);
+    cache.store("GET localhost/", stale, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    // The first request revalidates, the others get the stale response meanwhile
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::STALE);
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::UPDATING);
+    EXPECT_TRUE(Cache::read(path, "GET localhost/", response));
+    EXPECT_EQ(response, stale);
+
+    cache.store("GET localhost/", RESPONSE, 0);
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::HIT);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CacheTests, Revalidate)
+{
+    std::string dir = std::filesystem::temp_directory_path() / "webserv_cache_tests";
+    std::filesystem::remove_all(dir);
+
+    // The upstream the refreshes fetch from
+    int         listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in address  = {};
+    socklen_t   length   = sizeof(address);
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(listen(listener, 8), 0);
+    ASSERT_EQ(getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+    Upstream::registry()["cache_tests"] = std::make_shared<Upstream>("cache_tests", address);
+
+    Cache       cache(dir, 1024);
+    std::string path;
+    std::string response;
+    std::string stale = "HTTP/1.1 200 OK\r\n"
+                        "Cache-Control: max-age=1, stale-while-revalidate=60\r\n"
+                        "Content-Length: 0\r\n"
+                        "\r\n";
+    for (const char* key : {"GET localhost/1", "GET localhost/2"}) {
+        EXPECT_EQ(cache.lookup(key, path), Lookup::MISS);
+        cache.store(key, stale, 0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    // Each refresh drops itself once it stored its response, whatever the other one does
+    Request first("GET /1 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    Request second("GET /2 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_EQ(cache.lookup("GET localhost/1", path), Lookup::STALE);
+    cache.revalidate("GET localhost/1", first, "http://cache_tests", 0);
+    EXPECT_EQ(cache.lookup("GET localhost/2", path), Lookup::STALE);
+    cache.revalidate("GET localhost/2", second, "http://cache_tests", 0);
+
+    std::vector<int> connections;
+    for (int i = 0; i < 200; ++i) {
+        Poller::instance().poll();
+        int connection = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection != -1) {
+            char buffer[1024];
+            ASSERT_GT(::read(connection, buffer, sizeof(buffer)), 0);
+            ASSERT_EQ(::write(connection, RESPONSE.data(), RESPONSE.size()),
+                      ssize_t(RESPONSE.size()));
+            connections.push_back(connection);
+        }
+        if (cache.lookup("GET localhost/1", path) == Lookup::HIT &&
+            cache.lookup("GET localhost/2", path) == Lookup::HIT) {
+            break;
+        }
+    }
+    EXPECT_EQ(cache.lookup("GET localhost/1", path), Lookup::HIT);
+    EXPECT_EQ(cache.lookup("GET localhost/2", path), Lookup::HIT);
+    EXPECT_TRUE(Cache::read(path, "GET localhost/2", response));
+    EXPECT_EQ(response, RESPONSE);
+
+    Upstream::registry().erase("cache_tests");
+    for (int connection : connections) {
+        close(connection);
+    }
+    close(listener);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CacheTests, Forget)
+{
+    std::string dir = std::filesystem::temp_directory_path() / "webserv_cache_tests";
+    std::filesystem::remove_all(dir);
+
+    Cache       cache(dir, 1024);
+    std::string path;
+    std::string response;
+
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::MISS);
+    cache.store("GET localhost/", RESPONSE, 0);
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::HIT);
+
+    // The file only answers for its own key
+    EXPECT_FALSE(Cache::read(path, "GET localhost/other", response));
+
+    // A response whose file is gone is fetched again
+    std::filesystem::remove(path);
+    EXPECT_FALSE(Cache::read(path, "GET localhost/", response));
+    cache.forget("GET localhost/");
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::MISS);
+    EXPECT_EQ(cache.lookup("GET localhost/", path), Lookup::WAIT);
+    cache.unlock("GET localhost/");
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CacheTests, Evict)
+{
+    std::string dir = std::filesystem::temp_directory_path() / "webserv_cache_tests";
+    std::filesystem::remove_all(dir);
+
+    Cache       cache(dir, RESPONSE.size() * 2);
+    std::string path;
+
+    for (const char* key : {"GET localhost/1", "GET localhost/2"}) {
+        EXPECT_EQ(cache.lookup(key, path), Lookup::MISS);
+        cache.store(key, RESPONSE, 0);
+    }
+
+    // The least recently used response makes room for a new one
+    EXPECT_EQ(cache.lookup("GET localhost/1", path), Lookup::HIT);
+    EXPECT_EQ(cache.lookup("GET localhost/3", path), Lookup::MISS);
+    cache.store("GET localhost/3", RESPONSE, 0);
+
+    EXPECT_EQ(cache.lookup("GET localhost/1", path), Lookup::HIT);
+    EXPECT_EQ(cache.lookup("GET localhost/3", path), Lookup::HIT);
+    EXPECT_EQ(cache.lookup("GET localhost/2", path), Lookup::MISS);
+    cache.unlock("GET localhost/2");
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "async/Poller.hpp"
+#include "http/Proxy.hpp"
+#include "net/Upstream.hpp"
+
+using namespace webserv::http;
+using webserv::async::Poller;
+using webserv::net::Upstream;
+
+namespace
+{
+/// A stand-in backend listening on loopback, registered as the upstream `proxy_tests`
+struct Backend
+{
+    int listener;
+    int connection = -1;
+
+    Backend()
+    {
+        listener                = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in address     = {};
+        socklen_t   length      = sizeof(address);
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        listen(listener, 8);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+        Upstream::registry()["proxy_tests"] = std::make_shared<Upstream>("proxy_tests", address);
+    }
+
+    ~Backend()
+    {
+        Upstream::registry().erase("proxy_tests");
+        close(connection);
+        close(listener);
+    }
+
+    /// Accepts the connection of the proxy and reads its request, true once it did
+    bool accept()
+    {
+        if (connection == -1) {
+            connection = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (connection == -1) {
+                return false;
+            }
+        }
+        char buffer[1024];
+        return ::read(connection, buffer, sizeof(buffer)) > 0;
+    }
+};
+
+/// Runs the event loop until the proxy resolves, writing `response` once the request
+/// arrived, then as much of `body` as the socket takes on each iteration
+///
+/// @return What the proxy resolved with
+std::string relay(Proxy&             proxy,
+                  Backend&           backend,
+                  const std::string& response,
+                  const std::string& body = "")
+{
+    std::optional<std::string> output;
+    proxy.get_output().then([&output](const std::string& relayed) { output = relayed; });
+
+    bool requested = false;
+    for (int i = 0; i < 10000 && !output; ++i) {
+        Poller::instance().poll();
+        if (!requested && backend.accept()) {
+            requested = true;
+            EXPECT_EQ(::write(backend.connection, response.data(), response.size()),
+                      ssize_t(response.size()));
+        }
+        if (requested && !body.empty()) {
+            ::send(backend.connection, body.data(), body.size(), MSG_NOSIGNAL);
+        }
+    }
+    return output.value_or("");
+}
+}  // namespace
+
+TEST(ProxyTests, Relay)
+{
+    Backend     backend;
+    Request     request("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    Proxy       proxy(request, "http://proxy_tests");
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nHello";
+
+    EXPECT_EQ(relay(proxy, backend, response), response);
+    EXPECT_EQ(proxy.state(), Proxy::State::DONE);
+}
+
+TEST(ProxyTests, ResponseTooLarge)
+{
+    // The upstream never stops sending, the proxy gives up past the limit
+    Backend backend;
+    Request request("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    Proxy   proxy(request, "http://proxy_tests");
+    EXPECT_EQ(relay(proxy,
+                    backend,
+                    "HTTP/1.1 200 OK\r\nContent-Length: 1000000000\r\n\r\n",
+                    std::string(64 * 1024, 'x')),
+              "");
+    EXPECT_EQ(proxy.state(), Proxy::State::FAILED);
+
+    // And the peer isn't marked down for it
+    EXPECT_NE(Upstream::find("proxy_tests")->select(""), nullptr);
+}
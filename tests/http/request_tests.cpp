@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <string>
+
 #include "http/Request.hpp"
 #include "http/Response.hpp"
 
@@ -27,9 +29,9 @@ TEST(RequestTests, RequestTest)
 
     const auto& headers = request.get_headers();
     EXPECT_EQ(headers.size(), 3);
-    EXPECT_EQ(headers.at("host"), "localhost:8080");
-    EXPECT_EQ(headers.at("user-agent"), "curl/7.68.0");
-    EXPECT_EQ(headers.at("accept"), "*/*");
+    EXPECT_EQ(headers.find(Header::HOST), "localhost:8080");
+    EXPECT_EQ(headers.find("user-agent"), "curl/7.68.0");
+    EXPECT_EQ(headers.find(Header::ACCEPT), "*/*");
 }
 
 TEST(RequestTests, InvalidMethodTest)
@@ -116,3 +118,87 @@ TEST(RequestTests, QueryTest)
     EXPECT_EQ(request.get_uri(), "/index.html");
 }
 
+TEST(RequestTests, PathTest)
+{
+    Request request("GET /my%20files/a%231%3f.txt?q=%20 HTTP/1.1\r\n"
+                    "Host: localhost:8080\r\n"
+                    "\r\n");
+
+    EXPECT_EQ(request.get_uri(), "/my%20files/a%231%3f.txt");
+    EXPECT_EQ(request.get_path(), "/my files/a#1?.txt");
+    EXPECT_EQ(request.get_query(), "q=%20");
+
+    EXPECT_THROW_VALUE(Request("GET /a%2 HTTP/1.1\r\nHost: localhost\r\n\r\n"),
+                       StatusCode,
+                       StatusCode::BAD_REQUEST);
+    EXPECT_THROW_VALUE(Request("GET /a%zz HTTP/1.1\r\nHost: localhost\r\n\r\n"),
+                       StatusCode,
+                       StatusCode::BAD_REQUEST);
+    EXPECT_THROW_VALUE(Request("GET /a%00b HTTP/1.1\r\nHost: localhost\r\n\r\n"),
+                       StatusCode,
+                       StatusCode::BAD_REQUEST);
+
+    // The path can't leave the root, encoded or not
+    for (const char* uri : {"/%2e%2e/%2e%2e/etc/passwd", "/a/../../b", "/a/%2E./b", "/..", "..",
+                            "/api%2fusers"}) {
+        SCOPED_TRACE(uri);
+        EXPECT_THROW_VALUE(
+            Request(std::string("GET ") + uri + " HTTP/1.1\r\nHost: localhost\r\n\r\n"),
+            StatusCode,
+            StatusCode::BAD_REQUEST);
+    }
+    Request dots("GET /a/..b/.../c..%2e HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_EQ(dots.get_path(), "/a/..b/.../c...");
+}
+
+TEST(RequestTests, HeadersTest)
+{
+    Request request("GET / HTTP/1.1\r\n"
+                    "HOST: localhost\r\n"
+                    "X-Custom-Header:  first \r\n"
+                    "Accept-Encoding: gzip\r\n"
+                    "x-custom-header: second\r\n"
+                    "Empty:\r\n"
+                    "\r\n");
+
+    const Headers& headers = request.get_headers();
+    EXPECT_EQ(headers.size(), 5);
+    EXPECT_EQ(request.host(), "localhost");
+
+    // Well-known names are recognized in any case and given in lowercase
+    EXPECT_EQ(headers[0].id, Header::HOST);
+    EXPECT_EQ(headers[0].name, "host");
+    EXPECT_EQ(headers[2].id, Header::ACCEPT_ENCODING);
+    EXPECT_TRUE(headers.contains(Header::ACCEPT_ENCODING));
+    EXPECT_FALSE(headers.contains(Header::CONTENT_LENGTH));
+    EXPECT_EQ(headers.find("accept-encoding"), "gzip");
+
+    // Other names keep their case, repeated fields are kept and the last one is found
+    EXPECT_EQ(headers[1].id, Header::OTHER);
+    EXPECT_EQ(headers[1].name, "X-Custom-Header");
+    EXPECT_EQ(headers[1].value, "first");
+    EXPECT_EQ(headers.find("x-custom-header"), "second");
+    EXPECT_EQ(headers.find("empty"), "");
+    EXPECT_EQ(headers.find("missing"), std::nullopt);
+
+    std::string names;
+    for (const auto& [id, name, value] : headers) {
+        names += std::string(name) + ";";
+    }
+    EXPECT_EQ(names, "host;X-Custom-Header;accept-encoding;x-custom-header;Empty;");
+}
+
+TEST(RequestTests, ManyHeadersTest)
+{
+    std::string input = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < 40; ++i) {
+        input += "X-Header-" + std::to_string(i) + ": " + std::to_string(i) + "\r\n";
+    }
+    input += "Host: localhost\r\n\r\n";
+
+    Request request(input);
+    EXPECT_EQ(request.get_headers().size(), 41);
+    EXPECT_EQ(request.get_headers().find("x-header-0"), "0");
+    EXPECT_EQ(request.get_headers().find("x-header-39"), "39");
+    EXPECT_EQ(request.host(), "localhost");
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "http/ResponseBuilder.hpp"
+
+using webserv::http::ResponseBuilder;
+
+TEST(ResponseBuilderTests, Memory)
+{
+    ResponseBuilder builder;
+    builder.status("200 OK").header("Content-Type", "text/plain").body("Hello");
+
+    EXPECT_EQ(builder.str(),
+              "HTTP/1.1 200 OK\r\n"
+              "Content-Type: text/plain\r\n"
+              "Content-Length: 5\r\n"
+              "\r\n"
+              "Hello");
+    EXPECT_EQ(builder.status_code(), 200);
+
+    iovec  iov[2];
+    size_t head = builder.str().size() - 5;
+    ASSERT_EQ(builder.iovecs(iov), 2);
+    EXPECT_EQ(iov[0].iov_len, head);
+    EXPECT_EQ(std::string(static_cast<char*>(iov[1].iov_base), iov[1].iov_len), "Hello");
+
+    // A partial write resumes in the body
+    builder.advance(head + 2);
+    ASSERT_EQ(builder.iovecs(iov), 1);
+    EXPECT_EQ(std::string(static_cast<char*>(iov[0].iov_base), iov[0].iov_len), "llo");
+    EXPECT_FALSE(builder.done());
+
+    builder.advance(3);
+    EXPECT_TRUE(builder.done());
+    EXPECT_EQ(builder.iovecs(iov), 0);
+    EXPECT_EQ(builder.sent(), head + 5);
+}
+
+TEST(ResponseBuilderTests, File)
+{
+    const char* path = "/tmp/webserv_response_builder_test.txt";
+    std::ofstream(path) << "file body";
+
+    ResponseBuilder builder;
+    builder.status_line("HTTP/1.1 404 Not Found\r\n").file(open(path, O_RDONLY), 9);
+    unlink(path);
+
+    EXPECT_EQ(builder.str(), "HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nfile body");
+    EXPECT_EQ(builder.status_code(), 404);
+    EXPECT_TRUE(builder.has_file());
+
+    // The file is only sent after the head
+    iovec iov[2];
+    ASSERT_EQ(builder.iovecs(iov), 1);
+    EXPECT_EQ(builder.file_range(), nullptr);
+
+    builder.advance(iov[0].iov_len);
+    EXPECT_EQ(builder.iovecs(iov), 0);
+    ASSERT_NE(builder.file_range(), nullptr);
+    EXPECT_EQ(builder.file_range()->length, 9);
+
+    builder.advance(4);
+    EXPECT_EQ(builder.file_range()->offset, 4);
+    EXPECT_EQ(builder.file_range()->length, 5);
+
+    builder.advance(5);
+    EXPECT_TRUE(builder.done());
+    EXPECT_FALSE(builder.has_file());
+}
+
+TEST(ResponseBuilderTests, Raw)
+{
+    ResponseBuilder builder;
+    builder.status("200 OK").body("dropped");
+    builder.raw("HTTP/1.1 502 Bad Gateway\r\n\r\n");
+
+    EXPECT_EQ(builder.str(), "HTTP/1.1 502 Bad Gateway\r\n\r\n");
+    EXPECT_EQ(builder.status_code(), 502);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "config/Config.hpp"
+#include "net/ServerNames.hpp"
+
+using namespace webserv::config;
+using webserv::net::ServerNames;
+
+static ServerNames server_names(const Config& config, int port)
+{
+    ServerNames names;
+
+    auto& http = *config.get_children()[0];
+    for (auto it = http.begin(Config::SERVER); it != http.end(); it = it.next(Config::SERVER)) {
+        for (const auto& listen : it->listens()) {
+            if (listen.port == port) {
+                names.add(*it, listen.default_server);
+            }
+        }
+    }
+    return names;
+}
+
+TEST(ServerNamesTests, Listen)
+{
+    Config config("tests/conf/server_names.conf");
+
+    auto& http = *config.get_children()[0];
+
+    auto listens = http.get_children()[3]->listens();
+    ASSERT_EQ(listens.size(), 1);
+    EXPECT_EQ(listens[0].port, 8080);
+    EXPECT_EQ(listens[0].host, "0.0.0.0");
+    EXPECT_TRUE(listens[0].default_server);
+    EXPECT_EQ(http.get_children()[3]->host(), "0.0.0.0");
+
+    listens = http.get_children()[4]->listens();
+    EXPECT_EQ(listens[0].host, "127.0.0.1");
+    EXPECT_FALSE(listens[0].default_server);
+}
+
+TEST(ServerNamesTests, Find)
+{
+    Config      config("tests/conf/server_names.conf");
+    ServerNames names = server_names(config, 8080);
+
+    EXPECT_EQ(names.find("example.com").root(), "/exact");
+    EXPECT_EQ(names.find("WWW.Example.COM").root(), "/exact");
+    EXPECT_EQ(names.find("a.example.com").root(), "/leading");
+    EXPECT_EQ(names.find("a.b.example.com").root(), "/leading");
+    EXPECT_EQ(names.find("v1.api.example.com").root(), "/leading-api");
+    EXPECT_EQ(names.find("www.example.org").root(), "/trailing");
+    EXPECT_EQ(names.find("MAIL.example.org").root(), "/trailing");
+
+    // The default_server gets the hosts that match no name
+    EXPECT_EQ(names.find("other.org").root(), "/trailing");
+    EXPECT_EQ(names.find("").root(), "/trailing");
+}
+
+TEST(ServerNamesTests, FirstServerIsDefault)
+{
+    Config      config("tests/conf/server_names.conf");
+    ServerNames names = server_names(config, 8081);
+
+    EXPECT_EQ(names.find("localhost").root(), "/local");
+    EXPECT_EQ(names.find("example.com").root(), "/local");
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include "config/Config.hpp"
+#include "net/Upstream.hpp"
+
+using namespace webserv::config;
+using webserv::net::Upstream;
+using Type = Config::Type;
+
+static const Config& upstream_config(const Config& config, size_t index)
+{
+    auto& http = *config.get_children()[0];
+    return *http.get_children()[index];
+}
+
+TEST(UpstreamTests, Parse)
+{
+    Config config("tests/conf/upstream.conf");
+
+    const Config& weighted = upstream_config(config, 0);
+    EXPECT_EQ(weighted.get_type(), Type::UPSTREAM);
+    EXPECT_EQ(weighted.get_children()[0]->get_type(), Type::UPSTREAM_SERVER);
+
+    Upstream upstream(weighted);
+    EXPECT_EQ(upstream.get_name(), "weighted");
+    EXPECT_EQ(upstream.get_balance(), Upstream::Balance::ROUND_ROBIN);
+    ASSERT_EQ(upstream.get_peers().size(), 2);
+    EXPECT_EQ(upstream.get_peers()[0].weight, 3);
+    EXPECT_EQ(upstream.get_peers()[0].address.to_string(), "127.0.0.1:9000");
+
+    Upstream hashed(upstream_config(config, 2));
+    EXPECT_EQ(hashed.get_balance(), Upstream::Balance::HASH);
+    EXPECT_EQ(hashed.get_hash_key(), "$request_uri");
+
+    auto& server = upstream_config(config, 4);
+    EXPECT_EQ(server.location("/api/users").proxy_pass(), "http://weighted");
+}
+
+TEST(UpstreamTests, WeightedRoundRobin)
+{
+    Config   config("tests/conf/upstream.conf");
+    Upstream upstream(upstream_config(config, 0));
+
+    int picks[2] = {0, 0};
+    for (int i = 0; i < 8; ++i) {
+        Upstream::Peer* peer = upstream.select("");
+        ASSERT_NE(peer, nullptr);
+        ++picks[peer - &upstream.get_peers()[0]];
+    }
+    EXPECT_EQ(picks[0], 6);
+    EXPECT_EQ(picks[1], 2);
+}
+
+TEST(UpstreamTests, LeastConnections)
+{
+    Config   config("tests/conf/upstream.conf");
+    Upstream upstream(upstream_config(config, 1));
+
+    Upstream::Peer* first = upstream.select("");
+    ASSERT_NE(first, nullptr);
+    ++first->active;
+
+    Upstream::Peer* second = upstream.select("");
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+}
+
+TEST(UpstreamTests, ConsistentHash)
+{
+    Config   config("tests/conf/upstream.conf");
+    Upstream upstream(upstream_config(config, 2));
+
+    Upstream::Peer* peer = upstream.select("/index.html");
+    ASSERT_NE(peer, nullptr);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(upstream.select("/index.html"), peer);
+    }
+
+    // A failed peer moves its keys to the next peer on the ring
+    upstream.failure(*peer);
+    Upstream::Peer* next = upstream.select("/index.html");
+    ASSERT_NE(next, nullptr);
+    EXPECT_NE(next, peer);
+}
+
+TEST(UpstreamTests, PassiveHealthCheck)
+{
+    Config   config("tests/conf/upstream.conf");
+    Upstream upstream(upstream_config(config, 1));
+
+    // max_fails defaults to 1
+    Upstream::Peer* first = upstream.select("");
+    ASSERT_NE(first, nullptr);
+    upstream.failure(*first);
+    EXPECT_FALSE(first->is_up(Upstream::Clock::now()));
+
+    // max_fails=2: a single failure keeps the peer up
+    Upstream::Peer* second = upstream.select("");
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    upstream.failure(*second);
+    EXPECT_TRUE(second->is_up(Upstream::Clock::now()));
+    upstream.success(*second);
+    EXPECT_EQ(second->fails, 0);
+
+    upstream.failure(*second);
+    upstream.failure(*second);
+    EXPECT_EQ(upstream.select(""), nullptr);
+}
+
+TEST(UpstreamTests, MaxFailsZero)
+{
+    Config   config("tests/conf/upstream.conf");
+    Upstream upstream(upstream_config(config, 3));
+
+    // max_fails=0 turns failure accounting off, the peer is never marked down
+    Upstream::Peer* peer = upstream.select("");
+    ASSERT_NE(peer, nullptr);
+    EXPECT_EQ(peer->max_fails, 0);
+    for (int i = 0; i < 3; ++i) {
+        upstream.failure(*peer);
+    }
+    EXPECT_TRUE(peer->is_up(Upstream::Clock::now()));
+    EXPECT_EQ(upstream.select(""), peer);
+}
+
+TEST(UpstreamTests, ParseAddress)
+{
+    EXPECT_EQ(Upstream::parse_address("127.0.0.1:9000").to_string(), "127.0.0.1:9000");
+    EXPECT_EQ(Upstream::parse_address("localhost").to_string(), "127.0.0.1:80");
+
+    EXPECT_THROW(Upstream::parse_address("127.0.0.1:"), std::runtime_error);
+    EXPECT_THROW(Upstream::parse_address("127.0.0.1:80x"), std::runtime_error);
+    EXPECT_THROW(Upstream::parse_address("127.0.0.1:65536"), std::runtime_error);
+    EXPECT_THROW(Upstream::parse_address("no-such-host.invalid"), std::runtime_error);
+}
@@ -0,0 +1,107 @@
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "utils/AccessLog.hpp"
+#include "utils/RingBuffer.hpp"
+
+using webserv::utils::AccessLog;
+using webserv::utils::RingBuffer;
+
+TEST(AccessLogTests, RingBuffer)
+{
+    RingBuffer<int, 4> buffer;
+    EXPECT_EQ(buffer.front(), nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        int* slot = buffer.acquire();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        buffer.publish();
+    }
+    EXPECT_EQ(buffer.acquire(), nullptr);
+
+    EXPECT_EQ(*buffer.front(), 0);
+    buffer.pop();
+    ASSERT_NE(buffer.acquire(), nullptr);
+
+    for (int i = 1; i < 4; ++i) {
+        EXPECT_EQ(*buffer.front(), i);
+        buffer.pop();
+    }
+    EXPECT_EQ(buffer.front(), nullptr);
+}
+
+TEST(AccessLogTests, Format)
+{
+    AccessLog::Record record = {};
+    record.address           = inet_addr("10.0.0.1");
+    record.status            = 404;
+    record.bytes_sent        = 512;
+    record.request_time_us   = 1500;
+    strcpy(record.method, "GET");
+    strcpy(record.uri, "/missing");
+    strcpy(record.user_agent, "curl/8.0 \"quoted\"");
+
+    std::string line;
+    AccessLog::format(record, AccessLog::Format::COMBINED, "19/Oct/2026:12:00:00 +0000", line);
+    EXPECT_EQ(line,
+              "10.0.0.1 - - [19/Oct/2026:12:00:00 +0000] \"GET /missing HTTP/1.1\" 404 512 \"-\" "
+              "\"curl/8.0 \"quoted\"\"\n");
+
+    line.clear();
+    AccessLog::format(record, AccessLog::Format::JSON, "2026-10-19T12:00:00+0000", line);
+    EXPECT_EQ(line,
+              "{\"time\":\"2026-10-19T12:00:00+0000\",\"remote_addr\":\"10.0.0.1\","
+              "\"request\":\"GET /missing HTTP/1.1\",\"status\":404,\"bytes_sent\":512,"
+              "\"request_time\":0.001500,\"referer\":\"\","
+              "\"user_agent\":\"curl/8.0 \\\"quoted\\\"\"}\n");
+
+    // The query is appended to the URI, a connection without a request logs "-"
+    strcpy(record.query, "a=1");
+    line.clear();
+    AccessLog::format(record, AccessLog::Format::COMBINED, "", line);
+    EXPECT_NE(line.find("\"GET /missing?a=1 HTTP/1.1\""), std::string::npos);
+
+    record.method[0] = '\0';
+    line.clear();
+    AccessLog::format(record, AccessLog::Format::COMBINED, "", line);
+    EXPECT_NE(line.find("] \"-\" 404"), std::string::npos);
+}
+
+TEST(AccessLogTests, Write)
+{
+    std::string path = "/tmp/webserv_access_log_test.log";
+    std::remove(path.c_str());
+
+    sockaddr_in address     = {};
+    address.sin_addr.s_addr = inet_addr("127.0.0.1");
+    {
+        AccessLog log(path, AccessLog::Format::COMBINED);
+        for (int i = 0; i < 100; ++i) {
+            log.log(address, 200, i, 0, "GET", "/", "", "", "test");
+        }
+        EXPECT_EQ(log.dropped(), 0);
+    }
+
+    std::ifstream file(path);
+    std::string   line;
+    int           lines = 0;
+    while (std::getline(file, line)) {
+        EXPECT_TRUE(line.starts_with("127.0.0.1 - - ["));
+        EXPECT_TRUE(line.ends_with("\"GET / HTTP/1.1\" 200 " + std::to_string(lines) +
+                                   " \"-\" \"test\""));
+        ++lines;
+    }
+    EXPECT_EQ(lines, 100);
+
+    EXPECT_THROW(AccessLog::get("/nonexistent/dir/access.log", "combined"), std::runtime_error);
+    EXPECT_THROW(AccessLog::get(path, "xml"), std::runtime_error);
+
+    // A file gets a log per format
+    AccessLog& combined = AccessLog::get(path, "combined");
+    EXPECT_EQ(&AccessLog::get(path, "combined"), &combined);
+    EXPECT_NE(&AccessLog::get(path, "json"), &combined);
+}
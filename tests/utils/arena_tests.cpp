@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "http/Request.hpp"
+#include "utils/Arena.hpp"
+#include "utils/BufferPool.hpp"
+
+using webserv::http::Request;
+using webserv::utils::Arena;
+using webserv::utils::BufferPool;
+
+TEST(ArenaTests, ResetRewinds)
+{
+    BufferPool pool(1024);
+    Arena      arena(pool);
+    EXPECT_EQ(pool.in_use(), 0);
+
+    void* first = arena.allocate(100);
+    EXPECT_NE(arena.allocate(200), nullptr);
+    EXPECT_EQ(arena.allocations(), 2);
+    EXPECT_EQ(arena.allocated(), 300);
+
+    EXPECT_EQ(pool.in_use(), 1);
+
+    // The block is given back and taken again
+    arena.reset();
+    EXPECT_EQ(arena.allocations(), 0);
+    EXPECT_EQ(arena.allocated(), 0);
+    EXPECT_EQ(pool.in_use(), 0);
+    EXPECT_EQ(arena.allocate(100), first);
+}
+
+TEST(ArenaTests, Overflow)
+{
+    BufferPool pool(64);
+    Arena      arena(pool);
+
+    void* first = arena.allocate(32);
+    void* large = arena.allocate(4096);
+    std::memset(large, 'x', 4096);
+    EXPECT_EQ(arena.allocations(), 2);
+
+    // The heap block is freed and the first one used again
+    arena.reset();
+    EXPECT_EQ(arena.allocate(32), first);
+}
+
+TEST(ArenaTests, Request)
+{
+    Arena arena;
+    {
+        Request request("POST /upload?name=a-name-that-doesnt-fit-in-a-small-string HTTP/1.1\r\n"
+                        "Host: localhost\r\n"
+                        "User-Agent: curl\r\n"
+                        "Content-Length: 5\r\n"
+                        "\r\n"
+                        "Hello",
+                        &arena);
+
+        EXPECT_EQ(request.get_uri(), "/upload");
+        EXPECT_EQ(request.get_query(), "name=a-name-that-doesnt-fit-in-a-small-string");
+        EXPECT_EQ(request.host(), "localhost");
+        EXPECT_EQ(request.body(), "Hello");
+        EXPECT_GT(arena.allocations(), 0);
+
+        // The body grows on the heap, the arena would keep every buffer it outgrows
+        size_t allocated = arena.allocated();
+        request.append_body(std::string(64 * 1024, 'x'));
+        EXPECT_EQ(arena.allocated(), allocated);
+    }
+    arena.reset();
+    EXPECT_EQ(arena.allocations(), 0);
+}
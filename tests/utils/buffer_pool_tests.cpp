@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <utility>
+
+#include "utils/BufferPool.hpp"
+
+using webserv::utils::BufferPool;
+
+TEST(BufferPoolTests, Reuse)
+{
+    BufferPool pool(64);
+
+    const char* data;
+    {
+        BufferPool::Buffer buffer = pool.acquire();
+        ASSERT_TRUE(buffer);
+        EXPECT_EQ(buffer.capacity(), 64);
+        EXPECT_EQ(pool.in_use(), 1);
+        data = buffer.data();
+    }
+    EXPECT_EQ(pool.in_use(), 0);
+    EXPECT_EQ(pool.free(), 1);
+
+    BufferPool::Buffer buffer = pool.acquire();
+    EXPECT_EQ(buffer.data(), data);
+    EXPECT_EQ(pool.free(), 0);
+}
+
+TEST(BufferPoolTests, MaxFree)
+{
+    BufferPool pool(64, 1);
+    {
+        BufferPool::Buffer first  = pool.acquire();
+        BufferPool::Buffer second = pool.acquire();
+        EXPECT_EQ(pool.in_use(), 2);
+    }
+    EXPECT_EQ(pool.in_use(), 0);
+    EXPECT_EQ(pool.free(), 1);
+}
+
+TEST(BufferPoolTests, Move)
+{
+    BufferPool pool(64);
+
+    BufferPool::Buffer buffer = pool.acquire();
+    buffer.data()[0]          = 'a';
+    buffer.resize(1);
+
+    BufferPool::Buffer moved = std::move(buffer);
+    EXPECT_FALSE(buffer);
+    EXPECT_EQ(moved.view(), "a");
+    EXPECT_EQ(pool.in_use(), 1);
+
+    // Assigning gives the buffer that was held back
+    moved = pool.acquire();
+    EXPECT_EQ(pool.in_use(), 1);
+    EXPECT_EQ(moved.size(), 0);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "utils/FlatMap.hpp"
+
+using webserv::utils::FlatMap;
+
+struct StringHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+};
+
+TEST(FlatMapTests, EmplaceAndFind)
+{
+    FlatMap<std::string, int, StringHash> map;
+    EXPECT_EQ(map.find("a"), map.end());
+
+    EXPECT_TRUE(map.emplace("a", 1).second);
+    EXPECT_TRUE(map.emplace("b", 2).second);
+    EXPECT_FALSE(map.emplace("a", 3).second);
+    EXPECT_EQ(map.size(), 2);
+
+    // Looked up by a view without building a string
+    auto it = map.find(std::string_view("a"));
+    ASSERT_NE(it, map.end());
+    EXPECT_EQ(it->second, 1);
+    EXPECT_TRUE(map.contains(std::string_view("b")));
+    EXPECT_FALSE(map.contains(std::string_view("c")));
+
+    map["c"] += 5;
+    EXPECT_EQ(map.find(std::string_view("c"))->second, 5);
+}
+
+TEST(FlatMapTests, GrowAndErase)
+{
+    FlatMap<int, int>  map;
+    std::map<int, int> expected;
+    std::mt19937       random(42);
+
+    // Enough inserts and erases to grow, fill groups and reuse deleted slots
+    for (int i = 0; i < 20000; ++i) {
+        int key = random() % 2000;
+        if (random() % 3 == 0) {
+            EXPECT_EQ(map.erase(key), expected.erase(key));
+        } else {
+            EXPECT_EQ(map.emplace(key, i).second, expected.emplace(key, i).second);
+        }
+    }
+
+    ASSERT_EQ(map.size(), expected.size());
+    for (const auto& [key, value] : expected) {
+        auto it = map.find(key);
+        ASSERT_NE(it, map.end());
+        EXPECT_EQ(it->second, value);
+    }
+
+    size_t count = 0;
+    for (const auto& [key, value] : map) {
+        EXPECT_EQ(expected.at(key), value);
+        ++count;
+    }
+    EXPECT_EQ(count, expected.size());
+}
+
+TEST(FlatMapTests, EraseWhileIterating)
+{
+    FlatMap<int, int> map;
+    for (int i = 0; i < 100; ++i) {
+        map.emplace(i, i);
+    }
+
+    for (auto it = map.begin(); it != map.end();) {
+        it = it->first % 2 == 0 ? map.erase(it) : ++it;
+    }
+    EXPECT_EQ(map.size(), 50);
+    EXPECT_FALSE(map.contains(10));
+    EXPECT_TRUE(map.contains(11));
+}
+
+TEST(FlatMapTests, CopyAndMove)
+{
+    FlatMap<std::string, std::string, StringHash> map;
+    map.emplace("key", "value");
+
+    FlatMap<std::string, std::string, StringHash> copy = map;
+    FlatMap<std::string, std::string, StringHash> moved(std::move(map));
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(copy.find(std::string_view("key"))->second, "value");
+    EXPECT_EQ(moved.find(std::string_view("key"))->second, "value");
+
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(copy.begin(), copy.end());
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "utils/Format.hpp"
+#include "utils/Logger.hpp"
+
+using webserv::utils::ErrorLogger;
+
+TEST(LoggerTests, Format)
+{
+    using webserv::utils::format;
+
+    EXPECT_EQ(format("no arguments"), "no arguments");
+    EXPECT_EQ(format("{} + {} = {}", 1, 2u, 3L), "1 + 2 = 3");
+    EXPECT_EQ(format("{}/{}", std::string("a"), std::string_view("b")), "a/b");
+    EXPECT_EQ(format("{} {} {}", 'c', true, 1.5), "c true 1.5");
+    EXPECT_EQ(format("{{}} {}", "literal"), "{} literal");
+    EXPECT_EQ(format("{} {}", -7), "-7 {}");
+    EXPECT_EQ(format("{}", 1, 2), "1");
+}
+
+TEST(LoggerTests, File)
+{
+    const std::string path = "/tmp/webserv_error_log_test.log";
+    std::remove(path.c_str());
+
+    int evaluated = 0;
+    {
+        ErrorLogger elog(ErrorLogger::INFO);
+        elog.set_file(path);
+
+        ELOG_DEBUG(elog, "skipped {}", ++evaluated);
+        ELOG_INFO(elog, "port {}", 8080);
+
+        // Buffered until flushed
+        std::ifstream before(path);
+        EXPECT_EQ(before.peek(), std::ifstream::traits_type::eof());
+
+        elog.flush();
+        ELOG_ERROR(elog, "failed: {}", "reason");
+    }
+    EXPECT_EQ(evaluated, 0);
+
+    std::ifstream     file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+
+    std::string lines = content.str();
+    EXPECT_EQ(lines.find("skipped"), std::string::npos);
+    EXPECT_NE(lines.find("][INFO]: port 8080\n"), std::string::npos);
+    EXPECT_NE(lines.find("][ERROR]: failed: reason\n"), std::string::npos);
+    EXPECT_EQ(lines.find("\033["), std::string::npos);
+
+    std::remove(path.c_str());
+}
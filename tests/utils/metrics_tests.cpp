@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "utils/Metrics.hpp"
+
+using webserv::utils::Metrics;
+
+TEST(MetricsTests, HistogramBuckets)
+{
+    using Histogram = Metrics::Histogram;
+
+    EXPECT_EQ(Histogram::bucket(0), 0u);
+    EXPECT_EQ(Histogram::bucket(1), 1u);
+    EXPECT_EQ(Histogram::upper_bound(0), 1u);
+    EXPECT_EQ(Histogram::upper_bound(1), 2u);
+
+    // Each value is below the bound of its bucket and at least the bound of the previous one
+    for (uint64_t us = 0; us < (uint64_t(1) << 20); us = us * 5 / 4 + 1) {
+        size_t bucket = Histogram::bucket(us);
+        EXPECT_LT(us, Histogram::upper_bound(bucket)) << us;
+        if (bucket > 0) {
+            EXPECT_GE(us, Histogram::upper_bound(bucket - 1)) << us;
+        }
+    }
+    EXPECT_EQ(Histogram::bucket(6), Histogram::bucket(7));
+    EXPECT_NE(Histogram::bucket(5), Histogram::bucket(6));
+
+    EXPECT_EQ(Histogram::bucket(uint64_t(1) << 40), Metrics::BUCKETS);
+}
+
+TEST(MetricsTests, Str)
+{
+    Metrics&           metrics  = Metrics::instance();
+    Metrics::Location& location = metrics.location("example.com", "~ \\.py$");
+    EXPECT_EQ(&location, &metrics.location("example.com", "~ \\.py$"));
+
+    metrics.record(location, 200, 3);
+    metrics.record(location, 404, 5);
+    metrics.set_connections([] { return Metrics::Connections{1, 2, 3}; });
+    metrics.set_pool_queued(7);
+
+    std::string str = metrics.str();
+    metrics.set_connections(nullptr);
+    metrics.set_pool_queued(0);
+
+    std::string labels = "server=\"example.com\",location=\"~ \\\\.py$\"";
+    EXPECT_NE(str.find("webserv_connections{state=\"writing\"} 2\n"), std::string::npos);
+    EXPECT_NE(str.find("webserv_responses_total{code=\"404\"} "), std::string::npos);
+    EXPECT_NE(str.find("webserv_pool_queued_jobs 7\n"), std::string::npos);
+    EXPECT_NE(str.find("webserv_location_responses_total{" + labels + ",class=\"2xx\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(str.find("webserv_request_duration_seconds_bucket{" + labels + ",le=\"3e-06\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(str.find("webserv_request_duration_seconds_bucket{" + labels + ",le=\"+Inf\"} 2\n"),
+              std::string::npos);
+    EXPECT_NE(str.find("webserv_request_duration_seconds_sum{" + labels + "} 8e-06\n"),
+              std::string::npos);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "utils/Pool.hpp"
+
+using webserv::utils::Pool;
+
+namespace
+{
+struct Counted
+{
+    static inline int alive = 0;
+
+    int value;
+
+    explicit Counted(int value) : value(value) { ++alive; }
+    ~Counted() { --alive; }
+};
+}  // namespace
+
+TEST(PoolTests, CreateAndDestroy)
+{
+    {
+        Pool<Counted, 4> pool;
+
+        std::vector<Counted*> objects;
+        for (int i = 0; i < 10; ++i) {
+            objects.push_back(pool.create(i));
+        }
+        EXPECT_EQ(pool.size(), 10);
+        EXPECT_EQ(pool.capacity(), 12);
+        EXPECT_EQ(Counted::alive, 10);
+
+        pool.destroy(objects[3]);
+        pool.destroy(objects[0]);
+        pool.destroy(objects[9]);
+        EXPECT_EQ(pool.size(), 7);
+        EXPECT_EQ(Counted::alive, 7);
+
+        std::vector<int> values;
+        for (const Counted* object : pool) {
+            values.push_back(object->value);
+        }
+        std::sort(values.begin(), values.end());
+        EXPECT_EQ(values, (std::vector<int>{1, 2, 4, 5, 6, 7, 8}));
+    }
+    EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(PoolTests, ReusesSlots)
+{
+    Pool<Counted, 4> pool;
+
+    Counted* first = pool.create(1);
+    pool.create(2);
+    pool.destroy(first);
+
+    EXPECT_EQ(pool.create(3), first);
+    EXPECT_EQ(first->value, 3);
+    EXPECT_EQ(pool.capacity(), 4);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <regex>
+
+#include "utils/RegexSet.hpp"
+
+using webserv::utils::RegexSet;
+
+TEST(RegexSetTests, Match)
+{
+    RegexSet set;
+    set.add("\\.php$");
+    set.add("\\.(jpg|png)$", true);
+    set.add("^/api/v[0-9]+/");
+    set.add("admin");
+
+    EXPECT_EQ(set.size(), 4);
+    EXPECT_EQ(set.match("/index.php"), 0);
+    EXPECT_EQ(set.match("/index.php.bak"), -1);
+    EXPECT_EQ(set.match("/images/cat.JPG"), 1);
+    EXPECT_EQ(set.match("/images/cat.jpeg"), -1);
+    EXPECT_EQ(set.match("/api/v12/users"), 2);
+    EXPECT_EQ(set.match("/x/api/v12/users"), -1);
+    EXPECT_EQ(set.match("/my/admin/page"), 3);
+
+    // The first pattern in the set wins
+    EXPECT_EQ(set.match("/admin/index.php"), 0);
+}
+
+TEST(RegexSetTests, Syntax)
+{
+    RegexSet set;
+    set.add("^a(?:b|c)*d?e+$");
+    set.add("^[^/]+\\.[a-z]{0}");
+    set.add("^\\d\\w\\s\\S$");
+    set.add("^[]a-c-]x.$");
+
+    EXPECT_EQ(set.match("abcbcee"), 0);
+    EXPECT_EQ(set.match("ade"), 0);
+    EXPECT_EQ(set.match("abd"), -1);
+    EXPECT_EQ(set.match("1a b"), 2);
+    EXPECT_EQ(set.match("]xz"), 3);
+    EXPECT_EQ(set.match("-xz"), 3);
+
+    EXPECT_THROW(set.add("(abc"), std::runtime_error);
+    EXPECT_THROW(set.add("abc)"), std::runtime_error);
+    EXPECT_THROW(set.add("[abc"), std::runtime_error);
+    EXPECT_THROW(set.add("*abc"), std::runtime_error);
+    EXPECT_THROW(set.add("abc\\"), std::runtime_error);
+}
+
+TEST(RegexSetTests, MatchesStdRegex)
+{
+    const std::vector<std::string> patterns = {
+        "\\.php$", "^/static/", "(foo|bar)+baz", "^/[a-z]+/[0-9]*$", "a.c", "x?y*z+$"};
+    const std::vector<std::string> inputs = {"/index.php",
+                                             "/static/app.js",
+                                             "/foobarbaz",
+                                             "/users/123",
+                                             "/users/",
+                                             "/abc",
+                                             "/a/c",
+                                             "zzz",
+                                             "/xyz/",
+                                             ""};
+
+    for (const auto& pattern : patterns) {
+        RegexSet   set;
+        std::regex regex(pattern, std::regex::extended);
+        set.add(pattern);
+
+        for (const auto& input : inputs) {
+            EXPECT_EQ(set.match(input) == 0, std::regex_search(input, regex))
+                << pattern << " on " << input;
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <string_view>
+
+#include "utils/StaticMap.hpp"
+
+using webserv::utils::make_static_map;
+
+namespace
+{
+constexpr auto PORTS = make_static_map<int>({
+    {"http",  80},
+    {"https", 443},
+    {"ssh",   22},
+    {"",      0},
+});
+}  // namespace
+
+TEST(StaticMapTests, Find)
+{
+    static_assert(*PORTS.find("https") == 443);
+    static_assert(PORTS.find("ftp") == nullptr);
+
+    EXPECT_EQ(PORTS.size(), 4);
+    EXPECT_EQ(*PORTS.find("http"), 80);
+    EXPECT_EQ(*PORTS.find("ssh"), 22);
+    EXPECT_EQ(*PORTS.find(""), 0);
+    EXPECT_FALSE(PORTS.contains("htt"));
+    EXPECT_FALSE(PORTS.contains("https "));
+
+    int sum = 0;
+    for (const auto& [name, port] : PORTS) {
+        sum += port;
+    }
+    EXPECT_EQ(sum, 545);
+}